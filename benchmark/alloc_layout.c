@@ -0,0 +1,408 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Allocation layout benchmark of generic_list.h with hardware counters
+(Linux).
+
+The same list of 'count' 64 byte nodes is built in memory laid out six ways:
+
+calloc           : One calloc per node with a random sized allocation freed
+                   between each, linked in allocation order.
+pool             : One contiguous array, linked in address order.
+hugepage         : One contiguous array in 2 MB pages, linked in address
+                   order. MAP_HUGETLB is tried first and then transparent huge
+                   pages with madvise; the page kind used is reported.
+*_churned        : The same after 'moves' random moves, which leaves the list
+                   order unrelated to the address order, like a long running
+                   list.
+
+Two workloads are timed on each:
+
+traverse : 'passes' walks of the whole list that read every node.
+move     : 'moves' UNLINK_NODE and LINK_NODE_BEFORE of a random node before
+           another random node. The nodes are picked by index in allocation
+           order so this includes the same random access in every layout.
+
+For each the ns, cycles, cache misses and dTLB load misses per node visited or
+moved are reported. The counters are read with perf_event_open and count user
+mode only. If a counter can't be opened, because the kernel or a container
+doesn't allow it (see /proc/sys/kernel/perf_event_paranoid) or the processor
+doesn't have it, its column is shown as '-' and the run continues. A count
+that was multiplexed with other events is scaled to the time enabled.
+
+cc -O2 -I.. alloc_layout.c -o alloc_layout
+./alloc_layout [count] [passes] [moves]
+*/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "generic_list.h"
+
+#define HUGE_PAGE_SIZE   (2 * 1024 * 1024)
+
+struct layout_list;
+struct layout_node {
+    DECLARE_NODE_MEMBERS(layout_node, layout_list);
+    unsigned long value;
+    char payload[64 - 3 * sizeof(void *) - sizeof(unsigned long)];
+};
+struct layout_list {
+    DECLARE_LIST_MEMBERS(layout_node);
+};
+
+enum alloc { ALLOC_CALLOC, ALLOC_POOL, ALLOC_HUGEPAGE };
+
+static const struct {
+    const char *name;
+    enum alloc alloc;
+    int churned;
+} layouts[] = {
+    { "calloc", ALLOC_CALLOC, 0 },
+    { "calloc_churned", ALLOC_CALLOC, 1 },
+    { "pool", ALLOC_POOL, 0 },
+    { "pool_churned", ALLOC_POOL, 1 },
+    { "hugepage", ALLOC_HUGEPAGE, 0 },
+    { "hugepage_churned", ALLOC_HUGEPAGE, 1 }
+};
+
+enum { COUNTER_CYCLES, COUNTER_CACHE_MISSES, COUNTER_DTLB_MISSES,
+    COUNTER_COUNT };
+
+static const char *counter_names[COUNTER_COUNT] = {
+    "cycles", "cache-misses", "dTLB-load-misses"
+};
+
+static int counter_fds[COUNTER_COUNT];
+
+static size_t count = 1000000, passes = 10, moves = 1000000;
+static struct layout_list list;
+/* the nodes in allocation order */
+static struct layout_node **nodes;
+/* the pool or huge page mapping */
+static void *region;
+static size_t region_size;
+static int region_mapped;
+static const char *page_kind;
+static unsigned long long rng_state = 88172645463325252ULL;
+static volatile unsigned long sink;
+
+/* xorshift64 */
+static unsigned long long Random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void OutOfMemory(void) {
+    fprintf(stderr, "Out of memory.\n");
+    exit(1);
+}
+
+static int OpenCounter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+        | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void OpenCounters(void) {
+    int i, opened = 0;
+    counter_fds[COUNTER_CYCLES] = OpenCounter(PERF_TYPE_HARDWARE,
+        PERF_COUNT_HW_CPU_CYCLES);
+    counter_fds[COUNTER_CACHE_MISSES] = OpenCounter(PERF_TYPE_HARDWARE,
+        PERF_COUNT_HW_CACHE_MISSES);
+    counter_fds[COUNTER_DTLB_MISSES] = OpenCounter(PERF_TYPE_HW_CACHE,
+        PERF_COUNT_HW_CACHE_DTLB
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    for(i = 0; i < COUNTER_COUNT; ++i) {
+        if(counter_fds[i] == -1) {
+            fprintf(stderr, "Counter %s is unavailable: %s\n",
+                counter_names[i], strerror(errno));
+        }
+        else {
+            ++opened;
+        }
+    }
+    if(!opened) {
+        fprintf(stderr, "No hardware counters, only the time is reported.\n");
+    }
+}
+
+static void StartCounters(void) {
+    int i;
+    for(i = 0; i < COUNTER_COUNT; ++i) {
+        if(counter_fds[i] != -1) {
+            ioctl(counter_fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+/* Stop the counters and store each count in 'values', or -1 if the counter is
+unavailable or didn't run. */
+static void StopCounters(double values[COUNTER_COUNT]) {
+    int i;
+    for(i = 0; i < COUNTER_COUNT; ++i) {
+        /* value, time enabled, time running */
+        uint64_t data[3];
+        values[i] = -1;
+        if(counter_fds[i] == -1) {
+            continue;
+        }
+        ioctl(counter_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        if(read(counter_fds[i], data, sizeof(data)) == (ssize_t)sizeof(data)
+            && data[2])
+        {
+            values[i] = (double)data[0] * ((double)data[1] / (double)data[2]);
+        }
+    }
+}
+
+/* Allocate an array of nodes in 2 MB pages: MAP_HUGETLB if huge pages are
+reserved, otherwise an aligned mapping that's advised for transparent huge
+pages. */
+static void *AllocHugePages(size_t size) {
+    char *p;
+    size_t offset;
+
+    region_size =
+        (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    region = mmap(NULL, region_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if(region != MAP_FAILED) {
+        page_kind = "hugetlb";
+        region_mapped = 1;
+        return region;
+    }
+    region_size += HUGE_PAGE_SIZE;
+    region = mmap(NULL, region_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(region == MAP_FAILED) {
+        OutOfMemory();
+    }
+    region_mapped = 1;
+    p = (char *)region;
+    offset = (HUGE_PAGE_SIZE - (uintptr_t)p % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+    page_kind = madvise(p + offset, region_size - HUGE_PAGE_SIZE,
+        MADV_HUGEPAGE) ? "4k (no THP)" : "THP";
+    return p + offset;
+}
+
+static void Build(enum alloc alloc, int churned) {
+    size_t i;
+    struct layout_node *pool = NULL;
+
+    region = NULL;
+    region_mapped = 0;
+    page_kind = "default";
+    if(alloc == ALLOC_POOL) {
+        pool = region = calloc(count, sizeof(*pool));
+        if(!pool) {
+            OutOfMemory();
+        }
+    }
+    else if(alloc == ALLOC_HUGEPAGE) {
+        /* anonymous mappings are zeroed */
+        pool = AllocHugePages(count * sizeof(*pool));
+    }
+    ZERO_OUT_LIST_MEMBERS(&list);
+    for(i = 0; i < count; ++i) {
+        if(pool) {
+            nodes[i] = &pool[i];
+        }
+        else {
+            void *filler;
+            nodes[i] = calloc(1, sizeof(*nodes[i]));
+            filler = malloc(16 + (size_t)(Random() % 256));
+            if(!nodes[i] || !filler) {
+                OutOfMemory();
+            }
+            free(filler);
+        }
+        ZERO_OUT_NODE_MEMBERS(nodes[i]);
+        nodes[i]->value = (unsigned long)i;
+        LINK_NODE_LAST(nodes[i], &list);
+    }
+    if(churned) {
+        for(i = 0; i < moves; ++i) {
+            struct layout_node *node = nodes[Random() % count];
+            struct layout_node *position = nodes[Random() % count];
+            if(node != position) {
+                UNLINK_NODE(node);
+                LINK_NODE_BEFORE(node, position);
+            }
+        }
+    }
+}
+
+static void Destroy(void) {
+    size_t i;
+    if(region_mapped) {
+        munmap(region, region_size);
+    }
+    else if(region) {
+        free(region);
+    }
+    else {
+        for(i = 0; i < count; ++i) {
+            free(nodes[i]);
+        }
+    }
+}
+
+static void Print(const char *layout, const char *workload, double seconds,
+    const double values[COUNTER_COUNT], double per)
+{
+    int i;
+    printf("%-18s %-10s %-12s %8.2f", layout, workload, page_kind,
+        seconds * 1e9 / per);
+    for(i = 0; i < COUNTER_COUNT; ++i) {
+        if(values[i] < 0) {
+            printf(" %16s", "-");
+        }
+        else {
+            printf(" %16.3f", values[i] / per);
+        }
+    }
+    printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+    size_t l;
+    int i;
+
+    if(argc > 1) {
+        count = (size_t)strtoul(argv[1], NULL, 10);
+    }
+    if(argc > 2) {
+        passes = (size_t)strtoul(argv[2], NULL, 10);
+    }
+    if(argc > 3) {
+        moves = (size_t)strtoul(argv[3], NULL, 10);
+    }
+    if(count < 2 || !passes || !moves) {
+        fprintf(stderr, "Usage: alloc_layout [count] [passes] [moves]\n");
+        return 1;
+    }
+    nodes = calloc(count, sizeof(*nodes));
+    if(!nodes) {
+        OutOfMemory();
+    }
+    OpenCounters();
+
+    printf("count: %lu, node size: %lu, passes: %lu, moves: %lu\n",
+        (unsigned long)count, (unsigned long)sizeof(struct layout_node),
+        (unsigned long)passes, (unsigned long)moves);
+    printf("per node visited or moved:\n");
+    printf("%-18s %-10s %-12s %8s", "layout", "workload", "pages", "ns");
+    for(i = 0; i < COUNTER_COUNT; ++i) {
+        printf(" %16s", counter_names[i]);
+    }
+    printf("\n");
+
+    for(l = 0; l < sizeof(layouts) / sizeof(layouts[0]); ++l) {
+        double start, seconds, values[COUNTER_COUNT];
+        unsigned long sum = 0;
+        size_t p;
+
+        Build(layouts[l].alloc, layouts[l].churned);
+
+        StartCounters();
+        start = Now();
+        for(p = 0; p < passes; ++p) {
+            struct layout_node *node;
+            for(node = list.head; node; node = node->next) {
+                sum += node->value;
+            }
+        }
+        seconds = Now() - start;
+        StopCounters(values);
+        sink = sum;
+        if(sum != (unsigned long)passes * (count * (count - 1) / 2)) {
+            fprintf(stderr, "FAILED: The traversal sum is wrong.\n");
+            return 1;
+        }
+        Print(layouts[l].name, "traverse", seconds, values,
+            (double)passes * (double)count);
+
+        StartCounters();
+        start = Now();
+        for(p = 0; p < moves; ++p) {
+            struct layout_node *node = nodes[Random() % count];
+            struct layout_node *position = nodes[Random() % count];
+            if(node != position) {
+                UNLINK_NODE(node);
+                LINK_NODE_BEFORE(node, position);
+            }
+        }
+        seconds = Now() - start;
+        StopCounters(values);
+        if(list.count != count) {
+            fprintf(stderr, "FAILED: The list has %lu nodes, expected %lu.\n",
+                (unsigned long)list.count, (unsigned long)count);
+            return 1;
+        }
+        Print(layouts[l].name, "move", seconds, values, (double)moves);
+
+        Destroy();
+    }
+
+    for(i = 0; i < COUNTER_COUNT; ++i) {
+        if(counter_fds[i] != -1) {
+            close(counter_fds[i]);
+        }
+    }
+    free(nodes);
+    return 0;
+}
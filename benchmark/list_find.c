@@ -0,0 +1,258 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Probe length benchmark of LIST_FIND policies with Zipf keys (Linux).
+
+A list of 'count' nodes with keys 0 to count-1 in random order is searched
+'lookups' times for keys drawn from a Zipf distribution with exponent 's',
+where key i is looked up with probability proportional to 1/(i+1)^s. The same
+keys are looked up with each policy and the average number of nodes compared
+per lookup and the time per lookup are reported.
+
+After each lookup the run fails unless the found node has the key and is where
+the policy puts it: unmoved for none, the head for move-to-front, just before
+its old predecessor for transpose, and for count its count went up by one and
+it is between nodes with a count at least and at most as high. At the end of
+each run the list is walked, and for count the counts must not increase from
+head to tail. These checks are O(1) per lookup and are included in the time.
+
+cc -O2 -I.. list_find.c -o list_find -lm
+./list_find [count] [lookups] [s]
+*/
+
+#define _GNU_SOURCE
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "generic_list_find.h"
+
+struct key_list;
+struct key_node {
+    DECLARE_NODE_MEMBERS(key_node, key_list);
+    unsigned long key;
+    size_t find_count;
+};
+struct key_list {
+    DECLARE_LIST_MEMBERS(key_node);
+};
+
+static unsigned long long probes;
+
+#define KEY_CMP(node, k)   (++probes, (node)->key != (k))
+
+enum policy { NONE, MOVE_TO_FRONT, TRANSPOSE, COUNT };
+
+static const char *names[] = { "none", "move-to-front", "transpose", "count" };
+
+/* Check where a lookup left the found node, see the comment at the top.
+'old_prev' and 'old_count' are the node's prev and find_count before the
+lookup. Returns NULL or what is wrong. */
+static const char *CheckFound(int policy, const struct key_list *list,
+    const struct key_node *node, const struct key_node *old_prev,
+    size_t old_count)
+{
+    switch(policy) {
+    case NONE:
+        if(node->prev != old_prev) {
+            return "A lookup without a policy moved the node.";
+        }
+        break;
+    case MOVE_TO_FRONT:
+        if(list->head != node) {
+            return "Move-to-front didn't make the node the head.";
+        }
+        break;
+    case TRANSPOSE:
+        if(old_prev ? (node->next != old_prev || old_prev->prev != node)
+            : (list->head != node))
+        {
+            return "Transpose didn't put the node before its predecessor.";
+        }
+        break;
+    default:
+        if(node->find_count != old_count + 1) {
+            return "Count didn't count the lookup.";
+        }
+        if((node->prev && node->prev->find_count < node->find_count)
+            || (node->next && node->next->find_count > node->find_count))
+        {
+            return "Count didn't keep the counts in order.";
+        }
+        break;
+    }
+    return NULL;
+}
+
+/* xorshift64, so every policy sees the same keys */
+static unsigned long long rng_state;
+static unsigned long long Random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = 1000, lookups = 1000000, i;
+    double s = 1.0, *cdf;
+    unsigned long *keys;
+    struct key_node *nodes, *node;
+    struct key_list list;
+    int policy;
+
+    if(argc > 1) {
+        count = (size_t)strtoul(argv[1], NULL, 10);
+    }
+    if(argc > 2) {
+        lookups = (size_t)strtoul(argv[2], NULL, 10);
+    }
+    if(argc > 3) {
+        s = strtod(argv[3], NULL);
+    }
+    if(!count || !lookups) {
+        fprintf(stderr, "Usage: list_find [count] [lookups] [s]\n");
+        return 1;
+    }
+    cdf = malloc(count * sizeof(*cdf));
+    keys = malloc(lookups * sizeof(*keys));
+    nodes = calloc(count, sizeof(*nodes));
+    if(!cdf || !keys || !nodes) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+
+    for(i = 0; i < count; ++i) {
+        cdf[i] = (i ? cdf[i - 1] : 0) + 1 / pow((double)(i + 1), s);
+    }
+    rng_state = 88172645463325252ULL;
+    for(i = 0; i < lookups; ++i) {
+        double u = (double)(Random() >> 11) / 9007199254740992.0
+            * cdf[count - 1];
+        size_t lo = 0, hi = count - 1;
+        while(lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if(cdf[mid] < u) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        keys[i] = (unsigned long)lo;
+    }
+
+    printf("count: %lu, lookups: %lu, s: %.2f\n", (unsigned long)count,
+        (unsigned long)lookups, s);
+    for(policy = NONE; policy <= COUNT; ++policy) {
+        struct timespec start, end;
+        double seconds;
+
+        /* the same random initial order for every policy */
+        ZERO_OUT_LIST_MEMBERS(&list);
+        for(i = 0; i < count; ++i) {
+            ZERO_OUT_NODE_MEMBERS(&nodes[i]);
+            nodes[i].key = (unsigned long)i;
+            nodes[i].find_count = 0;
+        }
+        rng_state = 2463534242ULL;
+        for(i = 0; i < count; ++i) {
+            size_t j = (size_t)(Random() % (i + 1));
+            LINK_NODE_LAST(&nodes[i], &list);
+            if(j != i) {
+                LINK_NODE_BEFORE(&nodes[i], &nodes[j]);
+            }
+        }
+
+        probes = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for(i = 0; i < lookups; ++i) {
+            const struct key_node *old_prev = nodes[keys[i]].prev;
+            size_t old_count = nodes[keys[i]].find_count;
+            const char *error;
+            switch(policy) {
+            case NONE:
+                LIST_FIND(&list, keys[i], KEY_CMP, NONE, node);
+                break;
+            case MOVE_TO_FRONT:
+                LIST_FIND(&list, keys[i], KEY_CMP, MOVE_TO_FRONT, node);
+                break;
+            case TRANSPOSE:
+                LIST_FIND(&list, keys[i], KEY_CMP, TRANSPOSE, node);
+                break;
+            default:
+                LIST_FIND(&list, keys[i], KEY_CMP, COUNT, node);
+                break;
+            }
+            if(!node || node->key != keys[i]) {
+                fprintf(stderr, "FAILED: A key was not found.\n");
+                return 1;
+            }
+            error = CheckFound(policy, &list, node, old_prev, old_count);
+            if(error) {
+                fprintf(stderr, "FAILED: %s\n", error);
+                return 1;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if(list.count != count) {
+            fprintf(stderr, "FAILED: The list lost nodes.\n");
+            return 1;
+        }
+        for(i = 0, node = list.head; node; node = node->next, ++i) {
+            if(node->parent != &list
+                || (node->next && node->next->prev != node)
+                || (!node->next && list.tail != node))
+            {
+                fprintf(stderr, "FAILED: The list is broken.\n");
+                return 1;
+            }
+            if(policy == COUNT && node->next
+                && node->next->find_count > node->find_count)
+            {
+                fprintf(stderr,
+                    "FAILED: The counts increase along the list.\n");
+                return 1;
+            }
+        }
+        if(i != count) {
+            fprintf(stderr, "FAILED: The list lost nodes.\n");
+            return 1;
+        }
+        seconds = (double)(end.tv_sec - start.tv_sec)
+            + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+        printf("%-14s average probe length %8.2f, %7.1f ns/lookup\n",
+            names[policy], (double)probes / (double)lookups,
+            seconds * 1e9 / (double)lookups);
+    }
+    free(nodes);
+    free(keys);
+    free(cdf);
+    return 0;
+}
@@ -0,0 +1,150 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Overhead benchmark of GENERIC_LIST_TRACE, GENERIC_LIST_STATS and
+GENERIC_LIST_CHECK (Linux).
+
+Random LINK_NODE_LAST, LINK_NODE_BEFORE and UNLINK_NODE operations on a list of
+up to 'count' nodes are timed in ns per operation, followed by a LIST_FOREACH
+of the list. Build it with and without tracing, statistics or checks and
+compare:
+
+cc -O2 -I.. list_trace.c -o list_trace
+cc -O2 -I.. -DGENERIC_LIST_TRACE list_trace.c ../generic_list_trace.c \
+   -o list_trace_traced
+cc -O2 -I.. -DGENERIC_LIST_TRACE -DLIST_TRACE_STAMP_EVERY=1 \
+   list_trace.c ../generic_list_trace.c -o list_trace_timed
+cc -O2 -I.. -DGENERIC_LIST_STATS list_trace.c -o list_trace_stats
+cc -O2 -I.. -DGENERIC_LIST_CHECK=1 list_trace.c -o list_trace_checked
+./list_trace [count] [operations] [trace file]
+
+The traced builds save the trace to 'trace file' if given, which can be
+printed with tools/list_trace_dump.c. The statistics build prints the list's
+statistics.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "generic_list.h"
+
+struct item_list;
+struct item {
+    DECLARE_NODE_MEMBERS(item, item_list);
+    unsigned long value;
+};
+struct item_list {
+    DECLARE_LIST_MEMBERS(item);
+};
+
+int main(int argc, char *argv[]) {
+    size_t count = 1000, operations = 20000000, i;
+    unsigned long long rng = 88172645463325252ULL;
+    struct item_list list;
+    struct item *items, *item;
+    struct generic_list_stats stats;
+    struct timespec start, end;
+    double seconds;
+
+    if(argc > 1) {
+        count = (size_t)strtoul(argv[1], NULL, 10);
+    }
+    if(argc > 2) {
+        operations = (size_t)strtoul(argv[2], NULL, 10);
+    }
+    if(!count || !operations) {
+        fprintf(stderr, "Usage: list_trace [count] [operations] "
+            "[trace file]\n");
+        return 1;
+    }
+    items = calloc(count, sizeof(*items));
+    if(!items) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    ZERO_OUT_LIST_MEMBERS(&list);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i = 0; i < operations; ++i) {
+        struct item *item, *position;
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        item = &items[(size_t)(rng % count)];
+        position = &items[(size_t)((rng >> 32) % count)];
+        if(item->parent) {
+            UNLINK_NODE(item);
+        }
+        else if(position->parent && position != item) {
+            LINK_NODE_BEFORE(item, position);
+        }
+        else {
+            LINK_NODE_LAST(item, &list);
+        }
+    }
+    LIST_FOREACH(item, &list) {
+        item->value = 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (double)(end.tv_sec - start.tv_sec)
+        + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+#if defined(GENERIC_LIST_TRACE)
+    printf("traced:   ");
+#elif defined(GENERIC_LIST_STATS)
+    printf("stats:    ");
+#elif defined(GENERIC_LIST_CHECK) && (GENERIC_LIST_CHECK >= 1)
+    printf("checked:  ");
+#else
+    printf("plain:    ");
+#endif
+    printf("%.2f ns/op, %lu nodes in the list\n",
+        seconds * 1e9 / (double)operations, (unsigned long)list.count);
+
+    LIST_STATS_SNAPSHOT(&list, stats);
+#ifdef GENERIC_LIST_STATS
+    printf("links: %lu, unlinks: %lu, moves: %lu, saturated: %lu, "
+        "max count: %lu, visits: %lu\n", (unsigned long)stats.links,
+        (unsigned long)stats.unlinks, (unsigned long)stats.moves,
+        (unsigned long)stats.saturated, (unsigned long)stats.max_count,
+        (unsigned long)stats.visits);
+#else
+    (void)stats;
+#endif
+
+#ifdef GENERIC_LIST_TRACE
+    if(argc > 3 && list_trace_save(argv[3])) {
+        fprintf(stderr, "Failed to save the trace.\n");
+        return 1;
+    }
+#endif
+    free(items);
+    return 0;
+}
@@ -0,0 +1,707 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Comparative microbenchmark of the generic_list.h macros (Linux).
+
+Each operation is run on lists of each size with four implementations:
+
+generic : generic_list.h.
+kernel  : A Linux kernel style circular list_head, embedded in the node.
+boost   : Boost.Intrusive list with a constant time size, if Boost was found
+          (HAVE_BOOST_INTRUSIVE).
+std     : std::list<uint64_t>, which allocates a node on every link.
+
+The operations, each on 'size' nodes per list:
+
+link_first     : LINK_NODE_FIRST of every node to an empty list.
+link_last      : LINK_NODE_LAST of every node to an empty list.
+link_before    : LINK_NODE_BEFORE of 'size' more nodes, each before a random
+                 node of the list.
+link_after     : LINK_NODE_AFTER, likewise.
+unlink         : UNLINK_NODE of every node in random order.
+move_to_front  : LINK_NODE_FIRST of a random node of the list, 'size' times.
+traverse       : A walk of the whole list that reads every node.
+
+Building the lists for an operation isn't timed. The operations are timed in
+chunks of up to 1024 operations, or one walk for traverse, and lists smaller
+than that are run side by side so a chunk is never tiny. Each size is repeated
+until at least 'min-ops' operations have been timed. The mean ns per operation,
+the throughput in millions of operations per second and the 50th, 90th and
+99th percentile of the chunks' ns per operation are reported as CSV or JSON.
+
+c++ -O2 -I.. microbench.cpp -o microbench
+c++ -O2 -I.. -DHAVE_BOOST_INTRUSIVE microbench.cpp -o microbench
+
+./microbench [--format=csv|json] [--sizes=1,10,...] [--min-ops=N]
+             [--impls=generic,kernel,boost,std] [--ops=link_first,...]
+             [--label=TEXT]
+
+'label' is copied to every result, for example a revision of generic_list.h.
+Without it the label is the benchmark, the compiler, "boost" if Boost.Intrusive
+is compiled in and the UTC time the run started, for example
+microbench/gcc-12.2/boost/2026-10-18T09:30:00Z, so that the rows of different
+runs and builds can be told apart when they are combined.
+The default sizes are 1, 10, ... 10000000. The CMake build defines
+HAVE_BOOST_INTRUSIVE when it finds Boost.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include "generic_list.h"
+
+#ifdef HAVE_BOOST_INTRUSIVE
+#include <boost/intrusive/list.hpp>
+#endif
+
+using namespace std;
+
+enum { CHUNK = 1024 };
+
+/* xorshift64, so every implementation gets the same random positions */
+static uint64_t rng_state;
+static uint64_t Random() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+/* Stops the compiler from optimizing away a traversal. */
+static volatile uint64_t sink;
+
+
+/* generic_list.h */
+struct generic_list;
+struct generic_node {
+    DECLARE_NODE_MEMBERS(generic_node, generic_list);
+    uint64_t value;
+};
+struct generic_list {
+    DECLARE_LIST_MEMBERS(generic_node);
+};
+
+class GenericImpl {
+public:
+    static const char *Name() { return "generic"; }
+    void Reset(size_t lists, size_t nodes_per_list) {
+        this->lists.resize(lists);
+        nodes.resize(lists * nodes_per_list);
+        Clear();
+    }
+    void LinkFirst(size_t list, size_t node) {
+        generic_node *n = &nodes[node];
+        generic_list *l = &lists[list];
+        LINK_NODE_FIRST(n, l);
+    }
+    void LinkLast(size_t list, size_t node) {
+        generic_node *n = &nodes[node];
+        generic_list *l = &lists[list];
+        LINK_NODE_LAST(n, l);
+    }
+    void LinkBefore(size_t node, size_t position) {
+        generic_node *n = &nodes[node], *p = &nodes[position];
+        LINK_NODE_BEFORE(n, p);
+    }
+    void LinkAfter(size_t node, size_t position) {
+        generic_node *n = &nodes[node], *p = &nodes[position];
+        LINK_NODE_AFTER(n, p);
+    }
+    void Unlink(size_t node) {
+        generic_node *n = &nodes[node];
+        UNLINK_NODE(n);
+    }
+    void MoveToFront(size_t list, size_t node) { LinkFirst(list, node); }
+    uint64_t Traverse(size_t list) {
+        uint64_t sum = 0;
+        generic_node *n;
+        for(n = lists[list].head; n; n = n->next) {
+            sum += n->value;
+        }
+        return sum;
+    }
+    void Clear() {
+        for(size_t i = 0; i < lists.size(); ++i) {
+            ZERO_OUT_LIST_MEMBERS(&lists[i]);
+        }
+        for(size_t i = 0; i < nodes.size(); ++i) {
+            ZERO_OUT_NODE_MEMBERS(&nodes[i]);
+            nodes[i].value = i;
+        }
+    }
+private:
+    vector<generic_list> lists;
+    vector<generic_node> nodes;
+};
+
+
+/* Linux kernel style list: a circular list_head embedded in the node, with a
+list_head as the list and no count. */
+struct klist_head {
+    klist_head *next, *prev;
+};
+
+static inline void klist_init(klist_head *head) {
+    head->next = head->prev = head;
+}
+
+static inline void klist_insert_(klist_head *entry, klist_head *prev,
+    klist_head *next)
+{
+    next->prev = entry;
+    entry->next = next;
+    entry->prev = prev;
+    prev->next = entry;
+}
+
+/* list_add: insert after 'head' */
+static inline void klist_add(klist_head *entry, klist_head *head) {
+    klist_insert_(entry, head, head->next);
+}
+
+/* list_add_tail: insert before 'head' */
+static inline void klist_add_tail(klist_head *entry, klist_head *head) {
+    klist_insert_(entry, head->prev, head);
+}
+
+static inline void klist_del(klist_head *entry) {
+    entry->next->prev = entry->prev;
+    entry->prev->next = entry->next;
+    entry->next = entry->prev = NULL;
+}
+
+static inline void klist_move(klist_head *entry, klist_head *head) {
+    entry->next->prev = entry->prev;
+    entry->prev->next = entry->next;
+    klist_add(entry, head);
+}
+
+struct kernel_node {
+    klist_head link;
+    uint64_t value;
+};
+
+class KernelImpl {
+public:
+    static const char *Name() { return "kernel"; }
+    void Reset(size_t lists, size_t nodes_per_list) {
+        this->lists.resize(lists);
+        nodes.resize(lists * nodes_per_list);
+        Clear();
+    }
+    void LinkFirst(size_t list, size_t node) {
+        klist_add(&nodes[node].link, &lists[list]);
+    }
+    void LinkLast(size_t list, size_t node) {
+        klist_add_tail(&nodes[node].link, &lists[list]);
+    }
+    void LinkBefore(size_t node, size_t position) {
+        klist_add_tail(&nodes[node].link, &nodes[position].link);
+    }
+    void LinkAfter(size_t node, size_t position) {
+        klist_add(&nodes[node].link, &nodes[position].link);
+    }
+    void Unlink(size_t node) { klist_del(&nodes[node].link); }
+    void MoveToFront(size_t list, size_t node) {
+        klist_move(&nodes[node].link, &lists[list]);
+    }
+    uint64_t Traverse(size_t list) {
+        uint64_t sum = 0;
+        klist_head *head = &lists[list], *pos;
+        for(pos = head->next; pos != head; pos = pos->next) {
+            /* container_of */
+            sum += ((kernel_node *)((char *)pos
+                - offsetof(kernel_node, link)))->value;
+        }
+        return sum;
+    }
+    void Clear() {
+        for(size_t i = 0; i < lists.size(); ++i) {
+            klist_init(&lists[i]);
+        }
+        for(size_t i = 0; i < nodes.size(); ++i) {
+            nodes[i].link.next = nodes[i].link.prev = NULL;
+            nodes[i].value = i;
+        }
+    }
+private:
+    vector<klist_head> lists;
+    vector<kernel_node> nodes;
+};
+
+
+#ifdef HAVE_BOOST_INTRUSIVE
+namespace bi = boost::intrusive;
+
+struct boost_node
+    : public bi::list_base_hook<bi::link_mode<bi::normal_link> >
+{
+    uint64_t value;
+};
+typedef bi::list<boost_node, bi::constant_time_size<true> > boost_list;
+
+class BoostImpl {
+public:
+    static const char *Name() { return "boost"; }
+    BoostImpl() : per_list(1) {}
+    void Reset(size_t lists, size_t nodes_per_list) {
+        Clear();
+        per_list = nodes_per_list;
+        this->lists = vector<boost_list>(lists);
+        nodes = vector<boost_node>(lists * nodes_per_list);
+        for(size_t i = 0; i < nodes.size(); ++i) {
+            nodes[i].value = i;
+        }
+    }
+    void LinkFirst(size_t list, size_t node) {
+        lists[list].push_front(nodes[node]);
+    }
+    void LinkLast(size_t list, size_t node) {
+        lists[list].push_back(nodes[node]);
+    }
+    void LinkBefore(size_t node, size_t position) {
+        boost_list &l = lists[position / per_list];
+        l.insert(l.iterator_to(nodes[position]), nodes[node]);
+    }
+    void LinkAfter(size_t node, size_t position) {
+        boost_list &l = lists[position / per_list];
+        boost_list::iterator it = l.iterator_to(nodes[position]);
+        l.insert(++it, nodes[node]);
+    }
+    void Unlink(size_t node) {
+        boost_list &l = lists[node / per_list];
+        l.erase(l.iterator_to(nodes[node]));
+    }
+    void MoveToFront(size_t list, size_t node) {
+        boost_list &l = lists[list];
+        l.splice(l.begin(), l, l.iterator_to(nodes[node]));
+    }
+    uint64_t Traverse(size_t list) {
+        uint64_t sum = 0;
+        for(boost_list::iterator it = lists[list].begin();
+            it != lists[list].end(); ++it)
+        {
+            sum += it->value;
+        }
+        return sum;
+    }
+    /* the nodes must be unlinked before the lists are destroyed */
+    void Clear() {
+        for(size_t i = 0; i < lists.size(); ++i) {
+            lists[i].clear();
+        }
+    }
+    ~BoostImpl() { Clear(); }
+private:
+    size_t per_list;
+    vector<boost_list> lists;
+    vector<boost_node> nodes;
+};
+#endif
+
+
+/* std::list of values. The iterator of each linked node is kept so that it can
+be unlinked or used as a position in O(1). */
+class StdImpl {
+public:
+    static const char *Name() { return "std"; }
+    StdImpl() : per_list(1) {}
+    void Reset(size_t lists, size_t nodes_per_list) {
+        per_list = nodes_per_list;
+        this->lists = vector<list<uint64_t> >(lists);
+        its.assign(lists * nodes_per_list, list<uint64_t>::iterator());
+    }
+    void LinkFirst(size_t l, size_t node) {
+        lists[l].push_front(node);
+        its[node] = lists[l].begin();
+    }
+    void LinkLast(size_t l, size_t node) {
+        lists[l].push_back(node);
+        its[node] = --lists[l].end();
+    }
+    void LinkBefore(size_t node, size_t position) {
+        its[node] = lists[position / per_list].insert(its[position], node);
+    }
+    void LinkAfter(size_t node, size_t position) {
+        list<uint64_t>::iterator it = its[position];
+        its[node] = lists[position / per_list].insert(++it, node);
+    }
+    void Unlink(size_t node) { lists[node / per_list].erase(its[node]); }
+    void MoveToFront(size_t l, size_t node) {
+        lists[l].splice(lists[l].begin(), lists[l], its[node]);
+    }
+    uint64_t Traverse(size_t l) {
+        uint64_t sum = 0;
+        for(list<uint64_t>::iterator it = lists[l].begin();
+            it != lists[l].end(); ++it)
+        {
+            sum += *it;
+        }
+        return sum;
+    }
+    void Clear() {
+        for(size_t i = 0; i < lists.size(); ++i) {
+            lists[i].clear();
+        }
+    }
+private:
+    size_t per_list;
+    vector<list<uint64_t> > lists;
+    vector<list<uint64_t>::iterator> its;
+};
+
+
+enum op {
+    OP_LINK_FIRST, OP_LINK_LAST, OP_LINK_BEFORE, OP_LINK_AFTER, OP_UNLINK,
+    OP_MOVE_TO_FRONT, OP_TRAVERSE, OP_COUNT
+};
+
+static const char *op_names[OP_COUNT] = {
+    "link_first", "link_last", "link_before", "link_after", "unlink",
+    "move_to_front", "traverse"
+};
+
+struct result {
+    string impl;
+    string op;
+    size_t size;
+    size_t ops;
+    double ns_per_op;
+    double mops;
+    double p50, p90, p99;
+};
+
+static double Percentile(vector<double> &samples, double p) {
+    size_t i = (size_t)(p / 100 * (double)(samples.size() - 1) + 0.5);
+    nth_element(samples.begin(), samples.begin() + i, samples.end());
+    return samples[i];
+}
+
+typedef chrono::steady_clock Clock;
+
+static double Ns(Clock::time_point start, Clock::time_point end) {
+    return (double)chrono::duration_cast<chrono::nanoseconds>(end
+        - start).count();
+}
+
+/* Run one operation at one size until min_ops operations have been timed.
+Clear() unlinks every node between rounds. */
+template <class Impl>
+static result Measure(enum op op, size_t size, size_t min_ops) {
+    Impl impl;
+    /* lists side by side so a chunk has about CHUNK operations */
+    size_t lists = (size < CHUNK) ? (CHUNK + size - 1) / size : 1;
+    size_t extra = (op == OP_LINK_BEFORE || op == OP_LINK_AFTER) ? size : 0;
+    size_t per_list = size + extra;
+    size_t timed = 0;
+    double total_ns = 0;
+    vector<double> samples;
+    vector<size_t> work;
+
+    rng_state = 88172645463325252ULL;
+    impl.Reset(lists, per_list);
+    while(timed < min_ops) {
+        /* build, untimed */
+        impl.Clear();
+        work.clear();
+        for(size_t l = 0; l < lists; ++l) {
+            size_t base = l * per_list;
+            if(op != OP_LINK_FIRST && op != OP_LINK_LAST) {
+                for(size_t i = 0; i < size; ++i) {
+                    impl.LinkLast(l, base + i);
+                }
+            }
+            for(size_t i = 0; i < size; ++i) {
+                switch(op) {
+                case OP_LINK_FIRST:
+                case OP_LINK_LAST:
+                    work.push_back(base + i);
+                    break;
+                case OP_LINK_BEFORE:
+                case OP_LINK_AFTER:
+                    work.push_back(base + size + i);
+                    work.push_back(base + (size_t)(Random() % size));
+                    break;
+                case OP_UNLINK:
+                    work.push_back(base + i);
+                    break;
+                case OP_MOVE_TO_FRONT:
+                    work.push_back(base + (size_t)(Random() % size));
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+        if(op == OP_UNLINK) {
+            for(size_t i = work.size(); i > 1; --i) {
+                swap(work[i - 1], work[(size_t)(Random() % i)]);
+            }
+        }
+
+        /* timed, in chunks */
+        if(op == OP_TRAVERSE) {
+            Clock::time_point start = Clock::now();
+            uint64_t sum = 0;
+            for(size_t l = 0; l < lists; ++l) {
+                sum += impl.Traverse(l);
+            }
+            Clock::time_point end = Clock::now();
+            sink = sum;
+            total_ns += Ns(start, end);
+            samples.push_back(Ns(start, end) / (double)(lists * size));
+            timed += lists * size;
+            continue;
+        }
+        size_t count = lists * size, done = 0;
+        while(done < count) {
+            size_t n = min((size_t)CHUNK, count - done), i;
+            Clock::time_point start = Clock::now();
+            for(i = done; i < done + n; ++i) {
+                switch(op) {
+                case OP_LINK_FIRST:
+                    impl.LinkFirst(work[i] / per_list, work[i]);
+                    break;
+                case OP_LINK_LAST:
+                    impl.LinkLast(work[i] / per_list, work[i]);
+                    break;
+                case OP_LINK_BEFORE:
+                    impl.LinkBefore(work[i * 2], work[i * 2 + 1]);
+                    break;
+                case OP_LINK_AFTER:
+                    impl.LinkAfter(work[i * 2], work[i * 2 + 1]);
+                    break;
+                case OP_UNLINK:
+                    impl.Unlink(work[i]);
+                    break;
+                default:
+                    impl.MoveToFront(work[i] / per_list, work[i]);
+                    break;
+                }
+            }
+            Clock::time_point end = Clock::now();
+            total_ns += Ns(start, end);
+            samples.push_back(Ns(start, end) / (double)n);
+            done += n;
+        }
+        timed += count;
+    }
+    impl.Clear();
+
+    result r;
+    r.impl = Impl::Name();
+    r.op = op_names[op];
+    r.size = size;
+    r.ops = timed;
+    r.ns_per_op = total_ns / (double)timed;
+    r.mops = 1e3 / r.ns_per_op;
+    r.p50 = Percentile(samples, 50);
+    r.p90 = Percentile(samples, 90);
+    r.p99 = Percentile(samples, 99);
+    return r;
+}
+
+/* Whether 'name' is in the comma separated 'filter', or there is no filter. */
+static bool Selected(const string &filter, const char *name) {
+    if(filter.empty()) {
+        return true;
+    }
+    string list = "," + filter + ",";
+    return list.find("," + string(name) + ",") != string::npos;
+}
+
+/* The label of a run without --label, see the comment at the top. */
+static string DefaultLabel() {
+    char buf[64];
+    string label = "microbench";
+#if defined(__clang__)
+    snprintf(buf, sizeof(buf), "/clang-%d.%d", __clang_major__,
+        __clang_minor__);
+#elif defined(__GNUC__)
+    snprintf(buf, sizeof(buf), "/gcc-%d.%d", __GNUC__, __GNUC_MINOR__);
+#else
+    snprintf(buf, sizeof(buf), "/cc");
+#endif
+    label += buf;
+#ifdef HAVE_BOOST_INTRUSIVE
+    label += "/boost";
+#endif
+    time_t now = time(NULL);
+    struct tm utc;
+    if(gmtime_r(&now, &utc)
+        && strftime(buf, sizeof(buf), "/%Y-%m-%dT%H:%M:%SZ", &utc))
+    {
+        label += buf;
+    }
+    return label;
+}
+
+/* Quote a CSV field if it has a comma, quote or line break. */
+static string CsvField(const string &field) {
+    if(field.find_first_of(",\"\r\n") == string::npos) {
+        return field;
+    }
+    string quoted = "\"";
+    for(size_t i = 0; i < field.size(); ++i) {
+        if(field[i] == '"') {
+            quoted += '"';
+        }
+        quoted += field[i];
+    }
+    return quoted + "\"";
+}
+
+static void Print(const result &r, const string &format, const string &label,
+    bool first)
+{
+    if(format == "json") {
+        printf("%s\n  {\"label\": \"%s\", \"impl\": \"%s\", \"op\": \"%s\", "
+            "\"size\": %lu, \"ops\": %lu, \"ns_per_op\": %.3f, "
+            "\"mops_per_s\": %.3f, \"p50_ns\": %.3f, \"p90_ns\": %.3f, "
+            "\"p99_ns\": %.3f}", first ? "" : ",", label.c_str(),
+            r.impl.c_str(), r.op.c_str(), (unsigned long)r.size,
+            (unsigned long)r.ops, r.ns_per_op, r.mops, r.p50, r.p90, r.p99);
+    }
+    else {
+        printf("%s,%s,%s,%lu,%lu,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+            CsvField(label).c_str(),
+            r.impl.c_str(), r.op.c_str(), (unsigned long)r.size,
+            (unsigned long)r.ops, r.ns_per_op, r.mops, r.p50, r.p90, r.p99);
+    }
+    fflush(stdout);
+}
+
+template <class Impl>
+static void RunImpl(const vector<size_t> &sizes, size_t min_ops,
+    const string &ops, const string &format, const string &label, bool &first)
+{
+    for(size_t s = 0; s < sizes.size(); ++s) {
+        for(int op = 0; op < OP_COUNT; ++op) {
+            if(Selected(ops, op_names[op])) {
+                Print(Measure<Impl>((enum op)op, sizes[s], min_ops), format,
+                    label, first);
+                first = false;
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    string format = "csv", impls, ops, label;
+    vector<size_t> sizes;
+    size_t min_ops = 1000000;
+    bool first = true;
+
+    for(int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        if(!strncmp(arg, "--format=", 9)) {
+            format = arg + 9;
+        }
+        else if(!strncmp(arg, "--sizes=", 8)) {
+            for(const char *p = arg + 8; *p; ) {
+                char *end;
+                size_t size = (size_t)strtoul(p, &end, 10);
+                if(!size || end == p) {
+                    fprintf(stderr, "Invalid size list: %s\n", arg + 8);
+                    return 1;
+                }
+                sizes.push_back(size);
+                p = (*end == ',') ? end + 1 : end;
+            }
+        }
+        else if(!strncmp(arg, "--min-ops=", 10)) {
+            min_ops = (size_t)strtoul(arg + 10, NULL, 10);
+        }
+        else if(!strncmp(arg, "--impls=", 8)) {
+            impls = arg + 8;
+        }
+        else if(!strncmp(arg, "--ops=", 6)) {
+            ops = arg + 6;
+        }
+        else if(!strncmp(arg, "--label=", 8)) {
+            label = arg + 8;
+        }
+        else {
+            fprintf(stderr, "Usage: microbench [--format=csv|json] "
+                "[--sizes=1,10,...] [--min-ops=N]\n"
+                "                  [--impls=generic,kernel,boost,std] "
+                "[--ops=link_first,...] [--label=TEXT]\n");
+            return 1;
+        }
+    }
+    if(format != "csv" && format != "json") {
+        fprintf(stderr, "Unknown format: %s\n", format.c_str());
+        return 1;
+    }
+    if(sizes.empty()) {
+        size_t size;
+        for(size = 1; size <= 10000000; size *= 10) {
+            sizes.push_back(size);
+        }
+    }
+    if(!min_ops) {
+        min_ops = 1;
+    }
+    if(label.empty()) {
+        label = DefaultLabel();
+    }
+
+    if(format == "json") {
+        printf("[");
+    }
+    else {
+        printf("label,impl,op,size,ops,ns_per_op,mops_per_s,p50_ns,p90_ns,"
+            "p99_ns\n");
+    }
+    if(Selected(impls, GenericImpl::Name())) {
+        RunImpl<GenericImpl>(sizes, min_ops, ops, format, label, first);
+    }
+    if(Selected(impls, KernelImpl::Name())) {
+        RunImpl<KernelImpl>(sizes, min_ops, ops, format, label, first);
+    }
+#ifdef HAVE_BOOST_INTRUSIVE
+    if(Selected(impls, BoostImpl::Name())) {
+        RunImpl<BoostImpl>(sizes, min_ops, ops, format, label, first);
+    }
+#endif
+    if(Selected(impls, StdImpl::Name())) {
+        RunImpl<StdImpl>(sizes, min_ops, ops, format, label, first);
+    }
+    if(format == "json") {
+        printf("\n]\n");
+    }
+    return 0;
+}
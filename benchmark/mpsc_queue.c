@@ -0,0 +1,245 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Many-producer stress run and benchmark of generic_mpsc_queue.h (Linux).
+
+Each producer thread pushes 'items' nodes stamped with its id and a sequence
+number, and one consumer thread takes them all. The consumer checks that every
+node arrives exactly once and that each producer's nodes arrive in the order
+they were pushed, and the run fails if they do not. Three consumers are timed:
+
+mpsc pop   : MPSC_QUEUE_POP one node at a time.
+mpsc drain : MPSC_QUEUE_DRAIN everything available into a list.
+mutex      : LINK_NODE_LAST/UNLINK_NODE with a pthread mutex around each call.
+
+cc -O2 -pthread -I.. mpsc_queue.c -o mpsc_queue
+./mpsc_queue [producers] [items per producer]
+*/
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "generic_mpsc_queue.h"
+
+struct work_list;
+struct work_node {
+    DECLARE_NODE_MEMBERS(work_node, work_list);
+    unsigned producer;
+    unsigned long seq;
+};
+struct work_list {
+    DECLARE_LIST_MEMBERS(work_node);
+};
+struct work_queue {
+    DECLARE_MPSC_QUEUE_MEMBERS(work_node);
+};
+
+enum mode { MODE_POP, MODE_DRAIN, MODE_MUTEX };
+
+static struct work_queue queue;
+static struct work_list locked_list;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned producers = 4;
+static unsigned long items = 1000000;
+static enum mode mode;
+static struct work_node **producer_nodes;
+static unsigned long *expected_seq;
+static pthread_barrier_t barrier;
+
+static void *Producer(void *arg) {
+    unsigned id = (unsigned)(size_t)arg;
+    unsigned long i;
+    pthread_barrier_wait(&barrier);
+    for(i = 0; i < items; ++i) {
+        struct work_node *node = &producer_nodes[id][i];
+        if(mode == MODE_MUTEX) {
+            pthread_mutex_lock(&mutex);
+            LINK_NODE_LAST(node, &locked_list);
+            pthread_mutex_unlock(&mutex);
+        }
+        else {
+            MPSC_QUEUE_PUSH(&queue, node);
+        }
+    }
+    return NULL;
+}
+
+/* Returns 0 if the node is the next one expected from its producer. */
+static int Consume(struct work_node *node) {
+    if(node->producer >= producers
+        || node->seq != expected_seq[node->producer])
+    {
+        fprintf(stderr, "FAILED: producer %u seq %lu arrived out of order.\n",
+            node->producer, node->seq);
+        return 1;
+    }
+    ++expected_seq[node->producer];
+    return 0;
+}
+
+static int RunConsumer(void) {
+    unsigned long remaining = producers * items;
+    struct work_list batch = { NULL, NULL, 0 };
+    struct work_node *node = NULL;
+
+    while(remaining) {
+        switch(mode) {
+        case MODE_POP:
+            MPSC_QUEUE_POP(&queue, node);
+            if(node) {
+                if(Consume(node)) {
+                    return 1;
+                }
+                --remaining;
+            }
+            break;
+        case MODE_DRAIN:
+            MPSC_QUEUE_DRAIN(&queue, &batch);
+            while(batch.head) {
+                node = batch.head;
+                UNLINK_NODE(node);
+                if(Consume(node)) {
+                    return 1;
+                }
+                --remaining;
+            }
+            break;
+        case MODE_MUTEX:
+            pthread_mutex_lock(&mutex);
+            node = locked_list.head;
+            UNLINK_NODE(node);
+            pthread_mutex_unlock(&mutex);
+            if(node) {
+                if(Consume(node)) {
+                    return 1;
+                }
+                --remaining;
+            }
+            break;
+        }
+    }
+    return 0;
+}
+
+static int Run(enum mode run_mode, const char *name) {
+    unsigned p;
+    unsigned long i;
+    pthread_t *threads = calloc(producers, sizeof(*threads));
+    struct timespec start, end;
+    double seconds;
+    int failed;
+
+    if(!threads) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    mode = run_mode;
+    INIT_MPSC_QUEUE_MEMBERS(&queue);
+    ZERO_OUT_LIST_MEMBERS(&locked_list);
+    for(p = 0; p < producers; ++p) {
+        expected_seq[p] = 0;
+        for(i = 0; i < items; ++i) {
+            ZERO_OUT_NODE_MEMBERS(&producer_nodes[p][i]);
+            producer_nodes[p][i].producer = p;
+            producer_nodes[p][i].seq = i;
+        }
+    }
+
+    pthread_barrier_init(&barrier, NULL, producers + 1);
+    for(p = 0; p < producers; ++p) {
+        if(pthread_create(&threads[p], NULL, Producer, (void *)(size_t)p)) {
+            fprintf(stderr, "Failed to create thread.\n");
+            exit(1);
+        }
+    }
+    pthread_barrier_wait(&barrier);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    failed = RunConsumer();
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    for(p = 0; p < producers; ++p) {
+        pthread_join(threads[p], NULL);
+    }
+    pthread_barrier_destroy(&barrier);
+    free(threads);
+
+    if(failed) {
+        return 1;
+    }
+    seconds = (double)(end.tv_sec - start.tv_sec)
+        + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%-10s : %8.3f s, %12.0f items/s\n", name, seconds,
+        (double)producers * (double)items / seconds);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned p;
+    int failed = 0;
+
+    if(argc > 1) {
+        producers = (unsigned)strtoul(argv[1], NULL, 10);
+    }
+    if(argc > 2) {
+        items = strtoul(argv[2], NULL, 10);
+    }
+    if(!producers || !items) {
+        fprintf(stderr,
+            "Usage: mpsc_queue [producers] [items per producer]\n");
+        return 1;
+    }
+
+    producer_nodes = calloc(producers, sizeof(*producer_nodes));
+    expected_seq = calloc(producers, sizeof(*expected_seq));
+    if(!producer_nodes || !expected_seq) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    for(p = 0; p < producers; ++p) {
+        producer_nodes[p] = calloc(items, sizeof(**producer_nodes));
+        if(!producer_nodes[p]) {
+            fprintf(stderr, "Out of memory.\n");
+            return 1;
+        }
+    }
+
+    printf("%u producers, %lu items per producer\n", producers, items);
+    failed |= Run(MODE_POP, "mpsc pop");
+    failed |= Run(MODE_DRAIN, "mpsc drain");
+    failed |= Run(MODE_MUTEX, "mutex");
+
+    for(p = 0; p < producers; ++p) {
+        free(producer_nodes[p]);
+    }
+    free(producer_nodes);
+    free(expected_seq);
+    return failed;
+}
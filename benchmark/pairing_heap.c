@@ -0,0 +1,401 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Benchmark generic_pairing_heap.h against a binary heap of node pointers.
+
+The same scheduler-like workload is run on both heaps: a heap of 'size' nodes
+receives a random mix of decrease-key, arbitrary remove + reinsert and
+delete-min + reinsert operations. The binary heap keeps each node's array index
+in the node so that its decrease-key and remove are O(log n) rather than a
+search.
+
+Before the timing runs a check applies a random mix of the heap operations to
+both heaps and fails if the pairing heap's minimum, delete-min order or node
+counts differ from the binary heap's, including after a remove and a meld.
+Built with GENERIC_LIST_STATS it also fails if a heap's link and unlink
+counters don't add up to its count.
+
+cc -O2 -I.. pairing_heap.c -o pairing_heap
+cc -O2 -I.. -DGENERIC_LIST_STATS pairing_heap.c -o pairing_heap_stats
+./pairing_heap [size] [operations]
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "generic_pairing_heap.h"
+
+struct task_heap;
+struct task_node {
+    DECLARE_PAIRING_HEAP_NODE_MEMBERS(task_node, task_heap);
+    unsigned long key;
+    size_t index; /* used by the binary heap only */
+};
+struct task_heap {
+    DECLARE_PAIRING_HEAP_MEMBERS(task_node);
+};
+
+#define task_less(a, b)   ((a)->key < (b)->key)
+
+
+struct binary_heap {
+    struct task_node **nodes;
+    size_t count;
+};
+
+static void BinaryHeapSwap(struct binary_heap *heap, size_t a, size_t b) {
+    struct task_node *temp = heap->nodes[a];
+    heap->nodes[a] = heap->nodes[b];
+    heap->nodes[b] = temp;
+    heap->nodes[a]->index = a;
+    heap->nodes[b]->index = b;
+}
+
+static void BinaryHeapUp(struct binary_heap *heap, size_t i) {
+    while(i && task_less(heap->nodes[i], heap->nodes[(i - 1) / 2])) {
+        BinaryHeapSwap(heap, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void BinaryHeapDown(struct binary_heap *heap, size_t i) {
+    for(;;) {
+        size_t min = i, left = 2 * i + 1, right = 2 * i + 2;
+        if(left < heap->count
+            && task_less(heap->nodes[left], heap->nodes[min]))
+        {
+            min = left;
+        }
+        if(right < heap->count
+            && task_less(heap->nodes[right], heap->nodes[min]))
+        {
+            min = right;
+        }
+        if(min == i) {
+            return;
+        }
+        BinaryHeapSwap(heap, i, min);
+        i = min;
+    }
+}
+
+static void BinaryHeapInsert(struct binary_heap *heap,
+    struct task_node *node)
+{
+    node->index = heap->count;
+    heap->nodes[heap->count++] = node;
+    BinaryHeapUp(heap, node->index);
+}
+
+static void BinaryHeapRemove(struct binary_heap *heap,
+    struct task_node *node)
+{
+    size_t i = node->index;
+    if(i != --heap->count) {
+        BinaryHeapSwap(heap, i, heap->count);
+        BinaryHeapUp(heap, i);
+        BinaryHeapDown(heap, heap->nodes[i]->index);
+    }
+}
+
+
+static unsigned long long rand_state = 1;
+
+static unsigned long Random(void) {
+    rand_state = rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (unsigned long)(rand_state >> 33);
+}
+
+static struct task_node *AllocNodes(size_t size) {
+    size_t i;
+    struct task_node *nodes = calloc(size, sizeof(*nodes));
+    if(!nodes) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    rand_state = 1;
+    for(i = 0; i < size; ++i) {
+        nodes[i].key = Random();
+    }
+    return nodes;
+}
+
+static void Fail(const char *what) {
+    fprintf(stderr, "FAILED: %s\n", what);
+    exit(1);
+}
+
+/* Fail if the link and unlink counters of a heap don't add up to its count. */
+static void CheckStats(struct task_heap *heap) {
+#ifdef GENERIC_LIST_STATS
+    struct generic_list_stats stats;
+    LIST_STATS_SNAPSHOT(heap, stats);
+    if(stats.links - stats.unlinks != heap->count
+        || stats.max_count < heap->count)
+    {
+        Fail("The heap's statistics don't agree with its count.");
+    }
+#else
+    (void)heap;
+#endif
+}
+
+/* Check that each node in the pairing heap has the heap as its parent and
+that the counts and minimum agree with the binary heap. */
+static void CheckHeaps(struct task_heap *heap, struct task_node *nodes,
+    struct binary_heap *binary, size_t size)
+{
+    size_t i, linked = 0;
+
+    for(i = 0; i < size; ++i) {
+        if(nodes[i].parent == heap) {
+            ++linked;
+        }
+        else if(nodes[i].parent) {
+            Fail("A node has the wrong heap.");
+        }
+    }
+    if(heap->count != linked || heap->count != binary->count) {
+        Fail("The pairing heap's count is wrong.");
+    }
+    if(!heap->head != !binary->count
+        || (heap->head && heap->head->key != binary->nodes[0]->key))
+    {
+        Fail("The pairing heap's minimum is wrong.");
+    }
+    CheckStats(heap);
+}
+
+/* Apply the same random operations to a pairing heap and a binary heap of
+copies of the same nodes. Node i of one heap always has the key of node i of
+the other, so when there is a tie for the minimum the node the pairing heap
+deletes is also removed from the binary heap. */
+static void CheckRandomOps(void) {
+    enum { POOL = 300, OPS = 200000 };
+    static struct task_node pool[POOL], copies[POOL];
+    static struct task_node *binary_nodes[POOL];
+    struct task_heap heap, side;
+    struct task_node *min;
+    struct binary_heap binary;
+    unsigned long op;
+    size_t i;
+
+    rand_state = 1;
+    ZERO_OUT_PAIRING_HEAP_MEMBERS(&heap);
+    ZERO_OUT_PAIRING_HEAP_MEMBERS(&side);
+    binary.nodes = binary_nodes;
+    binary.count = 0;
+    for(op = 0; op < OPS; ++op) {
+        size_t index = (size_t)(Random() % POOL);
+        struct task_node *node = &pool[index], *copy = &copies[index];
+        size_t count = heap.count;
+        unsigned long key;
+
+        switch(Random() % 6) {
+        case 0:
+        case 1:
+            if(node->parent) {
+                break;
+            }
+            node->key = copy->key = Random() % 1000;
+            PAIRING_HEAP_INSERT(&heap, node, task_less);
+            BinaryHeapInsert(&binary, copy);
+            if(heap.count != count + 1) {
+                Fail("An insert didn't add one node.");
+            }
+            break;
+        case 2:
+            if(!node->parent) {
+                break;
+            }
+            node->key -= node->key / 4;
+            copy->key = node->key;
+            PAIRING_HEAP_DECREASE_KEY(&heap, node, task_less);
+            BinaryHeapUp(&binary, copy->index);
+            break;
+        case 3:
+            if(!node->parent) {
+                break;
+            }
+            PAIRING_HEAP_REMOVE(&heap, node, task_less);
+            BinaryHeapRemove(&binary, copy);
+            if(node->parent || heap.count != count - 1) {
+                Fail("A remove didn't unlink one node.");
+            }
+            break;
+        case 4:
+            node = PAIRING_HEAP_MIN(&heap);
+            if(!node) {
+                break;
+            }
+            key = node->key;
+            PAIRING_HEAP_DELETE_MIN(&heap, task_less);
+            if(key != binary.nodes[0]->key) {
+                Fail("A delete-min is not in the binary heap's order.");
+            }
+            BinaryHeapRemove(&binary, &copies[node - pool]);
+            if(node->parent || heap.count != count - 1) {
+                Fail("A delete-min didn't unlink one node.");
+            }
+            break;
+        default:
+            /* move some nodes to another heap and meld them back */
+            for(i = 0; i < POOL; i += 1 + (size_t)(Random() % 8)) {
+                if(pool[i].parent) {
+                    PAIRING_HEAP_REMOVE(&heap, &pool[i], task_less);
+                    PAIRING_HEAP_INSERT(&side, &pool[i], task_less);
+                }
+            }
+            if(heap.count + side.count != count) {
+                Fail("Moving nodes to another heap changed the count.");
+            }
+            PAIRING_HEAP_MELD(&heap, &side, task_less);
+            if(heap.count != count || side.count || side.head) {
+                Fail("A meld didn't move every node.");
+            }
+            CheckStats(&side);
+            break;
+        }
+        CheckHeaps(&heap, pool, &binary, POOL);
+    }
+    while(heap.head) {
+        min = heap.head;
+        if(min->key != binary.nodes[0]->key) {
+            Fail("A delete-min is not in the binary heap's order.");
+        }
+        PAIRING_HEAP_DELETE_MIN(&heap, task_less);
+        BinaryHeapRemove(&binary, &copies[min - pool]);
+        CheckHeaps(&heap, pool, &binary, POOL);
+    }
+    printf("heap check: %lu random operations OK\n", (unsigned long)OPS);
+}
+
+static double RunPairingHeap(size_t size, size_t operations) {
+    size_t i;
+    clock_t start;
+    struct task_heap heap;
+    struct task_node *nodes = AllocNodes(size);
+
+    ZERO_OUT_PAIRING_HEAP_MEMBERS(&heap);
+    start = clock();
+    for(i = 0; i < size; ++i) {
+        struct task_node *node = &nodes[i];
+        PAIRING_HEAP_INSERT(&heap, node, task_less);
+    }
+    for(i = 0; i < operations; ++i) {
+        struct task_node *node = &nodes[Random() % size];
+        switch(Random() % 3) {
+        case 0:
+            node->key -= node->key / 4;
+            PAIRING_HEAP_DECREASE_KEY(&heap, node, task_less);
+            break;
+        case 1:
+            PAIRING_HEAP_REMOVE(&heap, node, task_less);
+            node->key = Random();
+            PAIRING_HEAP_INSERT(&heap, node, task_less);
+            break;
+        default:
+            node = PAIRING_HEAP_MIN(&heap);
+            PAIRING_HEAP_DELETE_MIN(&heap, task_less);
+            node->key += Random() % 65536;
+            PAIRING_HEAP_INSERT(&heap, node, task_less);
+            break;
+        }
+    }
+    while(heap.head) {
+        PAIRING_HEAP_DELETE_MIN(&heap, task_less);
+    }
+    free(nodes);
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static double RunBinaryHeap(size_t size, size_t operations) {
+    size_t i;
+    clock_t start;
+    struct binary_heap heap;
+    struct task_node *nodes = AllocNodes(size);
+
+    heap.count = 0;
+    heap.nodes = malloc(size * sizeof(*heap.nodes));
+    if(!heap.nodes) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    start = clock();
+    for(i = 0; i < size; ++i) {
+        BinaryHeapInsert(&heap, &nodes[i]);
+    }
+    for(i = 0; i < operations; ++i) {
+        struct task_node *node = &nodes[Random() % size];
+        switch(Random() % 3) {
+        case 0:
+            node->key -= node->key / 4;
+            BinaryHeapUp(&heap, node->index);
+            break;
+        case 1:
+            BinaryHeapRemove(&heap, node);
+            node->key = Random();
+            BinaryHeapInsert(&heap, node);
+            break;
+        default:
+            node = heap.nodes[0];
+            BinaryHeapRemove(&heap, node);
+            node->key += Random() % 65536;
+            BinaryHeapInsert(&heap, node);
+            break;
+        }
+    }
+    while(heap.count) {
+        BinaryHeapRemove(&heap, heap.nodes[0]);
+    }
+    free(heap.nodes);
+    free(nodes);
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char *argv[]) {
+    size_t size = (argc > 1) ? (size_t)strtoul(argv[1], NULL, 10) : 1000000;
+    size_t operations =
+        (argc > 2) ? (size_t)strtoul(argv[2], NULL, 10) : 10000000;
+    double pairing, binary;
+
+    if(!size) {
+        fprintf(stderr, "Size must be greater than 0.\n");
+        return 1;
+    }
+    CheckRandomOps();
+    pairing = RunPairingHeap(size, operations);
+    binary = RunBinaryHeap(size, operations);
+    printf("size %lu, operations %lu\n",
+        (unsigned long)size, (unsigned long)operations);
+    printf("pairing heap: %.3f s\n", pairing);
+    printf("binary heap:  %.3f s\n", binary);
+    return 0;
+}
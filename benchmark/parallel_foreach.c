@@ -0,0 +1,256 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Read-only scan benchmark of LIST_PARALLEL_FOREACH (Linux).
+
+First the anchor index is checked: random ANCHORED_ links and unlinks with a
+small segment size, checking every segment record against the list after each
+change. Then a list of 'count' nodes is built with ANCHORED_LINK_NODE_LAST and
+the sum of the nodes' values is computed:
+
+serial   : A plain walk of the list by 'next'.
+parallel : LIST_PARALLEL_FOREACH with a pool of 0 to 'threads'-1 workers, so 1
+           to 'threads' threads in total including the caller.
+
+cc -O2 -pthread -I.. parallel_foreach.c ../generic_parallel.c \
+   -o parallel_foreach
+./parallel_foreach [count] [threads] [k]
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "generic_anchored_list.h"
+#include "generic_parallel.h"
+
+struct value_list;
+struct value_node {
+    DECLARE_ANCHORED_NODE_MEMBERS(value_node, value_list);
+    unsigned long value;
+    unsigned visits;
+};
+struct value_list {
+    DECLARE_ANCHORED_LIST_MEMBERS(value_node);
+};
+
+static void Fail(const char *what) {
+    fprintf(stderr, "FAILED: %s\n", what);
+    exit(1);
+}
+
+/* Check every segment record and every node's anchor against the list. */
+static void CheckIndex(struct value_list *list) {
+    struct value_node *node = list->head, *anchor, *prev_anchor = NULL;
+    size_t i, nodes = 0, anchors = 0;
+
+    for(anchor = list->first_anchor; anchor; anchor = anchor->seg_next) {
+        int has_holder = 0;
+        if(anchor->seg_prev != prev_anchor) {
+            Fail("A segment record has the wrong previous record.");
+        }
+        if(anchor->seg_first != node || !anchor->seg_count) {
+            Fail("A segment doesn't start after the previous one.");
+        }
+        for(i = 0; i < anchor->seg_count; ++i, node = node->next) {
+            if(!node || node->anchor != anchor || node->parent != list) {
+                Fail("A node has the wrong anchor.");
+            }
+            if(node == anchor) {
+                has_holder = 1;
+            }
+        }
+        if(!has_holder) {
+            Fail("An anchor is not in its own segment.");
+        }
+        if(anchor->seg_count >= 2 * list->anchor_k) {
+            Fail("A segment was not split.");
+        }
+        nodes += anchor->seg_count;
+        ++anchors;
+        prev_anchor = anchor;
+    }
+    if(node || nodes != list->count || anchors != list->anchor_count
+        || list->last_anchor != prev_anchor)
+    {
+        Fail("The segments don't cover the list.");
+    }
+}
+
+static void CheckRandomOps(void) {
+    enum { POOL = 500, OPS = 200000 };
+    static struct value_node pool[POOL];
+    struct value_list list;
+    unsigned long op;
+    size_t i;
+
+    srand(1);
+    INIT_ANCHORED_LIST_MEMBERS(&list, 8);
+    for(i = 0; i < POOL; ++i) {
+        ZERO_OUT_ANCHORED_NODE_MEMBERS(&pool[i]);
+    }
+    for(op = 0; op < OPS; ++op) {
+        struct value_node *node = &pool[(size_t)rand() % POOL];
+        struct value_node *position = &pool[(size_t)rand() % POOL];
+        if(node->parent) {
+            ANCHORED_UNLINK_NODE(node);
+            if(node->parent || node->anchor) {
+                Fail("An unlinked node is still in the list.");
+            }
+        }
+        else {
+            switch(rand() % 4) {
+            case 0: ANCHORED_LINK_NODE_FIRST(node, &list); break;
+            case 1: ANCHORED_LINK_NODE_LAST(node, &list); break;
+            case 2:
+                if(position->parent) {
+                    ANCHORED_LINK_NODE_BEFORE(node, position);
+                }
+                break;
+            default:
+                if(position->parent) {
+                    ANCHORED_LINK_NODE_AFTER(node, position);
+                }
+                break;
+            }
+        }
+        CheckIndex(&list);
+    }
+    printf("index check: %lu random links and unlinks OK, %lu nodes in %lu "
+        "segments\n", (unsigned long)OPS, (unsigned long)list.count,
+        (unsigned long)list.anchor_count);
+}
+
+/* The per-node work of the scan: count the values whose hash is a multiple of
+1024. A match is rare so the shared counter is rarely touched. */
+static void Match(void *node, void *arg) {
+    unsigned long long h = ((struct value_node *)node)->value;
+    h *= 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 32;
+    if(!(h & 1023)) {
+        __atomic_fetch_add((unsigned long *)arg, 1UL, __ATOMIC_RELAXED);
+    }
+}
+
+static void Visit(void *node, void *arg) {
+    (void)arg;
+    ++((struct value_node *)node)->visits;
+}
+
+static double Seconds(const struct timespec *start,
+    const struct timespec *end)
+{
+    return (double)(end->tv_sec - start->tv_sec)
+        + (double)(end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = 4000000, k = 1024, i;
+    unsigned threads = 4, t;
+    struct value_list list;
+    struct value_node *nodes, *node;
+    struct parallel_pool *pool;
+    unsigned long expected = 0, matches;
+    struct timespec start, end;
+    double serial;
+
+    if(argc > 1) {
+        count = (size_t)strtoul(argv[1], NULL, 10);
+    }
+    if(argc > 2) {
+        threads = (unsigned)strtoul(argv[2], NULL, 10);
+    }
+    if(argc > 3) {
+        k = (size_t)strtoul(argv[3], NULL, 10);
+    }
+    if(!count || !threads || !k) {
+        fprintf(stderr, "Usage: parallel_foreach [count] [threads] [k]\n");
+        return 1;
+    }
+
+    CheckRandomOps();
+
+    nodes = calloc(count, sizeof(*nodes));
+    if(!nodes) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    INIT_ANCHORED_LIST_MEMBERS(&list, k);
+    for(i = 0; i < count; ++i) {
+        ZERO_OUT_ANCHORED_NODE_MEMBERS(&nodes[i]);
+        nodes[i].value = (unsigned long)i;
+        ANCHORED_LINK_NODE_LAST(&nodes[i], &list);
+    }
+    CheckIndex(&list);
+
+    pool = parallel_pool_create(threads - 1);
+    if(!pool) {
+        Fail("Can't create the thread pool.");
+    }
+    LIST_PARALLEL_FOREACH(&list, pool, Visit, NULL);
+    for(i = 0; i < count; ++i) {
+        if(nodes[i].visits != 1) {
+            Fail("A node was not visited exactly once.");
+        }
+    }
+    parallel_pool_destroy(pool);
+    printf("count: %lu, k: %lu, segments: %lu\n", (unsigned long)count,
+        (unsigned long)k, (unsigned long)list.anchor_count);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(node = list.head; node; node = node->next) {
+        Match(node, &expected);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    serial = Seconds(&start, &end);
+    printf("serial:             %8.2f ms\n", serial * 1e3);
+
+    for(t = 1; t <= threads; ++t) {
+        double seconds;
+        pool = parallel_pool_create(t - 1);
+        if(!pool) {
+            Fail("Can't create the thread pool.");
+        }
+        matches = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        LIST_PARALLEL_FOREACH(&list, pool, Match, &matches);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        parallel_pool_destroy(pool);
+        if(matches != expected) {
+            Fail("The parallel scan found a different number of matches.");
+        }
+        seconds = Seconds(&start, &end);
+        printf("parallel %2u thread%s: %8.2f ms (%.2fx)\n", t,
+            (t == 1) ? " " : "s", seconds * 1e3, serial / seconds);
+    }
+    free(nodes);
+    return 0;
+}
@@ -0,0 +1,282 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Read-mostly stress run and benchmark of generic_rcu_list.h (Linux).
+
+A list of 'entries' config nodes, sorted by key, is traversed by 'readers'
+threads while one writer thread replaces a random entry with a new copy over
+and over: RCU_REPLACE_NODE swaps the copy in and the old node is retired with
+epoch_retire.
+
+First a one second check is run in which the nodes that epoch reclamation
+frees are poisoned and kept instead, so that reading one is not a use after
+free. Every traversal checks that it saw each key exactly once, in order, and
+no poisoned node, and the run fails if it did not. Then the same run is timed
+with nodes really freed, and with the plain macros and a pthread rwlock around
+every traversal and replacement.
+
+cc -O2 -pthread -I.. rcu_list.c ../generic_epoch.c -o rcu_list
+./rcu_list [readers] [entries] [seconds]
+*/
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "generic_rcu_list.h"
+#include "generic_epoch.h"
+
+#define LIVE_MAGIC   0x11FE11FEu
+#define DEAD_MAGIC   0xDEADDEADu
+
+struct config_list;
+struct config_node {
+    DECLARE_NODE_MEMBERS(config_node, config_list);
+    struct epoch_entry retire;
+    unsigned magic;
+    unsigned long key;
+    unsigned long version;
+    /* the next node in the graveyard, once the node is poisoned */
+    struct config_node *grave;
+};
+struct config_list {
+    DECLARE_LIST_MEMBERS(config_node);
+};
+
+static struct config_list config;
+static struct epoch_domain domain;
+static pthread_rwlock_t rwlock = PTHREAD_RWLOCK_INITIALIZER;
+
+static int use_rwlock;
+/* nonzero to poison retired nodes and keep them in 'graveyard' until the end
+of the run instead of freeing them */
+static int quarantine;
+static struct config_node *graveyard;
+static int stop;
+static unsigned long entries = 100;
+static pthread_barrier_t barrier;
+static unsigned long total_reads;
+static unsigned long total_writes;
+static pthread_mutex_t total_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static struct config_node *NewNode(unsigned long key, unsigned long version) {
+    struct config_node *node = calloc(1, sizeof(*node));
+    if(!node) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    node->magic = LIVE_MAGIC;
+    node->key = key;
+    node->version = version;
+    return node;
+}
+
+/* Only the writer thread retires nodes, so only it calls this. */
+static void FreeNode(void *ptr) {
+    struct config_node *node = (struct config_node *)ptr;
+    if(quarantine) {
+        node->magic = DEAD_MAGIC;
+        node->grave = graveyard;
+        graveyard = node;
+        return;
+    }
+    free(node);
+}
+
+/* Returns nonzero if the traversal saw keys 0 to entries-1 in order. */
+static int Traverse(void) {
+    struct config_node *node = NULL;
+    unsigned long expected = 0;
+    if(use_rwlock) {
+        for(node = config.head; node; node = node->next) {
+            if(node->magic != LIVE_MAGIC || node->key != expected++) {
+                return 0;
+            }
+        }
+    }
+    else {
+        RCU_LIST_FOREACH(node, &config) {
+            if(node->magic != LIVE_MAGIC || node->key != expected++) {
+                return 0;
+            }
+        }
+    }
+    return expected == entries;
+}
+
+static void *Reader(void *arg) {
+    struct epoch_thread thread;
+    unsigned long reads = 0;
+    (void)arg;
+    epoch_thread_register(&domain, &thread);
+    pthread_barrier_wait(&barrier);
+    while(!__atomic_load_n(&stop, __ATOMIC_RELAXED)) {
+        int ok;
+        if(use_rwlock) {
+            pthread_rwlock_rdlock(&rwlock);
+            ok = Traverse();
+            pthread_rwlock_unlock(&rwlock);
+        }
+        else {
+            epoch_enter(&thread);
+            ok = Traverse();
+            epoch_exit(&thread);
+        }
+        if(!ok) {
+            fprintf(stderr, "FAILED: A reader saw a broken list.\n");
+            exit(1);
+        }
+        ++reads;
+    }
+    epoch_thread_unregister(&thread);
+    pthread_mutex_lock(&total_mutex);
+    total_reads += reads;
+    pthread_mutex_unlock(&total_mutex);
+    return NULL;
+}
+
+static void *Writer(void *arg) {
+    struct epoch_thread thread;
+    unsigned long writes = 0;
+    unsigned long long rand_state = 1;
+    (void)arg;
+    epoch_thread_register(&domain, &thread);
+    pthread_barrier_wait(&barrier);
+    while(!__atomic_load_n(&stop, __ATOMIC_RELAXED)) {
+        unsigned long key;
+        struct config_node *old = NULL, *node = NULL;
+        rand_state = rand_state * 6364136223846793005ULL
+            + 1442695040888963407ULL;
+        key = (unsigned long)(rand_state >> 33) % entries;
+        if(use_rwlock) {
+            pthread_rwlock_wrlock(&rwlock);
+        }
+        for(old = config.head; old->key != key; old = old->next) {
+        }
+        node = NewNode(key, old->version + 1);
+        if(use_rwlock) {
+            LINK_NODE_AFTER(node, old);
+            UNLINK_NODE(old);
+            pthread_rwlock_unlock(&rwlock);
+            FreeNode(old);
+        }
+        else {
+            RCU_REPLACE_NODE(old, node);
+            epoch_retire(&thread, &old->retire, old, FreeNode);
+            epoch_collect(&thread);
+        }
+        ++writes;
+    }
+    epoch_thread_unregister(&thread);
+    total_writes = writes;
+    return NULL;
+}
+
+static void Run(unsigned readers, unsigned seconds, int run_use_rwlock,
+    int run_quarantine)
+{
+    unsigned t;
+    unsigned long i;
+    pthread_t *ids = calloc(readers + 1, sizeof(*ids));
+    struct config_node *node = NULL;
+
+    if(!ids) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    use_rwlock = run_use_rwlock;
+    quarantine = run_quarantine;
+    graveyard = NULL;
+    stop = 0;
+    total_reads = total_writes = 0;
+    epoch_domain_init(&domain);
+    ZERO_OUT_LIST_MEMBERS(&config);
+    for(i = 0; i < entries; ++i) {
+        node = NewNode(i, 0);
+        LINK_NODE_LAST(node, &config);
+    }
+
+    pthread_barrier_init(&barrier, NULL, readers + 2);
+    for(t = 0; t <= readers; ++t) {
+        if(pthread_create(&ids[t], NULL, t ? Reader : Writer, NULL)) {
+            fprintf(stderr, "Failed to create thread.\n");
+            exit(1);
+        }
+    }
+    pthread_barrier_wait(&barrier);
+    sleep(seconds);
+    __atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+    for(t = 0; t <= readers; ++t) {
+        pthread_join(ids[t], NULL);
+    }
+    pthread_barrier_destroy(&barrier);
+    free(ids);
+
+    while(config.head) {
+        node = config.head;
+        UNLINK_NODE(node);
+        free(node);
+    }
+    while(graveyard) {
+        node = graveyard;
+        graveyard = node->grave;
+        free(node);
+    }
+    printf("%s, %u, %.0f, %.0f\n",
+        quarantine ? "rcu check" : use_rwlock ? "rwlock" : "rcu", readers,
+        (double)total_reads / seconds, (double)total_writes / seconds);
+}
+
+int main(int argc, char *argv[]) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned readers = (online > 1) ? (unsigned)online - 1 : 1;
+    unsigned seconds = 2;
+
+    if(argc > 1) {
+        readers = (unsigned)strtoul(argv[1], NULL, 10);
+    }
+    if(argc > 2) {
+        entries = strtoul(argv[2], NULL, 10);
+    }
+    if(argc > 3) {
+        seconds = (unsigned)strtoul(argv[3], NULL, 10);
+    }
+    if(!readers || !entries || !seconds) {
+        fprintf(stderr, "Usage: rcu_list [readers] [entries] [seconds]\n");
+        return 1;
+    }
+
+    printf("mode, readers, traversals/s, replacements/s\n");
+    Run(readers, 1, 0, 1);
+    Run(readers, seconds, 0, 0);
+    Run(readers, seconds, 1, 0);
+    return 0;
+}
@@ -0,0 +1,261 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Dispatch benchmark of the bitmap-indexed run queue (Linux).
+
+First the run queue is checked: random enqueues, requeues, removes and pops of
+a small pool of tasks, checking after each one that the bitmap has exactly the
+bits of the non-empty levels, that each task is in the level it was put in
+and that a pop takes the first task of the highest non-empty level.
+
+Then a dispatcher loop is timed: 'tasks' tasks are queued at random levels and
+each dispatch takes the highest priority task and requeues it at a random
+level, like a task that runs and becomes ready again. The same loop runs on:
+
+bitmap : generic_run_queue.h, the highest level is a find-last-set.
+scan   : An array of RUN_QUEUE_LEVELS lists scanned from the top for the first
+         non-empty level, the same enqueue and unlink.
+
+With few tasks most levels are empty and the scan is long, with many tasks
+the top levels are rarely empty and the scan is short.
+
+cc -O2 -I.. run_queue.c -o run_queue
+cc -O2 -I.. -DRUN_QUEUE_LEVELS=256 run_queue.c -o run_queue_256
+./run_queue [dispatches]
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "generic_run_queue.h"
+
+struct task_list;
+struct task {
+    DECLARE_NODE_MEMBERS(task, task_list);
+    int level;
+};
+struct task_list {
+    DECLARE_LIST_MEMBERS(task);
+};
+struct run_queue {
+    DECLARE_RUN_QUEUE_MEMBERS(task_list);
+};
+
+static unsigned long long rng = 88172645463325252ULL;
+
+static unsigned long long Rand(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+static void Fail(const char *what) {
+    fprintf(stderr, "FAILED: %s\n", what);
+    exit(1);
+}
+
+/* Check the bitmap against the levels and each queued task's level. */
+static void CheckQueue(struct run_queue *rq, struct task *pool, size_t count) {
+    int level;
+    size_t i;
+
+    for(level = 0; level < RUN_QUEUE_LEVELS; ++level) {
+        int bit = (int)((rq->bitmap[level / 64] >> (level % 64)) & 1);
+        if(bit != (rq->levels[level].count != 0)) {
+            Fail("A level's bit doesn't match the level.");
+        }
+    }
+    for(i = 0; i < count; ++i) {
+        if(pool[i].parent && (RUN_QUEUE_LEVEL(rq, &pool[i]) != pool[i].level
+                || pool[i].parent != &rq->levels[pool[i].level]))
+        {
+            Fail("A task is not in the level it was queued at.");
+        }
+    }
+}
+
+static void CheckRandomOps(void) {
+    enum { POOL = 300, OPS = 200000 };
+    static struct task pool[POOL];
+    struct run_queue rq;
+    unsigned long op;
+
+    ZERO_OUT_RUN_QUEUE_MEMBERS(&rq);
+    for(op = 0; op < OPS; ++op) {
+        struct task *task = &pool[(size_t)(Rand() % POOL)], *popped, *expected;
+        int level, top = -1;
+
+        switch(Rand() % 4) {
+        case 0:
+        case 1:
+            level = (int)(Rand() % RUN_QUEUE_LEVELS);
+            RUN_QUEUE_ENQUEUE(&rq, task, level);
+            task->level = level;
+            if(task != rq.levels[level].tail) {
+                Fail("An enqueued task is not the last of its level.");
+            }
+            break;
+        case 2:
+            RUN_QUEUE_REMOVE(&rq, task);
+            if(task->parent) {
+                Fail("A removed task is still queued.");
+            }
+            break;
+        default:
+            for(level = RUN_QUEUE_LEVELS - 1; level >= 0; --level) {
+                if(rq.levels[level].head) {
+                    top = level;
+                    break;
+                }
+            }
+            expected = (top >= 0) ? rq.levels[top].head : NULL;
+            RUN_QUEUE_PEEK(&rq, popped);
+            if(popped != expected) {
+                Fail("A peek is not the first task of the highest level.");
+            }
+            RUN_QUEUE_POP(&rq, popped);
+            if(popped != expected || (popped && popped->parent)) {
+                Fail("A pop is not the first task of the highest level.");
+            }
+            break;
+        }
+        CheckQueue(&rq, pool, POOL);
+    }
+    printf("queue check: %lu random operations OK with %d levels\n",
+        (unsigned long)OPS, RUN_QUEUE_LEVELS);
+}
+
+static double Seconds(const struct timespec *start,
+    const struct timespec *end)
+{
+    return (double)(end->tv_sec - start->tv_sec)
+        + (double)(end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* Time 'dispatches' pops and random requeues of 'count' tasks, in ns each.
+The checksum of the dispatched levels keeps the loops from being optimized
+away and shows that both pick the same tasks. */
+static double Bitmap(struct task *tasks, size_t count, size_t dispatches,
+    unsigned long long *checksum)
+{
+    static struct run_queue rq;
+    struct timespec start, end;
+    struct task *task;
+    size_t i;
+    int level;
+
+    rng = 1;
+    ZERO_OUT_RUN_QUEUE_MEMBERS(&rq);
+    for(i = 0; i < count; ++i) {
+        ZERO_OUT_NODE_MEMBERS(&tasks[i]);
+        level = (int)(Rand() % RUN_QUEUE_LEVELS);
+        RUN_QUEUE_ENQUEUE(&rq, &tasks[i], level);
+    }
+    *checksum = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i = 0; i < dispatches; ++i) {
+        RUN_QUEUE_POP(&rq, task);
+        *checksum += (unsigned long long)(task - tasks);
+        level = (int)(Rand() % RUN_QUEUE_LEVELS);
+        RUN_QUEUE_ENQUEUE(&rq, task, level);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return Seconds(&start, &end) * 1e9 / (double)dispatches;
+}
+
+static double Scan(struct task *tasks, size_t count, size_t dispatches,
+    unsigned long long *checksum)
+{
+    static struct task_list levels[RUN_QUEUE_LEVELS];
+    struct timespec start, end;
+    struct task *task;
+    size_t i;
+    int level;
+
+    rng = 1;
+    for(level = 0; level < RUN_QUEUE_LEVELS; ++level) {
+        ZERO_OUT_LIST_MEMBERS(&levels[level]);
+    }
+    for(i = 0; i < count; ++i) {
+        ZERO_OUT_NODE_MEMBERS(&tasks[i]);
+        level = (int)(Rand() % RUN_QUEUE_LEVELS);
+        LINK_NODE_LAST(&tasks[i], &levels[level]);
+    }
+    *checksum = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i = 0; i < dispatches; ++i) {
+        for(level = RUN_QUEUE_LEVELS - 1; !levels[level].head; --level) {
+        }
+        task = levels[level].head;
+        UNLINK_NODE(task);
+        *checksum += (unsigned long long)(task - tasks);
+        level = (int)(Rand() % RUN_QUEUE_LEVELS);
+        LINK_NODE_LAST(task, &levels[level]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return Seconds(&start, &end) * 1e9 / (double)dispatches;
+}
+
+int main(int argc, char *argv[]) {
+    static const size_t counts[] = { 1, 4, 16, 64, 256, 4096, 65536 };
+    size_t dispatches = 20000000, i;
+    struct task *tasks;
+
+    if(argc > 1) {
+        dispatches = (size_t)strtoul(argv[1], NULL, 10);
+    }
+    if(!dispatches) {
+        fprintf(stderr, "Usage: run_queue [dispatches]\n");
+        return 1;
+    }
+
+    CheckRandomOps();
+
+    tasks = calloc(counts[sizeof(counts) / sizeof(counts[0]) - 1],
+        sizeof(*tasks));
+    if(!tasks) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    printf("levels, tasks, bitmap ns/dispatch, scan ns/dispatch\n");
+    for(i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i) {
+        unsigned long long bitmap_sum, scan_sum;
+        double bitmap = Bitmap(tasks, counts[i], dispatches, &bitmap_sum);
+        double scan = Scan(tasks, counts[i], dispatches, &scan_sum);
+        if(bitmap_sum != scan_sum) {
+            Fail("The run queue and the scan dispatched different tasks.");
+        }
+        printf("%d, %lu, %.2f, %.2f\n", RUN_QUEUE_LEVELS,
+            (unsigned long)counts[i], bitmap, scan);
+    }
+    free(tasks);
+    return 0;
+}
@@ -0,0 +1,211 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Event collection benchmark of generic_sharded_list.h (Linux).
+
+Each producer thread links 'events' nodes stamped with its id and a sequence
+number while the main thread collects whatever has been produced every
+millisecond. The same is then done with LINK_NODE_LAST to a single list under a
+pthread mutex. The collector checks that every event arrives exactly once and
+that each producer's events arrive in order, and the run fails if they do not.
+
+cc -O2 -pthread -I.. sharded_list.c -o sharded_list
+./sharded_list [producers] [events per producer]
+*/
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "generic_sharded_list.h"
+
+#define SHARDS   64
+
+struct event_list;
+struct event_node {
+    DECLARE_NODE_MEMBERS(event_node, event_list);
+    unsigned producer;
+    unsigned long seq;
+};
+struct event_list {
+    DECLARE_LIST_MEMBERS(event_node);
+};
+struct event_sharded_list {
+    DECLARE_SHARDED_LIST_MEMBERS(event_list, SHARDS);
+};
+
+static struct event_sharded_list sharded;
+static struct event_list locked_list;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int use_mutex;
+static unsigned producers = 4;
+static unsigned long events = 1000000;
+static struct event_node *nodes;
+static unsigned long *next_seq;
+static pthread_barrier_t barrier;
+
+static void *Producer(void *arg) {
+    unsigned id = (unsigned)(size_t)arg;
+    struct event_node *node = &nodes[(size_t)id * events];
+    unsigned long i;
+    pthread_barrier_wait(&barrier);
+    for(i = 0; i < events; ++i, ++node) {
+        node->producer = id;
+        node->seq = i;
+        if(use_mutex) {
+            pthread_mutex_lock(&mutex);
+            LINK_NODE_LAST(node, &locked_list);
+            pthread_mutex_unlock(&mutex);
+        }
+        else {
+            SHARDED_LIST_LINK_LAST(&sharded, node, id);
+        }
+    }
+    return NULL;
+}
+
+/* Collect what has been produced and check it. Returns the number of
+events. */
+static unsigned long Collect(void) {
+    struct event_list list;
+    struct event_node *node = NULL;
+    unsigned long collected = 0;
+
+    ZERO_OUT_LIST_MEMBERS(&list);
+    if(use_mutex) {
+        pthread_mutex_lock(&mutex);
+        SPLICE_LIST_LAST(&list, &locked_list);
+        pthread_mutex_unlock(&mutex);
+    }
+    else {
+        SHARDED_LIST_COLLECT(&sharded, &list);
+    }
+    for(node = list.head; node; node = node->next) {
+        if(node->seq != next_seq[node->producer]++) {
+            fprintf(stderr,
+                "FAILED: Producer %u event %lu arrived out of order.\n",
+                node->producer, node->seq);
+            exit(1);
+        }
+        ++collected;
+    }
+    if(collected != list.count) {
+        fprintf(stderr, "FAILED: Collected %lu events but the count is %lu.\n",
+            collected, (unsigned long)list.count);
+        exit(1);
+    }
+    return collected;
+}
+
+static double Run(int run_use_mutex) {
+    unsigned t;
+    unsigned long collected = 0, total = (unsigned long)producers * events;
+    pthread_t *ids = calloc(producers, sizeof(*ids));
+    struct timespec start, end, pause = { 0, 1000000 };
+
+    if(!ids) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    use_mutex = run_use_mutex;
+    ZERO_OUT_SHARDED_LIST_MEMBERS(&sharded);
+    ZERO_OUT_LIST_MEMBERS(&locked_list);
+    for(t = 0; t < producers; ++t) {
+        next_seq[t] = 0;
+    }
+    for(collected = 0; collected < total; ++collected) {
+        ZERO_OUT_NODE_MEMBERS(&nodes[collected]);
+    }
+
+    pthread_barrier_init(&barrier, NULL, producers + 1);
+    for(t = 0; t < producers; ++t) {
+        if(pthread_create(&ids[t], NULL, Producer, (void *)(size_t)t)) {
+            fprintf(stderr, "Failed to create thread.\n");
+            exit(1);
+        }
+    }
+    pthread_barrier_wait(&barrier);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(collected = 0; collected < total; ) {
+        collected += Collect();
+        nanosleep(&pause, NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    for(t = 0; t < producers; ++t) {
+        pthread_join(ids[t], NULL);
+    }
+    pthread_barrier_destroy(&barrier);
+    free(ids);
+
+    if(!use_mutex && SHARDED_LIST_APPROX_COUNT(&sharded)) {
+        fprintf(stderr, "FAILED: The approximate count is %lu after the last "
+            "collect.\n", (unsigned long)SHARDED_LIST_APPROX_COUNT(&sharded));
+        exit(1);
+    }
+    return (double)(end.tv_sec - start.tv_sec)
+        + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    double total;
+
+    if(online > 1) {
+        producers = (unsigned)online - 1;
+    }
+    if(argc > 1) {
+        producers = (unsigned)strtoul(argv[1], NULL, 10);
+    }
+    if(argc > 2) {
+        events = strtoul(argv[2], NULL, 10);
+    }
+    if(!producers || !events) {
+        fprintf(stderr,
+            "Usage: sharded_list [producers] [events per producer]\n");
+        return 1;
+    }
+    nodes = calloc((size_t)producers * events, sizeof(*nodes));
+    next_seq = calloc(producers, sizeof(*next_seq));
+    if(!nodes || !next_seq) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+
+    total = (double)producers * (double)events;
+    printf("producers: %u, shards: %u, events per producer: %lu\n",
+        producers, (unsigned)SHARDED_LIST_SHARD_COUNT(&sharded), events);
+    printf("sharded: %.0f events/s\n", total / Run(0));
+    printf("mutex:   %.0f events/s\n", total / Run(1));
+    free(next_seq);
+    free(nodes);
+    return 0;
+}
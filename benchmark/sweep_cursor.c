@@ -0,0 +1,178 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Pause time benchmark of generic_sweep_cursor.h (Linux).
+
+A list of 'count' entries, one in ten of them expired, is garbage collected
+two ways:
+
+full   : One walk of the whole list that unlinks the expired entries.
+sliced : SWEEP_CURSOR_STEP of 'step' entries at a time. Between two slices
+         'churn' random entries are unlinked with SWEEP_UNLINK_NODE and linked
+         again at the tail, and the entry at the cursor's position is always
+         one of them, so every slice resumes from a cursor that was moved.
+
+The longest pause is reported for each. The run fails if an expired entry is
+left in the list after a complete pass. 'churn' can't be more than 'step',
+otherwise entries could be moved ahead of the cursor faster than it visits them
+and the pass would never end.
+
+cc -O2 -I.. sweep_cursor.c -o sweep_cursor
+./sweep_cursor [count] [step] [churn]
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "generic_sweep_cursor.h"
+
+struct entry_list;
+struct entry_cursor;
+struct entry {
+    DECLARE_NODE_MEMBERS(entry, entry_list);
+    int expired;
+};
+struct entry_list {
+    DECLARE_SWEEP_LIST_MEMBERS(entry, entry_cursor);
+};
+struct entry_cursor {
+    DECLARE_SWEEP_CURSOR_MEMBERS(entry, entry_list, entry_cursor);
+};
+
+static size_t count = 1000000, step = 256, churn = 4;
+static struct entry *entries;
+static struct entry_list list;
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static size_t Setup(void) {
+    size_t i, expired = 0;
+    ZERO_OUT_SWEEP_LIST_MEMBERS(&list);
+    for(i = 0; i < count; ++i) {
+        ZERO_OUT_NODE_MEMBERS(&entries[i]);
+        entries[i].expired = !(rand() % 10);
+        expired += (size_t)entries[i].expired;
+        LINK_NODE_LAST(&entries[i], &list);
+    }
+    return expired;
+}
+
+static void Check(size_t expired) {
+    struct entry *entry;
+    for(entry = list.head; entry; entry = entry->next) {
+        if(entry->expired) {
+            fprintf(stderr, "FAILED: An expired entry was not collected.\n");
+            exit(1);
+        }
+    }
+    if(list.count != count - expired) {
+        fprintf(stderr, "FAILED: The list has the wrong number of entries.\n");
+        exit(1);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    struct entry_cursor cursor;
+    struct entry *entry, *next;
+    size_t expired, slices = 0, i;
+    double start, pause, full, longest = 0, total = 0;
+
+    if(argc > 1) {
+        count = (size_t)strtoul(argv[1], NULL, 10);
+    }
+    if(argc > 2) {
+        step = (size_t)strtoul(argv[2], NULL, 10);
+    }
+    if(argc > 3) {
+        churn = (size_t)strtoul(argv[3], NULL, 10);
+    }
+    if(!count || !step || churn > step) {
+        fprintf(stderr, "Usage: sweep_cursor [count] [step] [churn]\n"
+            "churn must not be more than step.\n");
+        return 1;
+    }
+    entries = calloc(count, sizeof(*entries));
+    if(!entries) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+
+    srand(1);
+    expired = Setup();
+    start = Now();
+    for(entry = list.head; entry; entry = next) {
+        next = entry->next;
+        if(entry->expired) {
+            UNLINK_NODE(entry);
+        }
+    }
+    full = Now() - start;
+    Check(expired);
+
+    srand(1);
+    expired = Setup();
+    ZERO_OUT_SWEEP_CURSOR_MEMBERS(&cursor);
+    SWEEP_CURSOR_REGISTER(&cursor, &list);
+    while(!SWEEP_CURSOR_DONE(&cursor)) {
+        start = Now();
+        SWEEP_CURSOR_STEP(&cursor, entry, step) {
+            if(entry->expired) {
+                SWEEP_UNLINK_NODE(entry);
+            }
+        }
+        pause = Now() - start;
+        total += pause;
+        longest = (pause > longest) ? pause : longest;
+        ++slices;
+
+        /* the program's other work, which unlinks entries between slices */
+        for(i = 0; i < churn; ++i) {
+            entry = i ? &entries[(size_t)rand() % count] : cursor.position;
+            if(entry && entry->parent) {
+                SWEEP_UNLINK_NODE(entry);
+                LINK_NODE_LAST(entry, &list);
+            }
+        }
+    }
+    SWEEP_CURSOR_UNREGISTER(&cursor);
+    Check(expired);
+
+    printf("count: %lu, step: %lu, churn: %lu\n", (unsigned long)count,
+        (unsigned long)step, (unsigned long)churn);
+    printf("full:   1 pause of %.1f us\n", full * 1e6);
+    printf("sliced: %lu pauses, longest %.1f us, total %.1f us\n",
+        (unsigned long)slices, longest * 1e6, total * 1e6);
+    free(entries);
+    return 0;
+}
@@ -0,0 +1,200 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Check of generic_timer_wheel.h (Linux).
+
+A small wheel of 3 levels of 8 slots, so that a run of a few hundred thousand
+ticks goes through many cascades and parks timers beyond the wheel's range of
+512 ticks, gets random TIMER_WHEEL_ARM (of new, pending and expired timers),
+TIMER_WHEEL_CANCEL and TIMER_WHEEL_ADVANCE calls. Most advances are one tick,
+the rest jump ahead up to 100 ticks.
+
+After each advance every timer is checked against a model of when it's due:
+a timer is due on its expiry tick, or on the next tick processed if it was
+armed with a tick that had already passed. The timers due on a tick processed
+by the advance must be in the expired list in tick order, and no other timer
+may be. The expired timers are then fired
+by unlinking them from the expired list.
+
+The time per operation is printed, though with such a small wheel it is
+mostly cascades.
+
+cc -O2 -I.. timer_wheel.c -o timer_wheel
+./timer_wheel [ticks] [timers]
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TIMER_WHEEL_BITS   3
+#define TIMER_WHEEL_LEVELS   3
+#include "generic_timer_wheel.h"
+
+struct timer_list;
+struct timer {
+    DECLARE_TIMER_NODE_MEMBERS(timer, timer_list);
+    /* the model: whether the timer is pending and the tick it is due */
+    int pending;
+    unsigned long long due;
+};
+struct timer_list {
+    DECLARE_LIST_MEMBERS(timer);
+};
+struct timer_wheel {
+    DECLARE_TIMER_WHEEL_MEMBERS(timer, timer_list);
+};
+
+static unsigned long long rng = 88172645463325252ULL;
+
+static unsigned long long Rand(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+static void Fail(const char *what, unsigned long long tick) {
+    fprintf(stderr, "FAILED: %s (tick %llu)\n", what, tick);
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    size_t ticks = 300000, count = 200, i;
+    static struct timer_wheel wheel;
+    struct timer_list expired;
+    struct timer *timers, *timer;
+    unsigned long long armed = 0, fired = 0, cancelled = 0, operations = 0;
+    struct timespec start, end;
+    double seconds;
+
+    if(argc > 1) {
+        ticks = (size_t)strtoul(argv[1], NULL, 10);
+    }
+    if(argc > 2) {
+        count = (size_t)strtoul(argv[2], NULL, 10);
+    }
+    if(!ticks || !count) {
+        fprintf(stderr, "Usage: timer_wheel [ticks] [timers]\n");
+        return 1;
+    }
+    timers = calloc(count, sizeof(*timers));
+    if(!timers) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    ZERO_OUT_TIMER_WHEEL_MEMBERS(&wheel);
+    ZERO_OUT_LIST_MEMBERS(&expired);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while(wheel.now < ticks) {
+        unsigned long long from = wheel.now, until, when, last_due = 0;
+        unsigned ops = (unsigned)(Rand() % 4);
+
+        /* arm, rearm or cancel random timers */
+        while(ops--) {
+            timer = &timers[(size_t)(Rand() % count)];
+            if(Rand() % 4) {
+                switch(Rand() % 4) {
+                case 0: /* already passed */
+                    when = wheel.now - (Rand() % 4 < wheel.now ?
+                        Rand() % 4 : 0);
+                    break;
+                case 1: /* beyond the range of the wheel, parked */
+                    when = wheel.now + TIMER_WHEEL_RANGE + Rand() % 2000;
+                    break;
+                default:
+                    when = wheel.now + Rand() % TIMER_WHEEL_RANGE;
+                    break;
+                }
+                TIMER_WHEEL_ARM(&wheel, timer, when);
+                timer->pending = 1;
+                timer->due = (when < wheel.now) ? wheel.now : when;
+                ++armed;
+            }
+            else {
+                TIMER_WHEEL_CANCEL(timer);
+                cancelled += timer->pending;
+                timer->pending = 0;
+            }
+            ++operations;
+        }
+
+        until = wheel.now + ((Rand() % 8) ? 0 : Rand() % 100);
+        TIMER_WHEEL_ADVANCE(&wheel, until, &expired);
+        ++operations;
+        if(wheel.now != until + 1) {
+            Fail("The wheel didn't advance to the tick after 'until'.", from);
+        }
+
+        /* the expired list has exactly the timers due from 'from' to 'until',
+        in the order they're due */
+        for(timer = expired.head; timer; timer = timer->next) {
+            if(!timer->pending || timer->due < from || timer->due > until) {
+                Fail("A timer expired on the wrong tick.", until);
+            }
+            if(timer->due < last_due) {
+                Fail("The expired timers are out of order.", until);
+            }
+            last_due = timer->due;
+        }
+        for(i = 0; i < count; ++i) {
+            timer = &timers[i];
+            if(timer->pending && timer->due <= until) {
+                if(timer->parent != &expired) {
+                    Fail("A due timer didn't expire.", until);
+                }
+            }
+            else if(timer->parent == &expired) {
+                Fail("A timer that isn't due expired.", until);
+            }
+            else if(timer->pending != (timer->parent != NULL)) {
+                Fail("A timer is pending in the model and not in the wheel "
+                    "or the other way around.", until);
+            }
+        }
+
+        /* fire the expired timers */
+        while(expired.head) {
+            timer = expired.head;
+            UNLINK_NODE(timer);
+            timer->pending = 0;
+            ++fired;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (double)(end.tv_sec - start.tv_sec)
+        + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("%llu ticks OK: %llu timers armed, %llu fired, %llu cancelled, "
+        "%.1f ns per operation with the checks\n", wheel.now, armed, fired,
+        cancelled, seconds * 1e9 / (double)operations);
+    free(timers);
+    return 0;
+}
@@ -0,0 +1,257 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Scaling benchmark of generic_two_lock_queue.h (Linux).
+
+For each thread count from 1 to 'max threads' every thread runs 'operations'
+rounds of push one node, pop one node. The same is then done with the plain
+macros, LINK_NODE_LAST and UNLINK_NODE of the head, under one pthread mutex.
+Each node counts the times it was pushed and popped. At the end of each run
+the queue is walked from its head to its tail and the run fails unless every
+node is either in the queue exactly once or held by exactly one thread, and
+has been pushed once more than popped if it is in the queue and as often if it
+is held.
+
+cc -O2 -pthread -I.. two_lock_queue.c -o two_lock_queue
+./two_lock_queue [max threads] [operations per thread]
+
+The default for max threads is the number of online processors.
+*/
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "generic_two_lock_queue.h"
+
+#define NODES_PER_THREAD   64
+
+struct job_list;
+struct job_node {
+    DECLARE_NODE_MEMBERS(job_node, job_list);
+    /* changed only by the thread that holds the node */
+    unsigned long pushes, pops;
+};
+struct job_list {
+    DECLARE_LIST_MEMBERS(job_node);
+};
+struct job_queue {
+    DECLARE_TWO_LOCK_QUEUE_MEMBERS(job_node);
+};
+
+static struct job_queue queue;
+static struct job_list locked_list;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int use_mutex;
+static unsigned long operations = 1000000;
+static struct job_node *nodes;
+/* the node each thread holds, set before the thread starts and when it ends */
+static struct job_node **held;
+static pthread_barrier_t barrier;
+
+static void Fail(const char *what) {
+    fprintf(stderr, "FAILED: %s\n", what);
+    exit(1);
+}
+
+static void *Worker(void *arg) {
+    struct job_node **hold = (struct job_node **)arg;
+    struct job_node *node = *hold;
+    unsigned long i;
+    pthread_barrier_wait(&barrier);
+    for(i = 0; i < operations; ++i) {
+        ++node->pushes;
+        if(use_mutex) {
+            pthread_mutex_lock(&mutex);
+            LINK_NODE_LAST(node, &locked_list);
+            pthread_mutex_unlock(&mutex);
+            pthread_mutex_lock(&mutex);
+            node = locked_list.head;
+            UNLINK_NODE(node);
+            pthread_mutex_unlock(&mutex);
+        }
+        else {
+            TWO_LOCK_QUEUE_PUSH(&queue, node);
+            TWO_LOCK_QUEUE_POP(&queue, node);
+        }
+        if(!node) {
+            Fail("A pop after a push found the queue empty.");
+        }
+        ++node->pops;
+    }
+    *hold = node;
+    return NULL;
+}
+
+/* Walk the queue and check that every node is in it or held by a thread
+exactly once, see the comment at the top. */
+static void CheckNodes(unsigned threads) {
+    size_t total = threads * NODES_PER_THREAD, count = 0, i;
+    unsigned char *where = calloc(total, 1);
+    struct job_node *node, *last = NULL;
+    unsigned t;
+
+    if(!where) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    node = use_mutex ? locked_list.head : queue.head;
+    for(; node; node = node->next) {
+        if(node == &queue.stub) {
+            continue;
+        }
+        if(node < nodes || node >= nodes + total) {
+            Fail("The queue has a node that isn't one of the run's.");
+        }
+        i = (size_t)(node - nodes);
+        if(where[i]) {
+            Fail("A node is in the queue twice.");
+        }
+        where[i] = 1;
+        last = node;
+        ++count;
+    }
+    if(use_mutex ? (last != locked_list.tail || count != locked_list.count)
+        : ((last ? last : &queue.stub) != queue.tail
+            || count != TWO_LOCK_QUEUE_APPROX_COUNT(&queue)))
+    {
+        Fail("The walk of the queue doesn't end at its tail and count.");
+    }
+    if(count != threads * (NODES_PER_THREAD - 1)) {
+        fprintf(stderr, "FAILED: %lu nodes in the queue, expected %lu.\n",
+            (unsigned long)count,
+            (unsigned long)(threads * (NODES_PER_THREAD - 1)));
+        exit(1);
+    }
+    for(t = 0; t < threads; ++t) {
+        if(held[t] < nodes || held[t] >= nodes + total
+            || where[held[t] - nodes])
+        {
+            Fail("A thread holds a node that is in the queue or held twice.");
+        }
+        where[held[t] - nodes] = 2;
+    }
+    for(i = 0; i < total; ++i) {
+        if(!where[i]) {
+            Fail("A node was lost.");
+        }
+        if(nodes[i].pushes - nodes[i].pops != (where[i] == 1)) {
+            Fail("A node was popped a different number of times than pushed.");
+        }
+    }
+    free(where);
+}
+
+static double Run(unsigned threads, int run_use_mutex) {
+    unsigned t;
+    pthread_t *ids = calloc(threads, sizeof(*ids));
+    struct timespec start, end;
+
+    if(!ids) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    use_mutex = run_use_mutex;
+    INIT_TWO_LOCK_QUEUE_MEMBERS(&queue);
+    ZERO_OUT_LIST_MEMBERS(&locked_list);
+
+    /* Preload the queue so the threads don't all meet at the stub. */
+    for(t = 0; t < threads * NODES_PER_THREAD; ++t) {
+        struct job_node *node = &nodes[t];
+        ZERO_OUT_NODE_MEMBERS(node);
+        node->pushes = node->pops = 0;
+        if(t % NODES_PER_THREAD) {
+            ++node->pushes;
+            if(use_mutex) {
+                LINK_NODE_LAST(node, &locked_list);
+            }
+            else {
+                TWO_LOCK_QUEUE_PUSH(&queue, node);
+            }
+        }
+    }
+
+    pthread_barrier_init(&barrier, NULL, threads + 1);
+    for(t = 0; t < threads; ++t) {
+        held[t] = &nodes[t * NODES_PER_THREAD];
+        if(pthread_create(&ids[t], NULL, Worker, &held[t])) {
+            fprintf(stderr, "Failed to create thread.\n");
+            exit(1);
+        }
+    }
+    pthread_barrier_wait(&barrier);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(t = 0; t < threads; ++t) {
+        pthread_join(ids[t], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    pthread_barrier_destroy(&barrier);
+    free(ids);
+
+    CheckNodes(threads);
+    return (double)(end.tv_sec - start.tv_sec)
+        + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned max_threads = (online > 0) ? (unsigned)online : 1;
+    unsigned t;
+
+    if(argc > 1) {
+        max_threads = (unsigned)strtoul(argv[1], NULL, 10);
+    }
+    if(argc > 2) {
+        operations = strtoul(argv[2], NULL, 10);
+    }
+    if(!max_threads || !operations) {
+        fprintf(stderr, "Usage: two_lock_queue [max threads] [operations]\n");
+        return 1;
+    }
+    nodes = calloc(max_threads * NODES_PER_THREAD, sizeof(*nodes));
+    held = calloc(max_threads, sizeof(*held));
+    if(!nodes || !held) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+
+    printf("threads, two-lock ops/s, mutex ops/s\n");
+    for(t = 1; t <= max_threads; ++t) {
+        double ops = 2.0 * (double)operations * (double)t;
+        double two_lock = Run(t, 0);
+        double mutex_list = Run(t, 1);
+        printf("%u, %.0f, %.0f\n", t, ops / two_lock, ops / mutex_list);
+    }
+    free(nodes);
+    free(held);
+    return 0;
+}
@@ -0,0 +1,249 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Jobs per second benchmark of generic_work_queue.h (Linux).
+
+'producers' threads each push 'jobs' job nodes and 'consumers' threads run
+them until the queue is closed. Three consumers are timed:
+
+one-at-a-time : A pthread mutex and two condition variables around
+                LINK_NODE_LAST and UNLINK_NODE with the same capacity,
+                signaling on every push and pop.
+pop           : WORK_QUEUE_POP.
+pop_batch     : WORK_QUEUE_POP_BATCH of up to 'batch' jobs.
+
+Every job adds its id to a checksum, and the run fails if any job is lost or
+run twice.
+
+cc -O2 -pthread -I.. work_queue.c -o work_queue
+./work_queue [producers] [consumers] [jobs per producer] [capacity] [batch]
+*/
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "generic_work_queue.h"
+
+enum mode { MODE_ONE_AT_A_TIME, MODE_POP, MODE_POP_BATCH };
+
+struct job_list;
+struct job_node {
+    DECLARE_NODE_MEMBERS(job_node, job_list);
+    unsigned long id;
+};
+struct job_list {
+    DECLARE_LIST_MEMBERS(job_node);
+};
+struct job_queue {
+    DECLARE_WORK_QUEUE_MEMBERS(job_list);
+};
+
+static struct job_queue queue;
+
+/* the one-at-a-time pattern */
+static struct job_list locked_list;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t not_empty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t not_full = PTHREAD_COND_INITIALIZER;
+static int locked_closed;
+
+static enum mode mode;
+static unsigned producers = 2, consumers = 2;
+static unsigned long jobs = 1000000;
+static size_t capacity = 1024, batch = 32;
+static struct job_node *nodes;
+static unsigned long long checksum;
+static unsigned long run_count;
+static pthread_mutex_t total_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void *Producer(void *arg) {
+    struct job_node *node = &nodes[(size_t)arg * jobs];
+    unsigned long i;
+    for(i = 0; i < jobs; ++i, ++node) {
+        if(mode == MODE_ONE_AT_A_TIME) {
+            pthread_mutex_lock(&mutex);
+            while(locked_list.count >= capacity) {
+                pthread_cond_wait(&not_full, &mutex);
+            }
+            LINK_NODE_LAST(node, &locked_list);
+            pthread_cond_signal(&not_empty);
+            pthread_mutex_unlock(&mutex);
+        }
+        else {
+            int pushed;
+            WORK_QUEUE_PUSH(&queue, node, pushed);
+            if(!pushed) {
+                fprintf(stderr, "FAILED: A push to an open queue failed.\n");
+                exit(1);
+            }
+        }
+    }
+    return NULL;
+}
+
+static void *Consumer(void *arg) {
+    struct job_node *node = NULL;
+    struct job_list list;
+    unsigned long long sum = 0;
+    unsigned long count = 0;
+    (void)arg;
+    ZERO_OUT_LIST_MEMBERS(&list);
+    for(;;) {
+        if(mode == MODE_ONE_AT_A_TIME) {
+            pthread_mutex_lock(&mutex);
+            while(!locked_list.head && !locked_closed) {
+                pthread_cond_wait(&not_empty, &mutex);
+            }
+            node = locked_list.head;
+            UNLINK_NODE(node);
+            pthread_cond_signal(&not_full);
+            pthread_mutex_unlock(&mutex);
+        }
+        else if(mode == MODE_POP) {
+            WORK_QUEUE_POP(&queue, node);
+        }
+        else {
+            if(!list.head) {
+                WORK_QUEUE_POP_BATCH(&queue, &list, batch);
+            }
+            node = list.head;
+            UNLINK_NODE(node);
+        }
+        if(!node) {
+            break;
+        }
+        sum += node->id;
+        ++count;
+    }
+    pthread_mutex_lock(&total_mutex);
+    checksum += sum;
+    run_count += count;
+    pthread_mutex_unlock(&total_mutex);
+    return NULL;
+}
+
+static double Run(enum mode run_mode) {
+    unsigned t;
+    unsigned long long i, total = (unsigned long long)producers * jobs;
+    pthread_t *ids = calloc(producers + consumers, sizeof(*ids));
+    struct timespec start, end;
+
+    if(!ids) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    mode = run_mode;
+    checksum = 0;
+    run_count = 0;
+    INIT_WORK_QUEUE(&queue, capacity);
+    ZERO_OUT_LIST_MEMBERS(&locked_list);
+    locked_closed = 0;
+    for(i = 0; i < total; ++i) {
+        ZERO_OUT_NODE_MEMBERS(&nodes[i]);
+        nodes[i].id = (unsigned long)i;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(t = 0; t < producers + consumers; ++t) {
+        if(pthread_create(&ids[t], NULL, (t < producers) ? Producer : Consumer,
+            (void *)(size_t)t))
+        {
+            fprintf(stderr, "Failed to create thread.\n");
+            exit(1);
+        }
+    }
+    for(t = 0; t < producers; ++t) {
+        pthread_join(ids[t], NULL);
+    }
+    if(mode == MODE_ONE_AT_A_TIME) {
+        pthread_mutex_lock(&mutex);
+        locked_closed = 1;
+        pthread_cond_broadcast(&not_empty);
+        pthread_mutex_unlock(&mutex);
+    }
+    else {
+        WORK_QUEUE_CLOSE(&queue);
+    }
+    for(; t < producers + consumers; ++t) {
+        pthread_join(ids[t], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    DESTROY_WORK_QUEUE(&queue);
+    free(ids);
+
+    if(run_count != total || checksum != total * (total - 1) / 2) {
+        fprintf(stderr, "FAILED: %lu of %llu jobs run, checksum %llu.\n",
+            run_count, total, checksum);
+        exit(1);
+    }
+    return (double)(end.tv_sec - start.tv_sec)
+        + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    double total;
+
+    if(argc > 1) {
+        producers = (unsigned)strtoul(argv[1], NULL, 10);
+    }
+    if(argc > 2) {
+        consumers = (unsigned)strtoul(argv[2], NULL, 10);
+    }
+    if(argc > 3) {
+        jobs = strtoul(argv[3], NULL, 10);
+    }
+    if(argc > 4) {
+        capacity = (size_t)strtoul(argv[4], NULL, 10);
+    }
+    if(argc > 5) {
+        batch = (size_t)strtoul(argv[5], NULL, 10);
+    }
+    if(!producers || !consumers || !jobs || !capacity || !batch) {
+        fprintf(stderr, "Usage: work_queue [producers] [consumers] "
+            "[jobs per producer] [capacity] [batch]\n");
+        return 1;
+    }
+    nodes = calloc((size_t)producers * jobs, sizeof(*nodes));
+    if(!nodes) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+
+    total = (double)producers * (double)jobs;
+    printf("producers: %u, consumers: %u, jobs per producer: %lu, "
+        "capacity: %lu, batch: %lu\n", producers, consumers, jobs,
+        (unsigned long)capacity, (unsigned long)batch);
+    printf("one-at-a-time: %.0f jobs/s\n", total / Run(MODE_ONE_AT_A_TIME));
+    printf("pop:           %.0f jobs/s\n", total / Run(MODE_POP));
+    printf("pop_batch:     %.0f jobs/s\n", total / Run(MODE_POP_BATCH));
+    free(nodes);
+    return 0;
+}
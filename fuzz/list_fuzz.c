@@ -0,0 +1,385 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Coverage-guided fuzzing harness for the generic_list.h macros.
+
+The input bytes are decoded into a sequence of operations on LIST_COUNT lists
+and SLOT_COUNT nodes, two bytes per operation:
+
+byte 0 : The operation (byte % OP_COUNT) and a list a ((byte / OP_COUNT) %
+         LIST_COUNT).
+byte 1 : A node slot (byte % SLOT_COUNT) and a list b ((byte / SLOT_COUNT) %
+         LIST_COUNT). The position slot is the node slot of the next pair, so
+         any node can be positioned relative to any other, itself included.
+
+UNLINK       : UNLINK_NODE of the node.
+FIRST/LAST   : LINK_NODE_FIRST/LINK_NODE_LAST of the node to list a.
+BEFORE/AFTER : LINK_NODE_BEFORE/LINK_NODE_AFTER of the node and the position
+               node, which may be the node itself, in another list or in no
+               list at all.
+SPLICE       : SPLICE_LIST_LAST of list b to list a.
+STITCH       : STITCH_LIST_LAST of list b to list a and ADOPT_LIST_NODES.
+HIDE         : HIDE_NODE of up to 4 distinct nodes, the slots are the
+               following bytes, and RESTORE_NODE of them in reverse order.
+
+After every operation its postcondition is checked, and the links of the node,
+the position node and lists a and b are checked in O(1): the neighbours point
+back and are in the same list, and the head and tail ends are consistent with
+the count. At the end of each input the same invariants as the stresstest's
+sanity_check_list are checked for every list, and every node slot is checked:
+its neighbours point back to it and are in the same list, and its list reaches
+it. A violation is printed and abort() is called, which the fuzzer reports as
+a crash.
+
+If LIST_FUZZ_FULL_CHECK is defined the whole of every list and every node slot
+is checked after every operation instead, and after each hide, so a violation
+is reported at the operation that caused it. That is several times slower, so
+use it to minimize and debug a crash rather than to fuzz.
+
+libFuzzer (clang):
+clang -g -O1 -fsanitize=fuzzer,address,undefined -I.. list_fuzz.c -o list_fuzz
+./list_fuzz [corpus directory]
+
+AFL++ can build the same file with afl-clang-fast and -fsanitize=fuzzer, or
+use the standalone driver with @@. The standalone driver runs each file given
+as an argument, or without arguments 'runs' random inputs as a smoke test:
+
+cc -O2 -DLIST_FUZZ_MAIN -I.. list_fuzz.c -o list_fuzz_main
+./list_fuzz_main [file ...]
+./list_fuzz_main -runs=N
+
+The driver prints the number of inputs and operations run per second.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "generic_list.h"
+
+enum { LIST_COUNT = 3, SLOT_COUNT = 16, HIDE_MAX = 4 };
+
+enum op {
+    OP_UNLINK, OP_FIRST, OP_LAST, OP_BEFORE, OP_AFTER, OP_SPLICE, OP_STITCH,
+    OP_HIDE, OP_COUNT
+};
+
+struct fuzz_list;
+struct fuzz_node {
+    DECLARE_NODE_MEMBERS(fuzz_node, fuzz_list);
+};
+struct fuzz_list {
+    DECLARE_LIST_MEMBERS(fuzz_node);
+};
+
+static struct fuzz_list lists[LIST_COUNT];
+static struct fuzz_node nodes[SLOT_COUNT];
+
+/* The operation being checked, printed on a failure. */
+static size_t op_index;
+static enum op op_current;
+
+#define FUZZ_CHECK(expr, what)   \
+    do { \
+        if(!(expr)) { \
+            fprintf(stderr, "FAILED: %s (%s) at operation %lu (op %d)\n", \
+                (what), #expr, (unsigned long)op_index, (int)op_current); \
+            abort(); \
+        } \
+    } while(0)
+
+/* Check a list the way sanity_check_list does, and that the walk ends. */
+static void CheckList(struct fuzz_list *list) {
+    struct fuzz_node *prev = NULL, *node;
+    size_t count = 0;
+
+    if(!list->count) {
+        FUZZ_CHECK(!list->head && !list->tail,
+            "empty list has a head or tail");
+        return;
+    }
+    FUZZ_CHECK(list->head && list->tail, "missing head or tail");
+    for(node = list->head; node; prev = node, node = node->next) {
+        ++count;
+        FUZZ_CHECK(count <= list->count && count <= SLOT_COUNT,
+            "more nodes in the list than its count");
+        FUZZ_CHECK(node->prev == prev, "prev doesn't match the walk");
+        FUZZ_CHECK(node->parent == list, "node's parent isn't the list");
+    }
+    FUZZ_CHECK(count == list->count, "count doesn't match the walk");
+    FUZZ_CHECK(prev == list->tail, "the end of the list isn't the tail");
+}
+
+#ifndef LIST_FUZZ_FULL_CHECK
+/* Check the ends of a list against its count, in O(1). */
+static void CheckEnds(struct fuzz_list *list) {
+    if(!list->count) {
+        FUZZ_CHECK(!list->head && !list->tail,
+            "empty list has a head or tail");
+        return;
+    }
+    FUZZ_CHECK(list->head && list->tail, "missing head or tail");
+    FUZZ_CHECK(!list->head->prev && !list->tail->next,
+        "the head or tail has an outer neighbour");
+    FUZZ_CHECK(list->head->parent == list && list->tail->parent == list,
+        "the head or tail isn't in the list");
+    FUZZ_CHECK((list->count == 1) == (list->head == list->tail),
+        "the head and tail don't match the count");
+}
+
+/* Check the links of a node that isn't hidden, in O(1). */
+static void CheckNode(struct fuzz_node *node) {
+    if(node->next) {
+        FUZZ_CHECK(node->next->prev == node, "next doesn't point back");
+        FUZZ_CHECK(node->next->parent == node->parent,
+            "neighbours are in different lists");
+    }
+    if(node->prev) {
+        FUZZ_CHECK(node->prev->next == node, "prev doesn't point back");
+        FUZZ_CHECK(node->prev->parent == node->parent,
+            "neighbours are in different lists");
+    }
+    if(node->parent) {
+        FUZZ_CHECK(node->prev || node->parent->head == node,
+            "a node without prev isn't the head");
+        FUZZ_CHECK(node->next || node->parent->tail == node,
+            "a node without next isn't the tail");
+    }
+}
+#endif
+
+/* Check every list and every node slot that isn't hidden ('hidden' may be
+NULL). */
+static void CheckAll(const int *hidden) {
+    size_t l, i, parented[LIST_COUNT] = { 0 };
+
+    for(l = 0; l < LIST_COUNT; ++l) {
+        CheckList(&lists[l]);
+    }
+    for(i = 0; i < SLOT_COUNT; ++i) {
+        struct fuzz_node *node = &nodes[i];
+        if(hidden && hidden[i]) {
+            continue;
+        }
+        if(node->next) {
+            FUZZ_CHECK(node->next->prev == node, "next doesn't point back");
+            FUZZ_CHECK(node->next->parent == node->parent,
+                "neighbours are in different lists");
+        }
+        if(node->prev) {
+            FUZZ_CHECK(node->prev->next == node, "prev doesn't point back");
+        }
+        if(node->parent) {
+            l = (size_t)(node->parent - lists);
+            FUZZ_CHECK(l < LIST_COUNT, "parent isn't a list");
+            ++parented[l];
+        }
+    }
+    /* The walks above saw only nodes whose parent is the list, so if the
+    counts match every node that names a list is in it, and a node in no list
+    is in no list's chain. */
+    if(!hidden) {
+        for(l = 0; l < LIST_COUNT; ++l) {
+            FUZZ_CHECK(parented[l] == lists[l].count,
+                "nodes that name the list aren't all in it");
+        }
+    }
+}
+
+static void Reset(void) {
+    size_t i;
+    for(i = 0; i < LIST_COUNT; ++i) {
+        ZERO_OUT_LIST_MEMBERS(&lists[i]);
+    }
+    for(i = 0; i < SLOT_COUNT; ++i) {
+        ZERO_OUT_NODE_MEMBERS(&nodes[i]);
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    size_t pos = 0;
+
+    Reset();
+    for(op_index = 0; pos + 1 < size; ++op_index) {
+        enum op op = (enum op)(data[pos] % OP_COUNT);
+        struct fuzz_list *a = &lists[(data[pos] / OP_COUNT) % LIST_COUNT];
+        struct fuzz_list *b =
+            &lists[(data[pos + 1] / SLOT_COUNT) % LIST_COUNT];
+        struct fuzz_node *node = &nodes[data[pos + 1] % SLOT_COUNT];
+        struct fuzz_node *position = (pos + 3 < size) ?
+            &nodes[data[pos + 3] % SLOT_COUNT] : node;
+
+        op_current = op;
+        pos += 2;
+        switch(op) {
+        case OP_UNLINK:
+            UNLINK_NODE(node);
+            FUZZ_CHECK(!node->prev && !node->next && !node->parent,
+                "node wasn't unlinked");
+            break;
+        case OP_FIRST:
+            LINK_NODE_FIRST(node, a);
+            FUZZ_CHECK(a->head == node && node->parent == a,
+                "node isn't the head");
+            break;
+        case OP_LAST:
+            LINK_NODE_LAST(node, a);
+            FUZZ_CHECK(a->tail == node && node->parent == a,
+                "node isn't the tail");
+            break;
+        case OP_BEFORE:
+            LINK_NODE_BEFORE(node, position);
+            FUZZ_CHECK(node == position || (position->prev == node
+                && node->next == position && node->parent == position->parent),
+                "node isn't before the position");
+            break;
+        case OP_AFTER:
+            LINK_NODE_AFTER(node, position);
+            FUZZ_CHECK(node == position || (position->next == node
+                && node->prev == position && node->parent == position->parent),
+                "node isn't after the position");
+            break;
+        case OP_SPLICE:
+        case OP_STITCH: {
+            size_t expected = a->count + ((a != b) ? b->count : 0);
+            if(op == OP_SPLICE) {
+                SPLICE_LIST_LAST(a, b);
+            }
+            else {
+                STITCH_LIST_LAST(a, b);
+                ADOPT_LIST_NODES(a);
+            }
+            FUZZ_CHECK(a->count == expected && (a == b || !b->count),
+                "nodes weren't moved");
+            break;
+        }
+        case OP_HIDE: {
+            struct fuzz_node *stack[HIDE_MAX];
+            int hidden[SLOT_COUNT] = { 0 };
+            size_t n = 0, want = 1 + data[pos - 1] % HIDE_MAX;
+            for(; n < want && pos < size; ++pos) {
+                size_t slot = data[pos] % SLOT_COUNT;
+                if(hidden[slot]) {
+                    continue;
+                }
+                hidden[slot] = 1;
+                stack[n++] = &nodes[slot];
+                HIDE_NODE(&nodes[slot]);
+#ifdef LIST_FUZZ_FULL_CHECK
+                CheckAll(hidden);
+#else
+                FUZZ_CHECK(!nodes[slot].prev
+                    || nodes[slot].prev->next == nodes[slot].next,
+                    "prev doesn't skip the hidden node");
+                FUZZ_CHECK(!nodes[slot].next
+                    || nodes[slot].next->prev == nodes[slot].prev,
+                    "next doesn't skip the hidden node");
+#endif
+            }
+            while(n) {
+                --n;
+                RESTORE_NODE(stack[n]);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+#ifdef LIST_FUZZ_FULL_CHECK
+        CheckAll(NULL);
+#else
+        CheckNode(node);
+        CheckNode(position);
+        CheckEnds(a);
+        CheckEnds(b);
+#endif
+    }
+    CheckAll(NULL);
+    return 0;
+}
+
+#ifdef LIST_FUZZ_MAIN
+/* Standalone driver: run files, or random inputs from xorshift. */
+int main(int argc, char *argv[]) {
+    static uint8_t buffer[65536];
+    unsigned long long state = 88172645463325252ULL;
+    unsigned long runs = 100000, r;
+    unsigned long long operations = 0;
+    int i, files = 0;
+    clock_t start;
+    double seconds;
+
+    for(i = 1; i < argc; ++i) {
+        FILE *fp;
+        size_t size;
+        if(!strncmp(argv[i], "-runs=", 6)) {
+            runs = strtoul(argv[i] + 6, NULL, 10);
+            continue;
+        }
+        fp = fopen(argv[i], "rb");
+        if(!fp) {
+            fprintf(stderr, "Failed to open %s\n", argv[i]);
+            return 1;
+        }
+        size = fread(buffer, 1, sizeof(buffer), fp);
+        fclose(fp);
+        LLVMFuzzerTestOneInput(buffer, size);
+        ++files;
+    }
+    if(files) {
+        printf("%d files passed.\n", files);
+        return 0;
+    }
+    start = clock();
+    for(r = 0; r < runs; ++r) {
+        size_t size, j;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        size = (size_t)(state % 512);
+        for(j = 0; j < size; ++j) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            buffer[j] = (uint8_t)(state >> 32);
+        }
+        LLVMFuzzerTestOneInput(buffer, size);
+        operations += op_index;
+    }
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    if(seconds <= 0) {
+        seconds = 1e-9;
+    }
+    printf("%lu random inputs passed, %.0f inputs/s, %.0f operations/s.\n",
+        runs, runs / seconds, (double)operations / seconds);
+    return 0;
+}
+#endif
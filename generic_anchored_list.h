@@ -0,0 +1,561 @@
+/* Generic helper macros for a list with an index of segment anchors.
+*/
+#ifndef GENERIC_ANCHORED_LIST_H_
+#define GENERIC_ANCHORED_LIST_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Generic helper macros for a list with an index of segment anchors.
+
+An anchored list is an ordinary generic_list list whose nodes are divided into
+runs of consecutive nodes called segments, of roughly 'k' nodes each. Every
+segment has an anchor, one of its nodes, that holds the segment's record: its
+first node, its node count and the anchors of the segments before and after
+it. Every node points to the anchor of its segment. The records form an index
+of the list with about count/k entries, so the list can be cut into pieces for
+parallel processing without walking it; see LIST_PARALLEL_FOREACH in
+generic_parallel.h.
+
+The index is kept up to date by the ANCHORED_ link and unlink macros:
+
+- A node linked at the boundary of a full segment starts a new segment, so
+  appending or prepending nodes is O(1).
+- A segment that grows to 2k nodes is split in two, walking it once.
+- A segment that shrinks below k/4 nodes is merged into the one before it.
+- Unlinking the node that holds a segment's record moves the record to another
+  node of the segment, walking it once.
+
+The walks are O(k) and amortized over the links and unlinks that cause them.
+
+DECLARE_ANCHORED_NODE_MEMBERS
+Declare the anchored node members.
+
+DECLARE_ANCHORED_LIST_MEMBERS
+Declare the anchored list members.
+
+ZERO_OUT_ANCHORED_NODE_MEMBERS
+Zero out the anchored node members.
+
+INIT_ANCHORED_LIST_MEMBERS
+Initialize the anchored list members to an empty list with segment size k.
+
+ANCHORED_LINK_NODE_FIRST
+Link a node to an anchored list and position it as the head node.
+
+ANCHORED_LINK_NODE_LAST
+Link a node to an anchored list and position it as the tail node.
+
+ANCHORED_LINK_NODE_BEFORE
+Link a node to an anchored list and position it before another node.
+
+ANCHORED_LINK_NODE_AFTER
+Link a node to an anchored list and position it after another node.
+
+ANCHORED_UNLINK_NODE
+Unlink a node from its anchored list.
+
+---
+Important:
+
+The same rules as generic_list.h apply. The input parameters for the macros are
+evaluated multiple times because they are generic function-like macros. The
+parameters must not have side effects or access the list.
+
+The list must only be changed with the ANCHORED_ macros. The other macros that
+only read, and any code that walks the list, can be used as usual. A node that
+is linked must not be part of a list.
+
+---
+Other:
+
+The list struct has scratch members that the macros use as temporaries, so two
+threads must not change the same list at the same time even if each holds a
+different node.
+*/
+
+#include "generic_list.h"
+
+
+/* DECLARE_ANCHORED_NODE_MEMBERS
+Declare the anchored node members.
+
+Use this declaration in your node struct instead of DECLARE_NODE_MEMBERS.
+
+This macro adds the members of DECLARE_NODE_MEMBERS and the following members:
+anchor : The node that holds the record of this node's segment.
+seg_first : Record. The first node of the segment.
+seg_prev : Record. The anchor of the previous segment. NULL if none.
+seg_next : Record. The anchor of the next segment. NULL if none.
+seg_count : Record. The number of nodes in the segment.
+
+The record members are only used in the node that is an anchor.
+
+[in] 'node_tag' : Tag name of your node struct.
+[in] 'list_tag' : Tag name of your list struct.
+*/
+#define DECLARE_ANCHORED_NODE_MEMBERS(node_tag, list_tag)   \
+    DECLARE_NODE_MEMBERS(node_tag, list_tag); \
+    struct node_tag *anchor; \
+    struct node_tag *seg_first, *seg_prev, *seg_next; \
+    size_t seg_count
+
+
+/* DECLARE_ANCHORED_LIST_MEMBERS
+Declare the anchored list members.
+
+Use this declaration in your list struct instead of DECLARE_LIST_MEMBERS.
+
+This macro adds the members of DECLARE_LIST_MEMBERS and the following members:
+first_anchor : The anchor of the first segment. NULL if none.
+last_anchor : The anchor of the last segment. NULL if none.
+anchor_count : The number of segments.
+anchor_k : The target segment size.
+anchor_holder : For internal use.
+anchor_split : For internal use.
+anchor_cursor : For internal use.
+
+[in] 'node_tag' : Tag name of your node struct.
+*/
+#define DECLARE_ANCHORED_LIST_MEMBERS(node_tag)   \
+    DECLARE_LIST_MEMBERS(node_tag); \
+    struct node_tag *first_anchor, *last_anchor; \
+    size_t anchor_count; \
+    size_t anchor_k; \
+    struct node_tag *anchor_holder, *anchor_split, *anchor_cursor
+
+
+/* ZERO_OUT_ANCHORED_NODE_MEMBERS
+Zero out the anchored node members.
+
+[in] 'node' : Pointer to a node.
+*/
+#define ZERO_OUT_ANCHORED_NODE_MEMBERS(node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node)) { \
+        ZERO_OUT_NODE_MEMBERS((node)); \
+        (node)->anchor = NULL; \
+        (node)->seg_first = (node)->seg_prev = (node)->seg_next = NULL; \
+        (node)->seg_count = 0; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* INIT_ANCHORED_LIST_MEMBERS
+Initialize the anchored list members to an empty list with segment size k.
+
+[in] 'list' : Pointer to a list.
+[in] 'k' : The target number of nodes per segment, at least 1.
+*/
+#define INIT_ANCHORED_LIST_MEMBERS(list, k)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((list)) { \
+        ZERO_OUT_LIST_MEMBERS((list)); \
+        (list)->first_anchor = (list)->last_anchor = NULL; \
+        (list)->anchor_count = 0; \
+        (list)->anchor_k = (k) ? (size_t)(k) : 1; \
+        (list)->anchor_holder = (list)->anchor_split = NULL; \
+        (list)->anchor_cursor = NULL; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* ANCHORED_NEW_SEGMENT_
+For internal use. Make 'node' the anchor of a new segment of just itself, and
+put its record after the record of 'after_anchor' or first if that is NULL.
+*/
+#define ANCHORED_NEW_SEGMENT_(node, list, after_anchor)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    (node)->anchor = (node); \
+    (node)->seg_first = (node); \
+    (node)->seg_count = 1; \
+    (node)->seg_prev = (after_anchor); \
+    (node)->seg_next = (node)->seg_prev ? \
+        (node)->seg_prev->seg_next : (list)->first_anchor; \
+    if((node)->seg_next) { \
+        (node)->seg_next->seg_prev = (node); \
+    } \
+    else { \
+        (list)->last_anchor = (node); \
+    } \
+    if((node)->seg_prev) { \
+        (node)->seg_prev->seg_next = (node); \
+    } \
+    else { \
+        (list)->first_anchor = (node); \
+    } \
+    ++(list)->anchor_count; \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* ANCHORED_REMOVE_RECORD_
+For internal use. Remove the record of list->anchor_holder from the index.
+*/
+#define ANCHORED_REMOVE_RECORD_(list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((list)->anchor_holder->seg_prev) { \
+        (list)->anchor_holder->seg_prev->seg_next = \
+            (list)->anchor_holder->seg_next; \
+    } \
+    else { \
+        (list)->first_anchor = (list)->anchor_holder->seg_next; \
+    } \
+    if((list)->anchor_holder->seg_next) { \
+        (list)->anchor_holder->seg_next->seg_prev = \
+            (list)->anchor_holder->seg_prev; \
+    } \
+    else { \
+        (list)->last_anchor = (list)->anchor_holder->seg_prev; \
+    } \
+    --(list)->anchor_count; \
+    (list)->anchor_holder->seg_first = NULL; \
+    (list)->anchor_holder->seg_prev = NULL; \
+    (list)->anchor_holder->seg_next = NULL; \
+    (list)->anchor_holder->seg_count = 0; \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* ANCHORED_SET_ANCHORS_
+For internal use. Set the anchor of 'count' nodes starting at 'first'.
+*/
+#define ANCHORED_SET_ANCHORS_(list, first, count, new_anchor)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    size_t generic_anchor_i_ = (count); \
+    for((list)->anchor_cursor = (first); generic_anchor_i_; \
+        --generic_anchor_i_) \
+    { \
+        (list)->anchor_cursor->anchor = (new_anchor); \
+        (list)->anchor_cursor = (list)->anchor_cursor->next; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* ANCHORED_SPLIT_
+For internal use. Split the segment of list->anchor_holder, which has at least
+2k nodes, into a segment of k nodes and a segment of the rest. Whichever half
+list->anchor_holder is not in gets a new anchor, its first node.
+*/
+#define ANCHORED_SPLIT_(list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    size_t generic_anchor_j_; \
+    int generic_anchor_seen_ = 0; \
+    (list)->anchor_cursor = (list)->anchor_holder->seg_first; \
+    for(generic_anchor_j_ = (list)->anchor_k; generic_anchor_j_; \
+        --generic_anchor_j_) \
+    { \
+        if((list)->anchor_cursor == (list)->anchor_holder) { \
+            generic_anchor_seen_ = 1; \
+        } \
+        (list)->anchor_cursor = (list)->anchor_cursor->next; \
+    } \
+    if(generic_anchor_seen_) { \
+        (list)->anchor_split = (list)->anchor_cursor; \
+        ANCHORED_NEW_SEGMENT_((list)->anchor_split, (list), \
+            (list)->anchor_holder); \
+        (list)->anchor_split->seg_count = \
+            (list)->anchor_holder->seg_count - (list)->anchor_k; \
+        (list)->anchor_holder->seg_count = (list)->anchor_k; \
+        ANCHORED_SET_ANCHORS_((list), (list)->anchor_split, \
+            (list)->anchor_split->seg_count, (list)->anchor_split); \
+    } \
+    else { \
+        (list)->anchor_split = (list)->anchor_holder->seg_first; \
+        ANCHORED_NEW_SEGMENT_((list)->anchor_split, (list), \
+            (list)->anchor_holder->seg_prev); \
+        (list)->anchor_split->seg_count = (list)->anchor_k; \
+        (list)->anchor_holder->seg_first = (list)->anchor_cursor; \
+        (list)->anchor_holder->seg_count -= (list)->anchor_k; \
+        ANCHORED_SET_ANCHORS_((list), (list)->anchor_split, \
+            (list)->anchor_k, (list)->anchor_split); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* ANCHORED_JOIN_
+For internal use. Add 'node', which has just been linked, to the segment of
+list->anchor_holder and split the segment if it is full.
+*/
+#define ANCHORED_JOIN_(node, list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    (node)->anchor = (list)->anchor_holder; \
+    if((list)->anchor_holder->seg_first == (node)->next) { \
+        (list)->anchor_holder->seg_first = (node); \
+    } \
+    if(++(list)->anchor_holder->seg_count >= 2 * (list)->anchor_k) { \
+        ANCHORED_SPLIT_((list)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* ANCHORED_INDEX_LINKED_
+For internal use. Add 'node', which has just been linked to 'list', to the
+index. A node at the boundary of two segments joins the one before it unless
+that is full, then the one after it unless that is full, otherwise it starts a
+new segment.
+*/
+#define ANCHORED_INDEX_LINKED_(node, list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node)->prev && (node)->next \
+        && ((node)->prev->anchor == (node)->next->anchor)) \
+    { \
+        (list)->anchor_holder = (node)->prev->anchor; \
+        ANCHORED_JOIN_((node), (list)); \
+    } \
+    else if((node)->prev \
+        && ((node)->prev->anchor->seg_count < (list)->anchor_k)) \
+    { \
+        (list)->anchor_holder = (node)->prev->anchor; \
+        ANCHORED_JOIN_((node), (list)); \
+    } \
+    else if((node)->next \
+        && ((node)->next->anchor->seg_count < (list)->anchor_k)) \
+    { \
+        (list)->anchor_holder = (node)->next->anchor; \
+        ANCHORED_JOIN_((node), (list)); \
+    } \
+    else { \
+        ANCHORED_NEW_SEGMENT_((node), (list), \
+            (node)->prev ? (node)->prev->anchor : NULL); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* ANCHORED_LINK_NODE_FIRST
+Link a node to an anchored list and position it as the head node.
+
+If 'node' is part of a list or 'list' has a node count equal to the maximum
+value of size_t then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'node' : Pointer to a node that is not part of a list.
+[in] 'list' : Pointer to an anchored list.
+*/
+#define ANCHORED_LINK_NODE_FIRST(node, list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node) && (list) && !(node)->parent \
+        && ((list)->count != (size_t)-1)) \
+    { \
+        LINK_NODE_FIRST((node), (list)); \
+        ANCHORED_INDEX_LINKED_((node), (list)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* ANCHORED_LINK_NODE_LAST
+Link a node to an anchored list and position it as the tail node.
+
+If 'node' is part of a list or 'list' has a node count equal to the maximum
+value of size_t then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'node' : Pointer to a node that is not part of a list.
+[in] 'list' : Pointer to an anchored list.
+*/
+#define ANCHORED_LINK_NODE_LAST(node, list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node) && (list) && !(node)->parent \
+        && ((list)->count != (size_t)-1)) \
+    { \
+        LINK_NODE_LAST((node), (list)); \
+        ANCHORED_INDEX_LINKED_((node), (list)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* ANCHORED_LINK_NODE_BEFORE
+Link a node to an anchored list and position it before another node.
+
+If 'node' is part of a list, 'position_node' is not part of a list, or the list
+has a node count equal to the maximum value of size_t then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'node' : Pointer to a node that is not part of a list.
+[in] 'position_node' : Pointer to a node that's part of an anchored list.
+*/
+#define ANCHORED_LINK_NODE_BEFORE(node, position_node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node) && (position_node) && !(node)->parent \
+        && (position_node)->parent \
+        && ((position_node)->parent->count != (size_t)-1)) \
+    { \
+        LINK_NODE_BEFORE((node), (position_node)); \
+        ANCHORED_INDEX_LINKED_((node), (node)->parent); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* ANCHORED_LINK_NODE_AFTER
+Link a node to an anchored list and position it after another node.
+
+If 'node' is part of a list, 'position_node' is not part of a list, or the list
+has a node count equal to the maximum value of size_t then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'node' : Pointer to a node that is not part of a list.
+[in] 'position_node' : Pointer to a node that's part of an anchored list.
+*/
+#define ANCHORED_LINK_NODE_AFTER(node, position_node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node) && (position_node) && !(node)->parent \
+        && (position_node)->parent \
+        && ((position_node)->parent->count != (size_t)-1)) \
+    { \
+        LINK_NODE_AFTER((node), (position_node)); \
+        ANCHORED_INDEX_LINKED_((node), (node)->parent); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* ANCHORED_UNLINK_NODE
+Unlink a node from its anchored list.
+
+If 'node' is not part of an anchored list then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'node' : Pointer to a node.
+*/
+#define ANCHORED_UNLINK_NODE(node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node) && (node)->parent && (node)->anchor) { \
+        GENERIC_LIST_TRACE_(UNLINK, (node), (node)->parent, NULL); \
+        GENERIC_LIST_DETACH_((node), "ANCHORED_UNLINK_NODE"); \
+        (node)->parent->anchor_holder = (node)->anchor; \
+        (node)->anchor = NULL; \
+        if(!--(node)->parent->anchor_holder->seg_count) { \
+            ANCHORED_REMOVE_RECORD_((node)->parent); \
+        } \
+        else { \
+            if((node)->parent->anchor_holder->seg_first == (node)) { \
+                (node)->parent->anchor_holder->seg_first = (node)->next; \
+            } \
+            if((node)->parent->anchor_holder == (node)) { \
+                (node)->parent->anchor_split = (node)->seg_first; \
+                (node)->parent->anchor_split->seg_first = (node)->seg_first; \
+                (node)->parent->anchor_split->seg_count = (node)->seg_count; \
+                (node)->parent->anchor_split->seg_prev = (node)->seg_prev; \
+                (node)->parent->anchor_split->seg_next = (node)->seg_next; \
+                if((node)->seg_prev) { \
+                    (node)->seg_prev->seg_next = \
+                        (node)->parent->anchor_split; \
+                } \
+                else { \
+                    (node)->parent->first_anchor = \
+                        (node)->parent->anchor_split; \
+                } \
+                if((node)->seg_next) { \
+                    (node)->seg_next->seg_prev = \
+                        (node)->parent->anchor_split; \
+                } \
+                else { \
+                    (node)->parent->last_anchor = \
+                        (node)->parent->anchor_split; \
+                } \
+                (node)->seg_first = NULL; \
+                (node)->seg_prev = (node)->seg_next = NULL; \
+                (node)->seg_count = 0; \
+                (node)->parent->anchor_holder = (node)->parent->anchor_split; \
+                ANCHORED_SET_ANCHORS_((node)->parent, \
+                    (node)->parent->anchor_holder->seg_first, \
+                    (node)->parent->anchor_holder->seg_count, \
+                    (node)->parent->anchor_holder); \
+            } \
+            if(((node)->parent->anchor_holder->seg_count \
+                    < (node)->parent->anchor_k / 4) \
+                && (node)->parent->anchor_holder->seg_prev \
+                && ((node)->parent->anchor_holder->seg_prev->seg_count \
+                    + (node)->parent->anchor_holder->seg_count \
+                    < 2 * (node)->parent->anchor_k)) \
+            { \
+                ANCHORED_SET_ANCHORS_((node)->parent, \
+                    (node)->parent->anchor_holder->seg_first, \
+                    (node)->parent->anchor_holder->seg_count, \
+                    (node)->parent->anchor_holder->seg_prev); \
+                (node)->parent->anchor_holder->seg_prev->seg_count += \
+                    (node)->parent->anchor_holder->seg_count; \
+                ANCHORED_REMOVE_RECORD_((node)->parent); \
+            } \
+        } \
+        (node)->prev = (node)->next = NULL; \
+        (node)->parent = NULL; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+#endif /* GENERIC_ANCHORED_LIST_H_ */
@@ -0,0 +1,269 @@
+/* Atomic helper macros for the concurrent generic_list headers.
+*/
+#ifndef GENERIC_ATOMIC_H_
+#define GENERIC_ATOMIC_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Atomic helper macros for the concurrent generic_list headers.
+
+The generic_list members are plain pointers, not C11 _Atomic objects, so these
+macros use the compiler's builtins on them directly. GCC/Clang __atomic
+builtins and Visual Studio Interlocked intrinsics are supported.
+
+GENERIC_ATOMIC_LOAD_ACQUIRE
+Load a pointer member with acquire ordering.
+
+GENERIC_ATOMIC_STORE_RELEASE
+Store a pointer member with release ordering.
+
+GENERIC_ATOMIC_EXCHANGE
+Exchange a pointer member and return the old value, with full ordering.
+
+GENERIC_ATOMIC_LOAD_SIZE
+Load a size_t member with relaxed ordering.
+
+GENERIC_ATOMIC_STORE_SIZE
+Store a size_t member with relaxed ordering.
+
+GENERIC_ATOMIC_LOAD_SIZE_ACQUIRE
+Load a size_t member with acquire ordering.
+
+GENERIC_ATOMIC_STORE_SIZE_RELEASE
+Store a size_t member with release ordering.
+
+GENERIC_ATOMIC_CAS_SIZE
+Compare and swap a size_t member, nonzero if it was swapped.
+
+GENERIC_ATOMIC_ADD_SIZE
+Add to a size_t member with relaxed ordering and return the old value.
+
+GENERIC_ATOMIC_FENCE
+Full memory fence.
+
+GENERIC_CACHE_ALIGN
+Align a struct member to the start of a cache line.
+
+GENERIC_CPU_RELAX
+Hint to the CPU that the thread is in a spin-wait loop.
+
+GENERIC_SPINLOCK_ACQUIRE
+Acquire a spinlock, a long that is 0 when unlocked.
+
+GENERIC_SPINLOCK_RELEASE
+Release a spinlock.
+
+---
+Important:
+
+'obj' is an lvalue (eg node->next), not a pointer to one. It must be naturally
+aligned.
+*/
+
+#include "generic_list.h"
+
+
+/* The cache line size used for padding. 64 bytes on current x86 and ARM. */
+#ifndef GENERIC_CACHE_LINE_SIZE
+#define GENERIC_CACHE_LINE_SIZE   64
+#endif
+
+/* The number of times a spinlock spins before it yields the processor. */
+#ifndef GENERIC_SPIN_COUNT
+#define GENERIC_SPIN_COUNT   1000
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sched.h>
+#define GENERIC_THREAD_YIELD_()   sched_yield()
+#else
+#define GENERIC_THREAD_YIELD_()   ((void)0)
+#endif
+
+#if defined(__i386__) || defined(__x86_64__)
+#define GENERIC_CPU_RELAX()   __builtin_ia32_pause()
+#else
+#define GENERIC_CPU_RELAX()   __asm__ __volatile__("" ::: "memory")
+#endif
+
+#define GENERIC_CACHE_ALIGN   __attribute__((aligned(GENERIC_CACHE_LINE_SIZE)))
+
+#define GENERIC_ATOMIC_LOAD_ACQUIRE(obj)   \
+    __atomic_load_n(&(obj), __ATOMIC_ACQUIRE)
+
+#define GENERIC_ATOMIC_STORE_RELEASE(obj, value)   \
+    __atomic_store_n(&(obj), (value), __ATOMIC_RELEASE)
+
+#define GENERIC_ATOMIC_EXCHANGE(obj, value)   \
+    __atomic_exchange_n(&(obj), (value), __ATOMIC_SEQ_CST)
+
+#define GENERIC_ATOMIC_LOAD_SIZE(obj)   \
+    __atomic_load_n(&(obj), __ATOMIC_RELAXED)
+
+#define GENERIC_ATOMIC_STORE_SIZE(obj, value)   \
+    __atomic_store_n(&(obj), (value), __ATOMIC_RELAXED)
+
+#define GENERIC_ATOMIC_LOAD_SIZE_ACQUIRE(obj)   \
+    __atomic_load_n(&(obj), __ATOMIC_ACQUIRE)
+
+#define GENERIC_ATOMIC_STORE_SIZE_RELEASE(obj, value)   \
+    __atomic_store_n(&(obj), (value), __ATOMIC_RELEASE)
+
+#define GENERIC_ATOMIC_CAS_SIZE(obj, expected, desired)   \
+    __sync_bool_compare_and_swap(&(obj), (expected), (desired))
+
+#define GENERIC_ATOMIC_ADD_SIZE(obj, value)   \
+    __atomic_fetch_add(&(obj), (value), __ATOMIC_RELAXED)
+
+#define GENERIC_ATOMIC_FENCE()   __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#define GENERIC_SPINLOCK_TRY_(lock)   \
+    (!__atomic_exchange_n(&(lock), 1L, __ATOMIC_ACQUIRE))
+
+#define GENERIC_SPINLOCK_HELD_(lock)   \
+    __atomic_load_n(&(lock), __ATOMIC_RELAXED)
+
+#define GENERIC_SPINLOCK_RELEASE(lock)   \
+    __atomic_store_n(&(lock), 0L, __ATOMIC_RELEASE)
+
+#elif defined(_MSC_VER)
+
+#include <intrin.h>
+
+#define GENERIC_THREAD_YIELD_()   ((void)0)
+#define GENERIC_CPU_RELAX()   _mm_pause()
+#define GENERIC_CACHE_ALIGN   __declspec(align(GENERIC_CACHE_LINE_SIZE))
+
+#define GENERIC_ATOMIC_LOAD_SIZE(obj)   \
+    (*(const volatile size_t *)&(obj))
+
+#define GENERIC_ATOMIC_STORE_SIZE(obj, value)   \
+    (*(volatile size_t *)&(obj) = (value))
+
+#define GENERIC_ATOMIC_LOAD_SIZE_ACQUIRE(obj)   GENERIC_ATOMIC_LOAD_SIZE(obj)
+
+#define GENERIC_ATOMIC_STORE_SIZE_RELEASE(obj, value)   \
+    GENERIC_ATOMIC_STORE_SIZE(obj, value)
+
+#ifdef _WIN64
+#define GENERIC_ATOMIC_CAS_SIZE(obj, expected, desired)   \
+    (_InterlockedCompareExchange64((volatile __int64 *)&(obj), \
+        (__int64)(desired), (__int64)(expected)) == (__int64)(expected))
+#define GENERIC_ATOMIC_ADD_SIZE(obj, value)   \
+    ((size_t)_InterlockedExchangeAdd64((volatile __int64 *)&(obj), \
+        (__int64)(value)))
+#else
+#define GENERIC_ATOMIC_CAS_SIZE(obj, expected, desired)   \
+    (_InterlockedCompareExchange((volatile long *)&(obj), \
+        (long)(desired), (long)(expected)) == (long)(expected))
+#define GENERIC_ATOMIC_ADD_SIZE(obj, value)   \
+    ((size_t)_InterlockedExchangeAdd((volatile long *)&(obj), (long)(value)))
+#endif
+
+#define GENERIC_ATOMIC_FENCE()   _mm_mfence()
+
+#define GENERIC_SPINLOCK_TRY_(lock)   \
+    (!_InterlockedExchange((volatile long *)&(lock), 1L))
+
+#define GENERIC_SPINLOCK_HELD_(lock)   \
+    (*(const volatile long *)&(lock))
+
+#define GENERIC_SPINLOCK_RELEASE(lock)   \
+    (*(volatile long *)&(lock) = 0L)
+
+/* With the default /volatile:ms a volatile access of an aligned pointer has
+acquire (load) or release (store) semantics. In C the void pointer results
+convert implicitly, in C++ templates keep the member's type. */
+#ifdef __cplusplus
+template<typename T>
+inline T *generic_atomic_load_acquire_(T *const volatile *obj)
+{
+    return *obj;
+}
+template<typename T>
+inline void generic_atomic_store_release_(T *volatile *obj, T *value)
+{
+    *obj = value;
+}
+template<typename T>
+inline T *generic_atomic_exchange_(T *volatile *obj, T *value)
+{
+    return (T *)_InterlockedExchangePointer((void *volatile *)obj,
+        (void *)value);
+}
+#define GENERIC_ATOMIC_LOAD_ACQUIRE(obj)   \
+    generic_atomic_load_acquire_(&(obj))
+#define GENERIC_ATOMIC_STORE_RELEASE(obj, value)   \
+    generic_atomic_store_release_(&(obj), (value))
+#define GENERIC_ATOMIC_EXCHANGE(obj, value)   \
+    generic_atomic_exchange_(&(obj), (value))
+#else
+#define GENERIC_ATOMIC_LOAD_ACQUIRE(obj)   \
+    (*(void *const volatile *)&(obj))
+#define GENERIC_ATOMIC_STORE_RELEASE(obj, value)   \
+    (*(void *volatile *)&(obj) = (void *)(value))
+#define GENERIC_ATOMIC_EXCHANGE(obj, value)   \
+    _InterlockedExchangePointer((void *volatile *)&(obj), (void *)(value))
+#endif
+
+#else
+#error "generic_atomic.h: Unsupported compiler. GCC, Clang or MSVC required."
+#endif
+
+
+/* GENERIC_SPINLOCK_ACQUIRE
+Acquire a spinlock, a long that is 0 when unlocked.
+
+The lock is test-and-test-and-set: while it is held the waiter spins on a
+relaxed load with GENERIC_CPU_RELAX and, after GENERIC_SPIN_COUNT spins, yields
+the processor where the platform allows it.
+
+[in] 'lock' : A long lvalue (eg queue->head_lock).
+*/
+#define GENERIC_SPINLOCK_ACQUIRE(lock)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    unsigned generic_spins_ = 0; \
+    while(!GENERIC_SPINLOCK_TRY_((lock))) { \
+        while(GENERIC_SPINLOCK_HELD_((lock))) { \
+            if(++generic_spins_ < GENERIC_SPIN_COUNT) { \
+                GENERIC_CPU_RELAX(); \
+            } \
+            else { \
+                generic_spins_ = 0; \
+                GENERIC_THREAD_YIELD_(); \
+            } \
+        } \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+#endif /* GENERIC_ATOMIC_H_ */
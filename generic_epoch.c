@@ -0,0 +1,194 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Epoch-based memory reclamation. Documentation is in generic_epoch.h.
+*/
+
+#include "generic_epoch.h"
+#include "generic_atomic.h"
+
+
+/* Free all entries in a limbo list. Returns the number freed. */
+static size_t FreeLimbo(struct epoch_entry_list *limbo) {
+    size_t freed = 0;
+    while(limbo->head) {
+        struct epoch_entry *entry = limbo->head;
+        UNLINK_NODE(entry);
+        /* entry may be part of the memory that free_func frees */
+        entry->free_func(entry->ptr);
+        ++freed;
+    }
+    return freed;
+}
+
+/* Advance the global epoch if every thread in a critical section has seen it.
+Returns the global epoch after the attempt. */
+static size_t TryAdvance(struct epoch_domain *domain) {
+    struct epoch_thread *thread = NULL;
+    size_t epoch = GENERIC_ATOMIC_LOAD_SIZE_ACQUIRE(domain->epoch);
+
+    GENERIC_SPINLOCK_ACQUIRE(domain->lock);
+    for(thread = domain->threads.head; thread; thread = thread->next) {
+        size_t state = GENERIC_ATOMIC_LOAD_SIZE_ACQUIRE(thread->state);
+        if((state & 1) && ((state >> 1) != epoch)) {
+            GENERIC_SPINLOCK_RELEASE(domain->lock);
+            return epoch;
+        }
+    }
+    GENERIC_SPINLOCK_RELEASE(domain->lock);
+
+    if(GENERIC_ATOMIC_CAS_SIZE(domain->epoch, epoch, epoch + 1)) {
+        return epoch + 1;
+    }
+    return GENERIC_ATOMIC_LOAD_SIZE_ACQUIRE(domain->epoch);
+}
+
+
+void epoch_domain_init(struct epoch_domain *domain) {
+    if(!domain) {
+        return;
+    }
+    domain->epoch = 0;
+    domain->lock = 0;
+    ZERO_OUT_LIST_MEMBERS(&domain->threads);
+}
+
+
+void epoch_thread_register(struct epoch_domain *domain,
+    struct epoch_thread *thread)
+{
+    int i;
+    if(!domain || !thread) {
+        return;
+    }
+    ZERO_OUT_NODE_MEMBERS(thread);
+    thread->domain = domain;
+    thread->state = 0;
+    thread->nesting = 0;
+    for(i = 0; i < 3; ++i) {
+        ZERO_OUT_LIST_MEMBERS(&thread->limbo[i]);
+        thread->limbo_epoch[i] = 0;
+    }
+    GENERIC_SPINLOCK_ACQUIRE(domain->lock);
+    LINK_NODE_LAST(thread, &domain->threads);
+    GENERIC_SPINLOCK_RELEASE(domain->lock);
+}
+
+
+void epoch_thread_unregister(struct epoch_thread *thread) {
+    struct epoch_domain *domain = NULL;
+    if(!thread || !thread->domain) {
+        return;
+    }
+    epoch_synchronize(thread);
+    domain = thread->domain;
+    GENERIC_SPINLOCK_ACQUIRE(domain->lock);
+    UNLINK_NODE(thread);
+    GENERIC_SPINLOCK_RELEASE(domain->lock);
+    thread->domain = NULL;
+}
+
+
+void epoch_enter(struct epoch_thread *thread) {
+    size_t epoch;
+    if(thread->nesting++) {
+        return;
+    }
+    /* The state must be visible before any read in the critical section, and
+    the epoch must not have moved on while it was being published. */
+    do {
+        epoch = GENERIC_ATOMIC_LOAD_SIZE_ACQUIRE(thread->domain->epoch);
+        GENERIC_ATOMIC_STORE_SIZE(thread->state, (epoch << 1) | 1);
+        GENERIC_ATOMIC_FENCE();
+    } while(GENERIC_ATOMIC_LOAD_SIZE_ACQUIRE(thread->domain->epoch) != epoch);
+}
+
+
+void epoch_exit(struct epoch_thread *thread) {
+    if(!thread->nesting || --thread->nesting) {
+        return;
+    }
+    GENERIC_ATOMIC_STORE_SIZE_RELEASE(thread->state, 0);
+}
+
+
+void epoch_retire(struct epoch_thread *thread, struct epoch_entry *entry,
+    void *ptr, void (*free_func)(void *ptr))
+{
+    size_t epoch;
+    struct epoch_entry_list *limbo = NULL;
+    if(!thread || !entry || !free_func) {
+        return;
+    }
+    /* The store that made the memory unreachable must be visible before the
+    epoch is read. Otherwise the memory could be tagged with epoch e while a
+    reader that entered at e+1 still finds it, and be freed at e+2 under it. */
+    GENERIC_ATOMIC_FENCE();
+    epoch = GENERIC_ATOMIC_LOAD_SIZE_ACQUIRE(thread->domain->epoch);
+    limbo = &thread->limbo[epoch % 3];
+    /* Anything left in this slot was retired at least 3 epochs ago. */
+    if(thread->limbo_epoch[epoch % 3] != epoch) {
+        FreeLimbo(limbo);
+        thread->limbo_epoch[epoch % 3] = epoch;
+    }
+    ZERO_OUT_NODE_MEMBERS(entry);
+    entry->ptr = ptr;
+    entry->free_func = free_func;
+    LINK_NODE_LAST(entry, limbo);
+}
+
+
+size_t epoch_collect(struct epoch_thread *thread) {
+    int i;
+    size_t epoch, freed = 0;
+    if(!thread || !thread->domain) {
+        return 0;
+    }
+    epoch = TryAdvance(thread->domain);
+    for(i = 0; i < 3; ++i) {
+        if(thread->limbo[i].head && (thread->limbo_epoch[i] + 2 <= epoch)) {
+            freed += FreeLimbo(&thread->limbo[i]);
+        }
+    }
+    return freed;
+}
+
+
+void epoch_synchronize(struct epoch_thread *thread) {
+    if(!thread || !thread->domain) {
+        return;
+    }
+    for(;;) {
+        epoch_collect(thread);
+        if(!thread->limbo[0].head && !thread->limbo[1].head
+            && !thread->limbo[2].head)
+        {
+            break;
+        }
+        GENERIC_CPU_RELAX();
+    }
+}
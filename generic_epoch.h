@@ -0,0 +1,217 @@
+/* Epoch-based memory reclamation for lock-free readers of generic_list lists.
+*/
+#ifndef GENERIC_EPOCH_H_
+#define GENERIC_EPOCH_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Epoch-based memory reclamation for lock-free readers of generic_list lists.
+
+This module is self-contained: compile generic_epoch.c with your program. It is
+used with generic_rcu_list.h but has no dependency on it, any memory that
+lock-free readers may still be looking at can be retired.
+
+A domain has a global epoch. Each thread that reads or retires registers a
+thread record with the domain. A reader brackets its traversal with
+epoch_enter/epoch_exit, which records the global epoch in the thread record. A
+writer that unlinks a node passes it to epoch_retire instead of freeing it. The
+global epoch can only advance when every thread inside a critical section has
+seen the current epoch, so once it has advanced twice past the epoch in which
+a node was retired no reader can still hold a pointer to the node and it is
+freed.
+
+Retired memory is kept in three limbo lists per thread, one per epoch modulo 3.
+The limbo lists are generic_list lists of epoch_entry nodes, which are usually
+embedded in the retired object itself so retiring never allocates.
+
+epoch_domain_init
+Initialize a domain.
+
+epoch_thread_register
+Register a thread record with a domain.
+
+epoch_thread_unregister
+Free everything the thread retired and unregister its thread record.
+
+epoch_enter
+Enter a read-side critical section.
+
+epoch_exit
+Exit a read-side critical section.
+
+epoch_retire
+Free memory once no reader can be holding a pointer to it.
+
+epoch_collect
+Try to advance the global epoch and free what the thread retired that is safe.
+
+epoch_synchronize
+Wait until everything the thread retired has been freed.
+
+---
+Important:
+
+A thread record must only be used by the thread that owns it.
+
+epoch_synchronize and epoch_thread_unregister wait for the other threads to
+leave their critical sections, so they must not be called inside one.
+*/
+
+#include <stddef.h>
+
+#include "generic_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct epoch_domain;
+
+struct epoch_entry_list;
+struct epoch_entry {
+    DECLARE_NODE_MEMBERS(epoch_entry, epoch_entry_list);
+    void *ptr;
+    void (*free_func)(void *ptr);
+};
+struct epoch_entry_list {
+    DECLARE_LIST_MEMBERS(epoch_entry);
+};
+
+struct epoch_thread_list;
+struct epoch_thread {
+    DECLARE_NODE_MEMBERS(epoch_thread, epoch_thread_list);
+    struct epoch_domain *domain;
+    /* (epoch << 1) | 1 while in a critical section, otherwise 0. */
+    size_t state;
+    unsigned nesting;
+    struct epoch_entry_list limbo[3];
+    size_t limbo_epoch[3];
+};
+struct epoch_thread_list {
+    DECLARE_LIST_MEMBERS(epoch_thread);
+};
+
+struct epoch_domain {
+    size_t epoch;
+    /* spinlock that protects 'threads' */
+    long lock;
+    struct epoch_thread_list threads;
+};
+
+
+/* epoch_domain_init
+Initialize a domain.
+
+[in] 'domain' : Pointer to a domain.
+*/
+void epoch_domain_init(struct epoch_domain *domain);
+
+
+/* epoch_thread_register
+Register a thread record with a domain.
+
+[in] 'domain' : Pointer to an initialized domain.
+[in] 'thread' : Pointer to a thread record. It is initialized by this function.
+*/
+void epoch_thread_register(struct epoch_domain *domain,
+    struct epoch_thread *thread);
+
+
+/* epoch_thread_unregister
+Free everything the thread retired and unregister its thread record.
+
+This calls epoch_synchronize, it must not be called in a critical section.
+
+[in] 'thread' : Pointer to a registered thread record.
+*/
+void epoch_thread_unregister(struct epoch_thread *thread);
+
+
+/* epoch_enter
+Enter a read-side critical section.
+
+Pointers to retired memory that are obtained after this call remain valid
+until the matching epoch_exit. Critical sections may be nested.
+
+[in] 'thread' : Pointer to a registered thread record.
+*/
+void epoch_enter(struct epoch_thread *thread);
+
+
+/* epoch_exit
+Exit a read-side critical section.
+
+[in] 'thread' : Pointer to a registered thread record.
+*/
+void epoch_exit(struct epoch_thread *thread);
+
+
+/* epoch_retire
+Free memory once no reader can be holding a pointer to it.
+
+Call this after the memory has been made unreachable (eg after
+RCU_UNLINK_NODE).
+It can be called inside or outside a critical section.
+'free_func' is called with 'ptr' by a later epoch_retire, epoch_collect,
+epoch_synchronize or epoch_thread_unregister on the same thread record. 'entry'
+must stay valid until then; usually it is a member of the object at 'ptr'.
+
+[in] 'thread' : Pointer to a registered thread record.
+[in] 'entry' : Pointer to an epoch_entry that is not in use.
+[in] 'ptr' : Pointer to pass to free_func.
+[in] 'free_func' : Function that frees ptr.
+*/
+void epoch_retire(struct epoch_thread *thread, struct epoch_entry *entry,
+    void *ptr, void (*free_func)(void *ptr));
+
+
+/* epoch_collect
+Try to advance the global epoch and free what the thread retired that is safe.
+
+This never waits. It can be called inside or outside a critical section,
+although the epoch can't advance past a thread's own critical section.
+
+[in] 'thread' : Pointer to a registered thread record.
+
+Returns the number of retired entries that were freed.
+*/
+size_t epoch_collect(struct epoch_thread *thread);
+
+
+/* epoch_synchronize
+Wait until everything the thread retired has been freed.
+
+[in] 'thread' : Pointer to a registered thread record.
+*/
+void epoch_synchronize(struct epoch_thread *thread);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GENERIC_EPOCH_H_ */
@@ -0,0 +1,175 @@
+/* Generic helper macros for a list that a consumer takes whole from producers.
+*/
+#ifndef GENERIC_HANDOFF_LIST_H_
+#define GENERIC_HANDOFF_LIST_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Generic helper macros for a list that a consumer takes whole from producers.
+
+Producers link nodes to a pending list under a spinlock and a consumer takes
+every pending node at once. The steal is an exchange of the pending list's
+head, tail and count with an empty list, so the lock is held for O(1) no matter
+how many nodes are pending. The chain the consumer gets is an ordinary list
+with head, tail and count intact, but its nodes' parent still points to the
+pending list. The consumer fixes that with ADOPT_LIST_NODES after the lock is
+released, off the contended path, if it needs to use the other macros on them.
+
+DECLARE_HANDOFF_LIST_MEMBERS
+Declare the handoff list members (pending, lock).
+
+ZERO_OUT_HANDOFF_LIST_MEMBERS
+Zero out the handoff list members.
+
+HANDOFF_LIST_LINK_LAST
+Link a node to the tail of the pending list.
+
+HANDOFF_LIST_STEAL_ALL
+Take every pending node and move it to the end of a list.
+
+---
+Important:
+
+The same rules as generic_list.h apply. The input parameters for the macros are
+evaluated multiple times because they are generic function-like macros. The
+parameters must not have side effects or access the list.
+
+Pending nodes must only be added by HANDOFF_LIST_LINK_LAST and removed by
+HANDOFF_LIST_STEAL_ALL. In particular a pending node must not be unlinked with
+UNLINK_NODE, and a stolen node must not be passed to any other macro until
+ADOPT_LIST_NODES has been called on the list it was stolen to (or it has been
+reset with ZERO_OUT_NODE_MEMBERS).
+
+---
+Other:
+
+The pending list is aligned to a cache line so producers don't false-share it
+with neighbouring memory. The lock is the spinlock from generic_atomic.h, which
+is included by this header.
+*/
+
+#include "generic_list.h"
+#include "generic_atomic.h"
+
+
+/* DECLARE_HANDOFF_LIST_MEMBERS
+Declare the handoff list members (pending, lock).
+
+Use this declaration in your handoff list struct.
+
+This macro adds the following members:
+pending : The list of nodes linked since the last steal.
+lock : The spinlock that protects pending.
+
+[in] 'list_tag' : Tag name of your list struct.
+*/
+#define DECLARE_HANDOFF_LIST_MEMBERS(list_tag)   \
+    GENERIC_CACHE_ALIGN struct list_tag pending; \
+    long lock
+
+
+/* ZERO_OUT_HANDOFF_LIST_MEMBERS
+Zero out the handoff list members.
+
+It must not be called while any other thread is using the handoff list.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'handoff' : Pointer to a handoff list.
+*/
+#define ZERO_OUT_HANDOFF_LIST_MEMBERS(handoff)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((handoff)) { \
+        ZERO_OUT_LIST_MEMBERS(&(handoff)->pending); \
+        (handoff)->lock = 0; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* HANDOFF_LIST_LINK_LAST
+Link a node to the tail of the pending list.
+
+If the pending list has a node count equal to the maximum value of size_t then
+no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'handoff' : Pointer to a handoff list.
+[in] 'node' : Pointer to a node that is not part of a list.
+*/
+#define HANDOFF_LIST_LINK_LAST(handoff, node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((handoff) && (node) && !(node)->parent) { \
+        GENERIC_SPINLOCK_ACQUIRE((handoff)->lock); \
+        LINK_NODE_LAST((node), &(handoff)->pending); \
+        GENERIC_SPINLOCK_RELEASE((handoff)->lock); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* HANDOFF_LIST_STEAL_ALL
+Take every pending node and move it to the end of a list.
+
+The pending list is stitched onto 'list' by STITCH_LIST_LAST and left empty, in
+O(1) under the lock. If 'list' is empty it ends up with exactly the pending
+list's head, tail and count. The stolen nodes' parent still points to the
+pending list, see ADOPT_LIST_NODES.
+
+If the combined node count would exceed the maximum value of size_t then no
+action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'handoff' : Pointer to a handoff list.
+[in] 'list' : Pointer to a list that only the caller is using.
+*/
+#define HANDOFF_LIST_STEAL_ALL(handoff, list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((handoff) && (list)) { \
+        GENERIC_SPINLOCK_ACQUIRE((handoff)->lock); \
+        STITCH_LIST_LAST((list), &(handoff)->pending); \
+        GENERIC_SPINLOCK_RELEASE((handoff)->lock); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+#endif /* GENERIC_HANDOFF_LIST_H_ */
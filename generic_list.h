@@ -59,6 +59,30 @@ Link a node to a list and position it before another node already in the list.
 LINK_NODE_AFTER
 Link a node to a list and position it after another node already in the list.
 
+SPLICE_LIST_LAST
+Move all nodes from a list to the end of another list.
+
+STITCH_LIST_LAST
+Move all nodes from a list to the end of another list without adopting them.
+
+HIDE_NODE
+Detach a node from its neighbours and list but keep its own links.
+
+RESTORE_NODE
+Reattach a node that was detached by HIDE_NODE.
+
+ADOPT_LIST_NODES
+Set the parent of every node in a list to that list.
+
+LIST_FOREACH
+Traverse a list from head to tail.
+
+LIST_STATS_SNAPSHOT
+Copy the operation statistics of a list.
+
+LIST_STATS_RESET
+Reset the operation statistics of a list.
+
 ---
 Important:
 
@@ -87,6 +111,21 @@ for it must come before both.
 If you are not zeroing your struct before using you must zero the node/list
 members before using by calling ZERO_OUT_NODE_MEMBERS/ZERO_OUT_LIST_MEMBERS.
 
+If GENERIC_LIST_STATS is defined before this header is included then every list
+carries a 'stats' member of struct generic_list_stats with counters of the
+operations on it, see LIST_STATS_SNAPSHOT. It must be defined the same way in
+every file that uses the same structs. Otherwise the counting compiles to
+nothing.
+
+If GENERIC_LIST_TRACE is defined before this header is included then every
+macro that changes a list records the operation in a per-thread ring buffer,
+see generic_list_trace.h. Otherwise the tracing compiles to nothing.
+
+If GENERIC_LIST_CHECK is defined to 1 or 2 before this header is included then
+the macros check the links they use and change, and call
+GENERIC_LIST_CHECK_FAIL at the first inconsistency, see GENERIC_LIST_CHECK_.
+Otherwise, or with 0, the checking compiles to nothing.
+
 For an example refer to example.c
 */
 
@@ -100,6 +139,211 @@ For an example refer to example.c
 #endif
 #endif
 
+/* GENERIC_LIST_TRACE_
+For internal use. Record an operation if tracing is enabled. An unlink is only
+recorded if the node is linked to something.
+*/
+#ifdef GENERIC_LIST_TRACE
+#include "generic_list_trace.h"
+#define GENERIC_LIST_TRACE_(op, node, list, position)   \
+    list_trace_record(LIST_TRACE_##op, (const void *)(node), \
+        (const void *)(list), (const void *)(position))
+#define GENERIC_LIST_TRACE_UNLINK_(node)   \
+    (((node)->parent || (node)->prev || (node)->next) ? \
+        GENERIC_LIST_TRACE_(UNLINK, (node), (node)->parent, NULL) : (void)0)
+#else
+#define GENERIC_LIST_TRACE_(op, node, list, position)   ((void)0)
+#define GENERIC_LIST_TRACE_UNLINK_(node)   ((void)0)
+#endif
+
+
+/* struct generic_list_stats
+The operation statistics of a list, see LIST_STATS_SNAPSHOT.
+
+links : The number of nodes linked to the list, by any macro that changes the
+list's count. A RESTORE_NODE counts as a link and a HIDE_NODE as an unlink.
+unlinks : The number of nodes unlinked from the list, by any macro that changes
+the list's count.
+moves : The number of the linked nodes that came directly from another list.
+saturated : The number of links that were not done because of the maximum
+count.
+max_count : The high-water mark of count.
+visits : The number of nodes visited by LIST_FOREACH and the find and sweep
+helpers.
+*/
+struct generic_list_stats {
+    size_t links;
+    size_t unlinks;
+    size_t moves;
+    size_t saturated;
+    size_t max_count;
+    size_t visits;
+};
+
+/* GENERIC_LIST_STATS_
+For internal use. Count an operation if statistics are enabled.
+
+DECLARE_ : The stats member of the list struct.
+ZERO_ : Zero the counters.
+MOVED_DECL_ : Declare a local that remembers if a node comes from another list.
+JOIN_ : 'n' nodes joined a list, 'moved' if they came from another list.
+LEAVE_ : 'n' nodes left a list.
+SATURATED_ : A link to a list was not done because of the maximum count.
+VISIT_ : A node of a list was visited.
+*/
+#ifdef GENERIC_LIST_STATS
+#define GENERIC_LIST_STATS_DECLARE_   ; struct generic_list_stats stats
+#define GENERIC_LIST_STATS_ZERO_(list)   \
+    ((list)->stats.links = (list)->stats.unlinks = (list)->stats.moves = \
+        (list)->stats.saturated = (list)->stats.max_count = \
+        (list)->stats.visits = 0)
+#define GENERIC_LIST_STATS_MOVED_DECL_(node, list)   \
+    int generic_stats_moved_ = ((node)->parent && ((node)->parent != (list)));
+#define GENERIC_LIST_STATS_JOIN_(list, n, moved)   \
+    ((list)->stats.links += (n), \
+        (list)->stats.moves += (moved) ? (n) : 0, \
+        (list)->stats.max_count = ((list)->count > (list)->stats.max_count) ? \
+            (list)->count : (list)->stats.max_count)
+#define GENERIC_LIST_STATS_LEAVE_(list, n)   ((list)->stats.unlinks += (n))
+#define GENERIC_LIST_STATS_SATURATED_(list)   (++(list)->stats.saturated)
+#define GENERIC_LIST_STATS_VISIT_(list)   (++(list)->stats.visits)
+#else
+#define GENERIC_LIST_STATS_DECLARE_
+#define GENERIC_LIST_STATS_ZERO_(list)   ((void)0)
+#define GENERIC_LIST_STATS_MOVED_DECL_(node, list)
+#define GENERIC_LIST_STATS_JOIN_(list, n, moved)   ((void)0)
+#define GENERIC_LIST_STATS_LEAVE_(list, n)   ((void)0)
+#define GENERIC_LIST_STATS_SATURATED_(list)   ((void)0)
+#define GENERIC_LIST_STATS_VISIT_(list)   ((void)0)
+#endif
+
+
+/* GENERIC_LIST_CHECK_
+For internal use. Check the links around an operation if checking is enabled.
+
+GENERIC_LIST_CHECK is the check level:
+
+0 : Nothing is checked. This is the default.
+1 : O(1) local checks on entry to and exit from each macro: the nodes that are
+    passed in and the nodes linked have neighbours that point back to them
+    and have the same parent, a node without a prev or next is the head or
+    tail of its list, and a list's head has no prev, its tail has no next and
+    it is empty exactly when its count is 0. This is cheap enough to leave on
+    in a canary build and it stops at the operation that finds a bad link,
+    not at a later crash.
+2 : Level 1 and a walk of each list that's changed, checking every node's
+    links and parent and the list's count and tail. A list that a node is
+    unlinked from is walked before the unlink, the others after the change.
+    O(n) per operation, for tests.
+
+A failed check calls GENERIC_LIST_CHECK_FAIL(op, what) with the name of the
+macro and a description, as string literals. The default prints them with the
+file and line to stderr and calls abort(). Define your own before this header
+is included to log, break into a debugger or throw; if it returns then the
+macro carries on.
+
+NODE_ : The node's neighbours point back to it and it's consistent with its
+        list's head and tail.
+LIST_ : The list's head, tail and count are consistent.
+HIDDEN_ : The node was hidden by HIDE_NODE and its neighbours skip it.
+WALK_ : Walk the list, 'parents' is 0 to not check the nodes' parent.
+*/
+#if defined(GENERIC_LIST_CHECK) && (GENERIC_LIST_CHECK >= 1)
+#ifndef GENERIC_LIST_CHECK_FAIL
+#include <stdio.h>
+#include <stdlib.h>
+#define GENERIC_LIST_CHECK_FAIL(op, what)   \
+    (fprintf(stderr, "generic_list: %s: %s (%s:%d)\n", (op), (what), \
+        __FILE__, __LINE__), abort())
+#endif
+#define GENERIC_LIST_CHECK_NODE_(node, op)   \
+    ((((node)->prev ? ((node)->prev->next == (node) \
+            && (node)->prev->parent == (node)->parent) \
+        : (!(node)->parent || (node)->parent->head == (node))) \
+    && ((node)->next ? ((node)->next->prev == (node) \
+            && (node)->next->parent == (node)->parent) \
+        : (!(node)->parent || (node)->parent->tail == (node)))) ? \
+    (void)0 : GENERIC_LIST_CHECK_FAIL((op), "a node's links are inconsistent"))
+#define GENERIC_LIST_CHECK_LIST_(list, op)   \
+    (((list)->head ? ((list)->tail && (list)->count && !(list)->head->prev \
+            && !(list)->tail->next) \
+        : (!(list)->tail && !(list)->count)) ? \
+    (void)0 : GENERIC_LIST_CHECK_FAIL((op), "a list's ends are inconsistent"))
+#define GENERIC_LIST_CHECK_HIDDEN_(node, op)   \
+    ((((node)->prev ? ((node)->prev->next == (node)->next) \
+        : (!(node)->parent || (node)->parent->head == (node)->next)) \
+    && ((node)->next ? ((node)->next->prev == (node)->prev) \
+        : (!(node)->parent || (node)->parent->tail == (node)->prev))) ? \
+    (void)0 : GENERIC_LIST_CHECK_FAIL((op), \
+        "a node is not restored in the reverse order it was hidden"))
+#else
+#define GENERIC_LIST_CHECK_NODE_(node, op)   ((void)0)
+#define GENERIC_LIST_CHECK_LIST_(list, op)   ((void)0)
+#define GENERIC_LIST_CHECK_HIDDEN_(node, op)   ((void)0)
+#endif
+
+#if defined(GENERIC_LIST_CHECK) && (GENERIC_LIST_CHECK >= 2)
+#include <string.h>
+
+#if defined(_MSC_VER)
+#define GENERIC_LIST_CHECK_INLINE_   static __inline
+#elif defined(__GNUC__) || defined(__clang__)
+#define GENERIC_LIST_CHECK_INLINE_   static __inline__
+#else
+#define GENERIC_LIST_CHECK_INLINE_   static inline
+#endif
+
+/* The walk doesn't know the node type, so it is passed the offsets of the
+node's members, measured on the list's head, and reads them with memcpy. It
+returns a description of the first inconsistency, or NULL. */
+GENERIC_LIST_CHECK_INLINE_ const char *generic_list_check_walk_(
+    const void *list, const void *head, const void *tail, size_t count,
+    size_t prev_offset, size_t next_offset, size_t parent_offset, int parents)
+{
+    const void *node = head, *prev = NULL, *link;
+    size_t n = 0;
+    while(node) {
+        if(++n > count) {
+            return "a list has more nodes than its count";
+        }
+        memcpy(&link, (const char *)node + prev_offset, sizeof(link));
+        if(link != prev) {
+            return "a node's prev is not the node before it";
+        }
+        memcpy(&link, (const char *)node + parent_offset, sizeof(link));
+        if(parents && link != list) {
+            return "a node's parent is not its list";
+        }
+        prev = node;
+        memcpy(&node, (const char *)node + next_offset, sizeof(node));
+    }
+    if(n != count || prev != tail) {
+        return "a list has fewer nodes than its count or ends before its tail";
+    }
+    return NULL;
+}
+
+#define GENERIC_LIST_CHECK_OFFSET_(list, member)   \
+    ((size_t)((const char *)&(list)->head->member \
+        - (const char *)(list)->head))
+#define GENERIC_LIST_CHECK_WALK_(list, parents, op)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    const char *generic_check_what_ = (list)->head ? \
+        generic_list_check_walk_((list), (list)->head, (list)->tail, \
+            (list)->count, GENERIC_LIST_CHECK_OFFSET_((list), prev), \
+            GENERIC_LIST_CHECK_OFFSET_((list), next), \
+            GENERIC_LIST_CHECK_OFFSET_((list), parent), (parents)) : NULL; \
+    if(generic_check_what_) { \
+        GENERIC_LIST_CHECK_FAIL((op), generic_check_what_); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+#else
+#define GENERIC_LIST_CHECK_WALK_(list, parents, op)   ((void)0)
+#endif
+
 
 /* DECLARE_NODE_MEMBERS
 Declare the node members (prev, next, parent).
@@ -127,11 +371,12 @@ This macro adds the following members:
 head : Pointer to the first node in the list. NULL if none.
 tail : Pointer to the last node in the list. NULL if none.
 count : The number of nodes in the list. 0 if none.
+stats : The operation statistics, only if GENERIC_LIST_STATS is defined.
 
 [in] 'node_tag' : Tag name of your node struct.
 */
 #define DECLARE_LIST_MEMBERS(node_tag)   \
-    struct node_tag *head, *tail; size_t count
+    struct node_tag *head, *tail; size_t count GENERIC_LIST_STATS_DECLARE_
 
 
 /* ZERO_OUT_NODE_MEMBERS
@@ -174,6 +419,7 @@ do { \
     if((list)) { \
         (list)->count = 0; \
         (list)->head = (list)->tail = NULL; \
+        GENERIC_LIST_STATS_ZERO_((list)); \
     } \
 } while(0) \
 MS_INLINE_PRAGMA(warning(pop))
@@ -194,7 +440,10 @@ MS_INLINE_PRAGMA(warning(push)) \
 MS_INLINE_PRAGMA(warning(disable:4127)) \
 do { \
     if((node)) { \
+        GENERIC_LIST_TRACE_UNLINK_((node)); \
+        GENERIC_LIST_CHECK_NODE_((node), "UNLINK_NODE"); \
         if((node)->parent) { \
+            GENERIC_LIST_CHECK_WALK_((node)->parent, 1, "UNLINK_NODE"); \
             if((node)->parent->head == (node)) { \
                 (node)->parent->head = (node)->next; \
             } \
@@ -202,6 +451,7 @@ do { \
                 (node)->parent->tail = (node)->prev; \
             } \
             --(node)->parent->count; \
+            GENERIC_LIST_STATS_LEAVE_((node)->parent, 1); \
             (node)->parent = NULL; \
         } \
         if((node)->prev) { \
@@ -240,6 +490,8 @@ do { \
     if((node) && (list) && ((node) != (list)->head) \
         && ((list)->count != (size_t)-1)) \
     { \
+        GENERIC_LIST_STATS_MOVED_DECL_((node), (list)) \
+        GENERIC_LIST_CHECK_LIST_((list), "LINK_NODE_FIRST"); \
         UNLINK_NODE((node)); \
         (node)->next = (list)->head; \
         (node)->prev = NULL; \
@@ -252,6 +504,14 @@ do { \
         (list)->head = (node); \
         ++(list)->count; \
         (node)->parent = (list); \
+        GENERIC_LIST_STATS_JOIN_((list), 1, generic_stats_moved_); \
+        GENERIC_LIST_TRACE_(LINK_FIRST, (node), (list), NULL); \
+        GENERIC_LIST_CHECK_NODE_((node), "LINK_NODE_FIRST"); \
+        GENERIC_LIST_CHECK_LIST_((list), "LINK_NODE_FIRST"); \
+        GENERIC_LIST_CHECK_WALK_((list), 1, "LINK_NODE_FIRST"); \
+    } \
+    else if((node) && (list) && ((list)->count == (size_t)-1)) { \
+        GENERIC_LIST_STATS_SATURATED_((list)); \
     } \
 } while(0) \
 MS_INLINE_PRAGMA(warning(pop))
@@ -281,6 +541,8 @@ do { \
     if((node) && (list) && ((node) != (list)->tail) \
         && ((list)->count != (size_t)-1)) \
     { \
+        GENERIC_LIST_STATS_MOVED_DECL_((node), (list)) \
+        GENERIC_LIST_CHECK_LIST_((list), "LINK_NODE_LAST"); \
         UNLINK_NODE((node)); \
         (node)->next = NULL; \
         (node)->prev = (list)->tail; \
@@ -293,6 +555,14 @@ do { \
         (list)->tail = (node); \
         ++(list)->count; \
         (node)->parent = (list); \
+        GENERIC_LIST_STATS_JOIN_((list), 1, generic_stats_moved_); \
+        GENERIC_LIST_TRACE_(LINK_LAST, (node), (list), NULL); \
+        GENERIC_LIST_CHECK_NODE_((node), "LINK_NODE_LAST"); \
+        GENERIC_LIST_CHECK_LIST_((list), "LINK_NODE_LAST"); \
+        GENERIC_LIST_CHECK_WALK_((list), 1, "LINK_NODE_LAST"); \
+    } \
+    else if((node) && (list) && ((list)->count == (size_t)-1)) { \
+        GENERIC_LIST_STATS_SATURATED_((list)); \
     } \
 } while(0) \
 MS_INLINE_PRAGMA(warning(pop))
@@ -326,6 +596,8 @@ do { \
     if((node) && (position_node) && ((node) != (position_node)) \
         && (!(node)->parent || ((node)->parent->count != (size_t)-1))) \
     { \
+        GENERIC_LIST_STATS_MOVED_DECL_((node), (position_node)->parent) \
+        GENERIC_LIST_CHECK_NODE_((position_node), "LINK_NODE_BEFORE"); \
         UNLINK_NODE((node)); \
         (node)->next = (position_node); \
         (node)->prev = (position_node)->prev; \
@@ -338,8 +610,20 @@ do { \
                 (position_node)->parent->head = (node); \
             } \
             ++(position_node)->parent->count; \
+            GENERIC_LIST_STATS_JOIN_((position_node)->parent, 1, \
+                generic_stats_moved_); \
         } \
         (node)->parent = (position_node)->parent; \
+        GENERIC_LIST_TRACE_(LINK_BEFORE, (node), (node)->parent, \
+            (position_node)); \
+        GENERIC_LIST_CHECK_NODE_((node), "LINK_NODE_BEFORE"); \
+        if((node)->parent) { \
+            GENERIC_LIST_CHECK_LIST_((node)->parent, "LINK_NODE_BEFORE"); \
+            GENERIC_LIST_CHECK_WALK_((node)->parent, 1, "LINK_NODE_BEFORE"); \
+        } \
+    } \
+    else if((node) && (position_node) && ((node) != (position_node))) { \
+        GENERIC_LIST_STATS_SATURATED_((node)->parent); \
     } \
 } while(0) \
 MS_INLINE_PRAGMA(warning(pop))
@@ -373,6 +657,8 @@ do { \
     if((node) && (position_node) && ((node) != (position_node)) \
         && (!(node)->parent || ((node)->parent->count != (size_t)-1))) \
     { \
+        GENERIC_LIST_STATS_MOVED_DECL_((node), (position_node)->parent) \
+        GENERIC_LIST_CHECK_NODE_((position_node), "LINK_NODE_AFTER"); \
         UNLINK_NODE((node)); \
         (node)->next = (position_node)->next; \
         (node)->prev = (position_node); \
@@ -385,10 +671,357 @@ do { \
                 (position_node)->parent->tail = (node); \
             } \
             ++(position_node)->parent->count; \
+            GENERIC_LIST_STATS_JOIN_((position_node)->parent, 1, \
+                generic_stats_moved_); \
         } \
         (node)->parent = (position_node)->parent; \
+        GENERIC_LIST_TRACE_(LINK_AFTER, (node), (node)->parent, \
+            (position_node)); \
+        GENERIC_LIST_CHECK_NODE_((node), "LINK_NODE_AFTER"); \
+        if((node)->parent) { \
+            GENERIC_LIST_CHECK_LIST_((node)->parent, "LINK_NODE_AFTER"); \
+            GENERIC_LIST_CHECK_WALK_((node)->parent, 1, "LINK_NODE_AFTER"); \
+        } \
+    } \
+    else if((node) && (position_node) && ((node) != (position_node))) { \
+        GENERIC_LIST_STATS_SATURATED_((node)->parent); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* SPLICE_LIST_LAST
+Move all nodes from a list to the end of another list.
+
+The nodes of 'src_list' are stitched to the tail of 'list' in their current
+order and 'src_list' is left empty. Only the parent member of each moved node
+is written, the prev/next members of the moved nodes other than the first are
+not touched.
+
+If 'src_list' is 'list' or 'src_list' is empty then no action is taken.
+
+If the combined node count would exceed the maximum value of size_t then no
+action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list. For more info refer to the 'Important' section below the
+license comment block at the beginning of this header file.
+
+[in] 'list' : Pointer to a list.
+[in] 'src_list' : Pointer to a list.
+*/
+#define SPLICE_LIST_LAST(list, src_list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((list) && (src_list) && ((list) != (src_list)) && (src_list)->head \
+        && ((src_list)->count <= (size_t)-1 - (list)->count)) \
+    { \
+        GENERIC_LIST_TRACE_(SPLICE_LAST, (src_list)->head, (list), \
+            (src_list)); \
+        GENERIC_LIST_CHECK_LIST_((list), "SPLICE_LIST_LAST"); \
+        GENERIC_LIST_CHECK_LIST_((src_list), "SPLICE_LIST_LAST"); \
+        GENERIC_LIST_STATS_LEAVE_((src_list), (src_list)->count); \
+        if((list)->tail) { \
+            (list)->tail->next = (src_list)->head; \
+            (src_list)->head->prev = (list)->tail; \
+        } \
+        else { \
+            (list)->head = (src_list)->head; \
+        } \
+        (list)->tail = (src_list)->tail; \
+        (list)->count += (src_list)->count; \
+        GENERIC_LIST_STATS_JOIN_((list), (src_list)->count, 1); \
+        (src_list)->tail = NULL; \
+        (src_list)->count = 0; \
+        while((src_list)->head) { \
+            (src_list)->head->parent = (list); \
+            (src_list)->head = (src_list)->head->next; \
+        } \
+        GENERIC_LIST_CHECK_LIST_((list), "SPLICE_LIST_LAST"); \
+        GENERIC_LIST_CHECK_WALK_((list), 1, "SPLICE_LIST_LAST"); \
+    } \
+    else if((list) && (src_list) && ((list) != (src_list)) \
+        && (src_list)->head) \
+    { \
+        GENERIC_LIST_STATS_SATURATED_((list)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* STITCH_LIST_LAST
+Move all nodes from a list to the end of another list without adopting them.
+
+This is SPLICE_LIST_LAST in O(1): the chain of 'src_list' is stitched to the
+tail of 'list' and 'src_list' is left empty, but the parent member of the moved
+nodes is not written and still points to 'src_list'. Call ADOPT_LIST_NODES on
+'list' before passing any of the moved nodes to the other macros.
+
+If 'src_list' is 'list' or 'src_list' is empty then no action is taken.
+
+If the combined node count would exceed the maximum value of size_t then no
+action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list. For more info refer to the 'Important' section below the
+license comment block at the beginning of this header file.
+
+[in] 'list' : Pointer to a list.
+[in] 'src_list' : Pointer to a list.
+*/
+#define STITCH_LIST_LAST(list, src_list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((list) && (src_list) && ((list) != (src_list)) && (src_list)->head \
+        && ((src_list)->count <= (size_t)-1 - (list)->count)) \
+    { \
+        GENERIC_LIST_TRACE_(STITCH_LAST, (src_list)->head, (list), \
+            (src_list)); \
+        GENERIC_LIST_CHECK_LIST_((list), "STITCH_LIST_LAST"); \
+        GENERIC_LIST_CHECK_LIST_((src_list), "STITCH_LIST_LAST"); \
+        GENERIC_LIST_STATS_LEAVE_((src_list), (src_list)->count); \
+        if((list)->tail) { \
+            (list)->tail->next = (src_list)->head; \
+            (src_list)->head->prev = (list)->tail; \
+        } \
+        else { \
+            (list)->head = (src_list)->head; \
+        } \
+        (list)->tail = (src_list)->tail; \
+        (list)->count += (src_list)->count; \
+        GENERIC_LIST_STATS_JOIN_((list), (src_list)->count, 1); \
+        (src_list)->head = (src_list)->tail = NULL; \
+        (src_list)->count = 0; \
+        GENERIC_LIST_CHECK_LIST_((list), "STITCH_LIST_LAST"); \
+        GENERIC_LIST_CHECK_WALK_((list), 0, "STITCH_LIST_LAST"); \
+    } \
+    else if((list) && (src_list) && ((list) != (src_list)) \
+        && (src_list)->head) \
+    { \
+        GENERIC_LIST_STATS_SATURATED_((list)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* HIDE_NODE
+Detach a node from its neighbours and list but keep its own links.
+
+The node's neighbours and list are changed as if the node was unlinked, however
+the node's own prev, next and parent are left as they are so that RESTORE_NODE
+can put it back without any checks. This is the 'dancing links' removal used by
+backtracking searches.
+
+Hidden nodes must be restored in the reverse order they were hidden and the
+list must not be otherwise modified in between. A hidden node must not be
+passed to any macro other than RESTORE_NODE; to unlink it for good restore it
+first.
+
+If 'node' is not part of a list (node->parent == NULL) it is still detached
+from its neighbours.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list. For more info refer to the 'Important' section below the
+license comment block at the beginning of this header file.
+
+[in] 'node' : Pointer to a node.
+*/
+#define HIDE_NODE(node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node)) { \
+        GENERIC_LIST_TRACE_(HIDE, (node), (node)->parent, NULL); \
+        GENERIC_LIST_DETACH_((node), "HIDE_NODE"); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* GENERIC_LIST_DETACH_
+For internal use. The detach of HIDE_NODE without the trace record, for macros
+in other headers that detach a node as part of a different operation. 'name' is
+the macro name reported by the checks.
+*/
+#define GENERIC_LIST_DETACH_(node, name)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    GENERIC_LIST_CHECK_NODE_((node), name); \
+    if((node)->parent) { \
+        if((node)->parent->head == (node)) { \
+            (node)->parent->head = (node)->next; \
+        } \
+        if((node)->parent->tail == (node)) { \
+            (node)->parent->tail = (node)->prev; \
+        } \
+        --(node)->parent->count; \
+        GENERIC_LIST_STATS_LEAVE_((node)->parent, 1); \
+    } \
+    if((node)->prev) { \
+        (node)->prev->next = (node)->next; \
+    } \
+    if((node)->next) { \
+        (node)->next->prev = (node)->prev; \
+    } \
+    GENERIC_LIST_CHECK_HIDDEN_((node), name); \
+    if((node)->parent) { \
+        GENERIC_LIST_CHECK_LIST_((node)->parent, name); \
+        GENERIC_LIST_CHECK_WALK_((node)->parent, 1, name); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* RESTORE_NODE
+Reattach a node that was detached by HIDE_NODE.
+
+The node is put back between its saved prev and next, and if it was the head
+or tail of its list it is made the head or tail again.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list. For more info refer to the 'Important' section below the
+license comment block at the beginning of this header file.
+
+[in] 'node' : Pointer to a node that was hidden by HIDE_NODE.
+*/
+#define RESTORE_NODE(node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node)) { \
+        GENERIC_LIST_TRACE_(RESTORE, (node), (node)->parent, NULL); \
+        GENERIC_LIST_CHECK_HIDDEN_((node), "RESTORE_NODE"); \
+        if((node)->prev) { \
+            (node)->prev->next = (node); \
+        } \
+        if((node)->next) { \
+            (node)->next->prev = (node); \
+        } \
+        if((node)->parent) { \
+            if(!(node)->prev) { \
+                (node)->parent->head = (node); \
+            } \
+            if(!(node)->next) { \
+                (node)->parent->tail = (node); \
+            } \
+            ++(node)->parent->count; \
+            GENERIC_LIST_STATS_JOIN_((node)->parent, 1, 0); \
+        } \
+        GENERIC_LIST_CHECK_NODE_((node), "RESTORE_NODE"); \
+        if((node)->parent) { \
+            GENERIC_LIST_CHECK_LIST_((node)->parent, "RESTORE_NODE"); \
+            GENERIC_LIST_CHECK_WALK_((node)->parent, 1, "RESTORE_NODE"); \
+        } \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+/* ADOPT_LIST_NODES
+Set the parent of every node in a list to that list.
+
+Some operations move a chain of nodes to a list in O(1) by stitching the head,
+tail and count and leave the nodes' parent pointing to where they came from.
+Call this before passing any of those nodes to the other macros. The list is
+walked once, O(n), with its tail member as the cursor.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list. For more info refer to the 'Important' section below the
+license comment block at the beginning of this header file.
+
+[in] 'list' : Pointer to a list whose head, tail and count are correct.
+*/
+#define ADOPT_LIST_NODES(list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((list) && (list)->head) { \
+        GENERIC_LIST_TRACE_(ADOPT, (list)->head, (list), NULL); \
+        GENERIC_LIST_CHECK_LIST_((list), "ADOPT_LIST_NODES"); \
+        (list)->tail = (list)->head; \
+        for(;;) { \
+            (list)->tail->parent = (list); \
+            if(!(list)->tail->next) { \
+                break; \
+            } \
+            (list)->tail = (list)->tail->next; \
+        } \
+        GENERIC_LIST_CHECK_WALK_((list), 1, "ADOPT_LIST_NODES"); \
     } \
 } while(0) \
 MS_INLINE_PRAGMA(warning(pop))
 
+
+
+/* LIST_FOREACH
+Traverse a list from head to tail.
+
+Use it like a for statement. The node must not be unlinked or moved in the
+body, save its next node first and use a while loop for that. If
+GENERIC_LIST_STATS is defined each node visited is counted in the list's
+stats.visits.
+
+for example:
+LIST_FOREACH(node, list) {
+    printf("%s\n", node->name);
+}
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list. For more info refer to the 'Important' section below the
+license comment block at the beginning of this header file.
+
+[in] 'node' : Node pointer variable that is set to each node in turn.
+[in] 'list' : Pointer to a list.
+*/
+#define LIST_FOREACH(node, list)   \
+    for((node) = (list)->head; \
+        (node) && (GENERIC_LIST_STATS_VISIT_((list)), 1); \
+        (node) = (node)->next)
+
+
+/* LIST_STATS_SNAPSHOT
+Copy the operation statistics of a list.
+
+'snapshot' is a struct generic_list_stats that receives a copy of the list's
+counters. If GENERIC_LIST_STATS is not defined it receives zeroes, so code that
+reports statistics compiles either way.
+
+The counters are updated by the macros with plain increments, so a snapshot
+must be taken under the same lock as the changes to the list.
+
+[in] 'list' : Pointer to a list.
+[out] 'snapshot' : A struct generic_list_stats variable.
+*/
+#ifdef GENERIC_LIST_STATS
+#define LIST_STATS_SNAPSHOT(list, snapshot)   ((snapshot) = (list)->stats)
+#else
+#define LIST_STATS_SNAPSHOT(list, snapshot)   \
+    ((snapshot).links = (snapshot).unlinks = (snapshot).moves = \
+        (snapshot).saturated = (snapshot).max_count = (snapshot).visits = 0)
+#endif
+
+
+/* LIST_STATS_RESET
+Reset the operation statistics of a list.
+
+The counters are zeroed and the high-water mark is set to the current count.
+
+[in] 'list' : Pointer to a list.
+*/
+#ifdef GENERIC_LIST_STATS
+#define LIST_STATS_RESET(list)   \
+    (GENERIC_LIST_STATS_ZERO_((list)), \
+        (list)->stats.max_count = (list)->count)
+#else
+#define LIST_STATS_RESET(list)   ((void)0)
+#endif
+
 #endif /* GENERIC_LIST_H_ */
@@ -0,0 +1,199 @@
+/* Generic helper macros for a self-organizing find by key.
+*/
+#ifndef GENERIC_LIST_FIND_H_
+#define GENERIC_LIST_FIND_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Generic helper macros for a self-organizing find by key.
+
+LIST_FIND scans a list from the head for the first node that matches a key.
+After a hit it applies a policy that reorders the list so that frequently found
+nodes move towards the head, which shortens later scans when the accesses are
+skewed:
+
+NONE : The list is not changed.
+MOVE_TO_FRONT : The found node is moved to the head with LINK_NODE_FIRST.
+TRANSPOSE : The found node is swapped with the node before it.
+COUNT : The found node's find_count is incremented and the node is moved
+        before every node with a lower count, keeping the list ordered by
+        count. The node struct needs a size_t find_count member.
+
+Each policy moves the node with one LINK_NODE_ macro, so the move is checked,
+traced and counted like any other.
+
+Move-to-front adapts fastest to a change in the hot keys, transpose moves a
+node one step per hit so a single lookup of a cold key doesn't disturb the
+order, and count converges on the frequency order for a stable distribution.
+
+The policy is a token that is pasted onto LIST_FIND_POLICY_, so you can add
+your own by defining LIST_FIND_POLICY_<name>(node, list).
+
+LIST_FIND
+Find the first node that matches a key and apply a policy.
+
+LIST_FIND_PREFETCH
+Hint that a node will be read soon.
+
+---
+Important:
+
+The same rules as generic_list.h apply. The input parameters for the macros are
+evaluated multiple times because they are generic function-like macros. The
+parameters must not have side effects or access the list.
+
+A find changes the list unless the policy is NONE, so concurrent finds need the
+same lock as any other change to the list.
+
+TRANSPOSE and COUNT declare a node pointer temporary with __typeof__ in C,
+refer to LIST_FIND_TYPEOF_.
+*/
+
+#include "generic_list.h"
+
+
+/* LIST_FIND_PREFETCH
+Hint that a node will be read soon.
+
+A prefetch never faults so 'node' may be NULL. It is a no-op on compilers
+without a prefetch intrinsic.
+
+[in] 'node' : Pointer to a node.
+*/
+#ifndef LIST_FIND_PREFETCH
+#if defined(__GNUC__) || defined(__clang__)
+#define LIST_FIND_PREFETCH(node)   __builtin_prefetch((node), 0, 3)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#define LIST_FIND_PREFETCH(node)   \
+    _mm_prefetch((const char *)(node), _MM_HINT_T0)
+#else
+#define LIST_FIND_PREFETCH(node)   ((void)0)
+#endif
+#endif
+
+
+/* LIST_FIND_TYPEOF_
+For internal use. The type of an expression, for the node pointer temporaries.
+
+decltype in C++. In C it is __typeof__, which GCC, Clang and Visual Studio 2022
+17.9 or later support.
+*/
+#ifdef __cplusplus
+#define LIST_FIND_TYPEOF_(expr)   decltype(expr)
+#else
+#define LIST_FIND_TYPEOF_(expr)   __typeof__(expr)
+#endif
+
+
+/* The policies. Each is called with the found node, which is never NULL. */
+
+#define LIST_FIND_POLICY_NONE(node, list)   ((void)0)
+
+#define LIST_FIND_POLICY_MOVE_TO_FRONT(node, list)   \
+    LINK_NODE_FIRST((node), (list))
+
+/* The position is saved first because it is the node's prev, which changes
+when the node is unlinked. */
+#define LIST_FIND_POLICY_TRANSPOSE(node, list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node)->prev) { \
+        LIST_FIND_TYPEOF_((node)->prev) generic_find_pos_ = (node)->prev; \
+        LINK_NODE_BEFORE((node), generic_find_pos_); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+/* The nodes before the found node that have a lower count are walked to find
+the position and the node is moved once, with LINK_NODE_BEFORE. */
+#define LIST_FIND_POLICY_COUNT(node, list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node)->find_count != (size_t)-1) { \
+        ++(node)->find_count; \
+    } \
+    if((node)->prev && ((node)->prev->find_count < (node)->find_count)) { \
+        LIST_FIND_TYPEOF_((node)->prev) generic_find_pos_ = (node)->prev; \
+        while(generic_find_pos_->prev \
+            && (generic_find_pos_->prev->find_count < (node)->find_count)) \
+        { \
+            generic_find_pos_ = generic_find_pos_->prev; \
+        } \
+        LINK_NODE_BEFORE((node), generic_find_pos_); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* LIST_FIND
+Find the first node that matches a key and apply a policy.
+
+'cmp' is called as cmp(node, key) for each node from the head until it
+returns 0, like strcmp. It can be a function or a function-like macro. The
+next node is prefetched before each comparison so its cache miss overlaps the
+comparison. Each node compared counts as a visit in the list's statistics if
+GENERIC_LIST_STATS is defined.
+
+If no node matches then 'node' is set to NULL and the list is not changed.
+
+for example:
+#define NAME_CMP(node, key)   strcmp((node)->name, (key))
+LIST_FIND(list, "foo", NAME_CMP, MOVE_TO_FRONT, node);
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'list' : Pointer to a list.
+[in] 'key' : The key passed to cmp.
+[in] 'cmp' : Comparison function or macro.
+[in] 'policy' : NONE, MOVE_TO_FRONT, TRANSPOSE, COUNT or your own policy.
+[out] 'node' : Node pointer variable that receives the found node or NULL.
+*/
+#define LIST_FIND(list, key, cmp, policy, node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    (node) = (list) ? (list)->head : NULL; \
+    for(; (node); (node) = (node)->next) { \
+        LIST_FIND_PREFETCH((node)->next); \
+        GENERIC_LIST_STATS_VISIT_((list)); \
+        if(!cmp((node), (key))) { \
+            break; \
+        } \
+    } \
+    if((node)) { \
+        LIST_FIND_POLICY_##policy((node), (list)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+#endif /* GENERIC_LIST_FIND_H_ */
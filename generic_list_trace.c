@@ -0,0 +1,154 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Per-thread ring buffer trace of the generic_list.h macros. Documentation is
+in generic_list_trace.h.
+*/
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "generic_list_trace.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if (LIST_TRACE_SIZE & (LIST_TRACE_SIZE - 1)) || !LIST_TRACE_SIZE
+#error "LIST_TRACE_SIZE must be a power of 2."
+#endif
+
+#if (LIST_TRACE_STAMP_EVERY & (LIST_TRACE_STAMP_EVERY - 1)) \
+    || !LIST_TRACE_STAMP_EVERY
+#error "LIST_TRACE_STAMP_EVERY must be a power of 2."
+#endif
+
+LIST_TRACE_THREAD_LOCAL_ struct list_trace_ring *list_trace_ring_;
+
+/* all rings ever registered, and the spinlock that protects the chain */
+static struct list_trace_ring *rings;
+static long rings_lock;
+static unsigned ring_count;
+
+
+struct list_trace_ring *list_trace_ring_create_(void) {
+    struct list_trace_ring *ring;
+
+    ring = (struct list_trace_ring *)calloc(1, sizeof(*ring));
+    if(!ring) {
+        return NULL;
+    }
+    GENERIC_SPINLOCK_ACQUIRE(rings_lock);
+    ring->thread = ring_count++;
+    ring->next_ring = rings;
+    rings = ring;
+    GENERIC_SPINLOCK_RELEASE(rings_lock);
+    list_trace_ring_ = ring;
+    return ring;
+}
+
+
+unsigned long long list_trace_clock(void) {
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (unsigned long long)((double)counter.QuadPart * 1e9
+        / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL
+        + (unsigned long long)ts.tv_nsec;
+#endif
+}
+
+
+/* The record as it is saved, 48 bytes with no padding. */
+struct saved_entry {
+    unsigned long long timestamp;
+    unsigned long long sequence;
+    unsigned long long node;
+    unsigned long long list;
+    unsigned long long position;
+    unsigned int op;
+    unsigned int thread;
+};
+
+int list_trace_save(const char *filename) {
+    struct list_trace_ring *ring;
+    FILE *file;
+    unsigned long long stamp_every = LIST_TRACE_STAMP_EVERY;
+    int result = 0;
+
+    if(!filename) {
+        return -1;
+    }
+    file = fopen(filename, "wb");
+    if(!file) {
+        return -1;
+    }
+    if(fwrite("GLTRACE3", 8, 1, file) != 1
+        || fwrite(&stamp_every, sizeof(stamp_every), 1, file) != 1)
+    {
+        result = -1;
+    }
+
+    GENERIC_SPINLOCK_ACQUIRE(rings_lock);
+    for(ring = rings; ring && !result; ring = ring->next_ring) {
+        size_t next = GENERIC_ATOMIC_LOAD_SIZE_ACQUIRE(ring->next);
+        size_t i = (next > LIST_TRACE_SIZE) ? next - LIST_TRACE_SIZE : 0;
+        for(; i < next; ++i) {
+            const struct list_trace_entry *entry =
+                &ring->entries[i & (LIST_TRACE_SIZE - 1)];
+            struct saved_entry saved;
+            saved.timestamp = entry->timestamp;
+            saved.sequence = (unsigned long long)i;
+            saved.node = (unsigned long long)(size_t)entry->node;
+            saved.list = (unsigned long long)(size_t)entry->list;
+            saved.position = (unsigned long long)(size_t)entry->position;
+            saved.op = entry->op;
+            saved.thread = ring->thread;
+            if(fwrite(&saved, sizeof(saved), 1, file) != 1) {
+                result = -1;
+                break;
+            }
+        }
+    }
+    GENERIC_SPINLOCK_RELEASE(rings_lock);
+
+    if(fclose(file)) {
+        result = -1;
+    }
+    return result;
+}
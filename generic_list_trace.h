@@ -0,0 +1,243 @@
+/* Per-thread ring buffer trace of the generic_list.h macros.
+*/
+#ifndef GENERIC_LIST_TRACE_H_
+#define GENERIC_LIST_TRACE_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Per-thread ring buffer trace of the generic_list.h macros.
+
+Define GENERIC_LIST_TRACE before including generic_list.h, in every file that
+uses the macros, and compile generic_list_trace.c with your program. Every
+UNLINK_NODE, LINK_NODE_*, SPLICE_LIST_LAST, STITCH_LIST_LAST, HIDE_NODE,
+RESTORE_NODE and ADOPT_LIST_NODES that takes action then appends a record to a
+ring buffer of the calling thread: a timestamp, the operation, the node, the
+list and the position node. When GENERIC_LIST_TRACE is not defined the hook
+expands to nothing.
+
+A record is six stores to memory owned by the thread: the timestamp, the three
+pointers, the op and the ring's new end. No lock or atomic read-modify-write is
+taken, and the clock is read only once every LIST_TRACE_STAMP_EVERY records.
+A thread's ring is allocated and registered on its first record and is kept
+after the thread exits so its history can still be saved. Only the last
+LIST_TRACE_SIZE records of each thread are kept.
+
+Overhead: the target is 2% and it is not met for the cheapest macros. In
+benchmark/list_trace.c, random LINK_NODE_LAST, LINK_NODE_BEFORE and UNLINK_NODE
+on 1000 nodes take a median 23.5 ns per operation untraced and 29.5 ns traced
+with the defaults, about 25% (best runs 20.2 and 23.0 ns, 14%), on a one CPU
+VM. An operation writes one record, or two when it moves a linked node, and
+nearly all of the cost is the stores of the record; without the timestamp it
+was 28.0 ns. A clock read on every record (LIST_TRACE_STAMP_EVERY 1) makes it
+55.5 ns, 136%, because rdtsc is trapped on that VM. The share is smaller for
+macros that do more work per record, like SPLICE_LIST_LAST and the walks.
+
+The records of the macros that move a whole list (SPLICE_LIST_LAST and
+STITCH_LIST_LAST) hold the first moved node as the node and the source list as
+the position. A macro that unlinks a node before linking it, like LINK_NODE_*
+for a node that is part of a list, records the unlink and then the link. An
+UNLINK_NODE of a node that is not linked to anything is not recorded.
+
+list_trace_record
+Append a record to the calling thread's ring.
+
+list_trace_save
+Save the rings of all threads to a file.
+
+The saved file is decoded by tools/list_trace_dump.c, which prints the records
+of all threads merged by time, each thread's in sequence, and can filter them
+by node or list address.
+
+---
+Important:
+
+LIST_TRACE_SIZE, LIST_TRACE_STAMP_EVERY and LIST_TRACE_CLOCK must be the same
+in every file, including generic_list_trace.c.
+
+Save the trace when the other threads are stopped or not using the lists, for
+example from an error handler, otherwise the newest records of a thread may be
+saved half written.
+
+The timestamp of a record is the clock at the last record of its thread whose
+sequence number is a multiple of LIST_TRACE_STAMP_EVERY, so it can be up to
+that many records old. Each record is also saved with its sequence number in
+its thread, which orders the records of a thread exactly. Define
+LIST_TRACE_STAMP_EVERY to 1 for a clock read on every record. Define
+LIST_TRACE_CLOCK() to an expression of type unsigned long long to use another
+clock than LIST_TRACE_TSC(), for example list_trace_clock() for nanoseconds of
+a monotonic clock; on a command line that can be
+-DLIST_TRACE_CLOCK=list_trace_clock. Like LIST_TRACE_SIZE both must be the
+same in every file.
+*/
+
+#include "generic_atomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The number of records kept per thread, a power of 2. */
+#ifndef LIST_TRACE_SIZE
+#define LIST_TRACE_SIZE   4096
+#endif
+
+/* The number of records per clock read, a power of 2. */
+#ifndef LIST_TRACE_STAMP_EVERY
+#define LIST_TRACE_STAMP_EVERY   64
+#endif
+
+#if defined(_MSC_VER)
+#define LIST_TRACE_THREAD_LOCAL_   __declspec(thread)
+#define LIST_TRACE_INLINE_   static __inline
+#elif defined(__GNUC__) || defined(__clang__)
+#define LIST_TRACE_THREAD_LOCAL_   __thread
+#define LIST_TRACE_INLINE_   static __inline__
+#else
+#define LIST_TRACE_THREAD_LOCAL_   _Thread_local
+#define LIST_TRACE_INLINE_   static inline
+#endif
+
+/* The CPU time stamp counter on x86, otherwise list_trace_clock(). */
+#if (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__i386__) || defined(__x86_64__))
+#define LIST_TRACE_TSC()   ((unsigned long long)__builtin_ia32_rdtsc())
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define LIST_TRACE_TSC()   ((unsigned long long)__rdtsc())
+#else
+#define LIST_TRACE_TSC()   list_trace_clock()
+#endif
+
+#ifndef LIST_TRACE_CLOCK
+#define LIST_TRACE_CLOCK()   LIST_TRACE_TSC()
+#endif
+
+/* The operations. */
+enum list_trace_op {
+    LIST_TRACE_UNLINK = 1,
+    LIST_TRACE_LINK_FIRST,
+    LIST_TRACE_LINK_LAST,
+    LIST_TRACE_LINK_BEFORE,
+    LIST_TRACE_LINK_AFTER,
+    LIST_TRACE_SPLICE_LAST,
+    LIST_TRACE_STITCH_LAST,
+    LIST_TRACE_HIDE,
+    LIST_TRACE_RESTORE,
+    LIST_TRACE_ADOPT
+};
+
+struct list_trace_entry {
+    unsigned long long timestamp;
+    const void *node;
+    const void *list;
+    const void *position;
+    unsigned op;
+};
+
+struct list_trace_ring {
+    /* the number of records ever appended, the next index modulo the size */
+    size_t next;
+    /* the clock at the last record whose number is a multiple of
+    LIST_TRACE_STAMP_EVERY */
+    unsigned long long stamp;
+    unsigned thread;
+    struct list_trace_ring *next_ring;
+    struct list_trace_entry entries[LIST_TRACE_SIZE];
+};
+
+/* For internal use. The calling thread's ring or NULL before its first
+record. */
+extern LIST_TRACE_THREAD_LOCAL_ struct list_trace_ring *list_trace_ring_;
+
+/* For internal use. Allocate and register the calling thread's ring. Returns
+NULL if out of memory, and then the thread's records are dropped. */
+struct list_trace_ring *list_trace_ring_create_(void);
+
+/* list_trace_clock
+Nanoseconds of a monotonic clock.
+*/
+unsigned long long list_trace_clock(void);
+
+
+/* list_trace_record
+Append a record to the calling thread's ring.
+
+This is called by the macros in generic_list.h when GENERIC_LIST_TRACE is
+defined. You can call it for your own operations with an op that is greater
+than LIST_TRACE_ADOPT.
+
+[in] 'op' : The operation.
+[in] 'node' : The node or NULL.
+[in] 'list' : The list or NULL.
+[in] 'position' : The position node, source list or NULL.
+*/
+LIST_TRACE_INLINE_ void list_trace_record(unsigned op, const void *node,
+    const void *list, const void *position)
+{
+    struct list_trace_ring *ring = list_trace_ring_;
+    struct list_trace_entry *entry;
+    if(!ring) {
+        ring = list_trace_ring_create_();
+        if(!ring) {
+            return;
+        }
+    }
+    entry = &ring->entries[ring->next & (LIST_TRACE_SIZE - 1)];
+    if(!(ring->next & (LIST_TRACE_STAMP_EVERY - 1))) {
+        ring->stamp = LIST_TRACE_CLOCK();
+    }
+    entry->timestamp = ring->stamp;
+    entry->node = node;
+    entry->list = list;
+    entry->position = position;
+    entry->op = op;
+    GENERIC_ATOMIC_STORE_SIZE_RELEASE(ring->next, ring->next + 1);
+}
+
+
+/* list_trace_save
+Save the rings of all threads to a file.
+
+The file starts with the 8 bytes "GLTRACE3" and LIST_TRACE_STAMP_EVERY as an
+unsigned 64-bit integer. It is followed by a 48 byte record for each entry,
+oldest first per thread: timestamp, sequence number, node, list and position
+as unsigned 64-bit integers, then op and thread index as unsigned 32-bit
+integers, all in the machine's byte order. The sequence number is the record's
+number in its thread, counted from 0 at the thread's first record.
+
+[in] 'filename' : The name of the file to create or overwrite.
+
+Returns 0 on success or -1 on failure.
+*/
+int list_trace_save(const char *filename);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GENERIC_LIST_TRACE_H_ */
@@ -0,0 +1,238 @@
+/* Generic helper macros for a lock-free multi-producer single-consumer queue.
+*/
+#ifndef GENERIC_MPSC_QUEUE_H_
+#define GENERIC_MPSC_QUEUE_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Generic helper macros for a lock-free multi-producer single-consumer queue.
+
+This is an intrusive queue in the style of Dmitry Vyukov's MPSC node queue. It
+links nodes through the 'next' member of a generic_list node. A producer pushes
+with one atomic exchange of the queue's tail and a release store to the old
+tail's next, no lock is taken. The single consumer pops from the head without
+any atomic read-modify-write.
+
+DECLARE_MPSC_QUEUE_MEMBERS
+Declare the queue members (head, tail, stub, pop_next, drain_node).
+
+INIT_MPSC_QUEUE_MEMBERS
+Initialize the queue members to an empty queue.
+
+MPSC_QUEUE_PUSH
+Push a node to the tail of the queue. Safe to call from any thread.
+
+MPSC_QUEUE_POP
+Pop a node from the head of the queue. Consumer thread only.
+
+MPSC_QUEUE_DRAIN
+Pop all available nodes and link them to the end of a list. Consumer thread
+only.
+
+---
+Important:
+
+The same rules as generic_list.h apply. The input parameters for the macros are
+evaluated multiple times because they are generic function-like macros. The
+parameters must not have side effects or access the list or queue.
+
+A node that is pushed must not be part of a list (node->parent == NULL). While
+it is in the queue its 'next' member is the queue link and its 'prev' member is
+where the producer keeps the previous tail, so the generic_list macros must not
+be called on it. A popped node has its 'prev' and 'next' members reset to NULL
+and can be linked to a list.
+
+---
+Other:
+
+The queue struct holds a stub node so your node struct must be defined before
+your queue struct. The stub node is never returned by MPSC_QUEUE_POP.
+
+A pop that finds a producer between its exchange and its store to next returns
+NULL even though the queue is not empty. The consumer will find the node on a
+later pop once the producer finishes its push. This is the only way the queue
+is not linearizable and it is why producers are never blocked.
+
+Requires generic_atomic.h, which is included by this header.
+*/
+
+#include "generic_list.h"
+#include "generic_atomic.h"
+
+
+/* DECLARE_MPSC_QUEUE_MEMBERS
+Declare the queue members (head, tail, stub, pop_next, drain_node).
+
+Use this declaration in your queue struct.
+
+This macro adds the following members:
+head : For the consumer. The next node to pop, or the stub node.
+tail : For producers. The last node pushed, or the stub node.
+stub : For internal use. A node that keeps the queue from being empty.
+pop_next, drain_node : For internal use by the consumer.
+
+[in] 'node_tag' : Tag name of your node struct.
+*/
+#define DECLARE_MPSC_QUEUE_MEMBERS(node_tag)   \
+    struct node_tag *head, *tail; \
+    struct node_tag stub; \
+    struct node_tag *pop_next, *drain_node
+
+
+/* INIT_MPSC_QUEUE_MEMBERS
+Initialize the queue members to an empty queue.
+
+Zeroing the queue struct is not enough, this must be called before the queue
+is used. It must not be called while any other thread is using the queue.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the queue.
+
+[in] 'queue' : Pointer to a queue.
+*/
+#define INIT_MPSC_QUEUE_MEMBERS(queue)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((queue)) { \
+        ZERO_OUT_NODE_MEMBERS(&(queue)->stub); \
+        (queue)->head = (queue)->tail = &(queue)->stub; \
+        (queue)->pop_next = (queue)->drain_node = NULL; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* MPSC_QUEUE_PUSH
+Push a node to the tail of the queue. Safe to call from any thread.
+
+This is wait-free: one atomic exchange and one release store. The previous
+tail returned by the exchange is kept in node->prev, which the producer owns
+until the release store publishes the node.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the queue.
+
+[in] 'queue' : Pointer to a queue.
+[in] 'node' : Pointer to a node that is not part of a list or queue.
+*/
+#define MPSC_QUEUE_PUSH(queue, node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((queue) && (node)) { \
+        (node)->next = NULL; \
+        (node)->prev = GENERIC_ATOMIC_EXCHANGE((queue)->tail, (node)); \
+        GENERIC_ATOMIC_STORE_RELEASE((node)->prev->next, (node)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* MPSC_QUEUE_POP
+Pop a node from the head of the queue. Consumer thread only.
+
+'node' is set to the popped node, or NULL if there is no node available. The
+popped node's prev and next members are reset to NULL.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the queue.
+
+[in] 'queue' : Pointer to a queue.
+[out] 'node' : Node pointer variable that receives the popped node.
+*/
+#define MPSC_QUEUE_POP(queue, node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    (node) = NULL; \
+    if((queue)) { \
+        (queue)->pop_next = GENERIC_ATOMIC_LOAD_ACQUIRE((queue)->head->next); \
+        if(((queue)->head == &(queue)->stub) && (queue)->pop_next) { \
+            (queue)->head = (queue)->pop_next; \
+            (queue)->pop_next = \
+                GENERIC_ATOMIC_LOAD_ACQUIRE((queue)->head->next); \
+        } \
+        if((queue)->head != &(queue)->stub) { \
+            if(!(queue)->pop_next \
+                && (GENERIC_ATOMIC_LOAD_ACQUIRE((queue)->tail) \
+                    == (queue)->head)) \
+            { \
+                MPSC_QUEUE_PUSH((queue), &(queue)->stub); \
+                (queue)->pop_next = \
+                    GENERIC_ATOMIC_LOAD_ACQUIRE((queue)->head->next); \
+            } \
+            if((queue)->pop_next) { \
+                (node) = (queue)->head; \
+                (queue)->head = (queue)->pop_next; \
+                (node)->prev = (node)->next = NULL; \
+            } \
+        } \
+        (queue)->pop_next = NULL; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* MPSC_QUEUE_DRAIN
+Pop all available nodes and link them to the end of a list. Consumer thread
+only.
+
+Nodes are popped until MPSC_QUEUE_POP returns NULL and each is linked with
+LINK_NODE_LAST, so 'list' has correct prev/parent/count for the drained nodes.
+If 'list' has a node count equal to the maximum value of size_t then draining
+stops and the remaining nodes are left in the queue.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list or queue.
+
+[in] 'queue' : Pointer to a queue.
+[in] 'list' : Pointer to a list.
+*/
+#define MPSC_QUEUE_DRAIN(queue, list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((queue) && (list)) { \
+        while((list)->count != (size_t)-1) { \
+            MPSC_QUEUE_POP((queue), (queue)->drain_node); \
+            if(!(queue)->drain_node) { \
+                break; \
+            } \
+            LINK_NODE_LAST((queue)->drain_node, (list)); \
+        } \
+        (queue)->drain_node = NULL; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+#endif /* GENERIC_MPSC_QUEUE_H_ */
@@ -0,0 +1,91 @@
+/* Mutex and condition variable wrappers for the blocking generic_list code.
+*/
+#ifndef GENERIC_MUTEX_H_
+#define GENERIC_MUTEX_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Mutex and condition variable wrappers for the blocking generic_list code.
+
+These are for internal use by generic_work_queue.h and generic_parallel.c, so
+that both block the same way. They are pthreads on Unix and a slim
+reader/writer lock and condition variables (Windows Vista or later) on Windows.
+'m' and 'c' are lvalues of GENERIC_MUTEX_T_ and GENERIC_COND_T_, not pointers.
+
+GENERIC_MUTEX_T_
+The mutex type.
+
+GENERIC_COND_T_
+The condition variable type.
+
+GENERIC_MUTEX_INIT_, GENERIC_MUTEX_DESTROY_
+Initialize or destroy a mutex.
+
+GENERIC_MUTEX_LOCK_, GENERIC_MUTEX_UNLOCK_
+Lock or unlock a mutex.
+
+GENERIC_COND_INIT_, GENERIC_COND_DESTROY_
+Initialize or destroy a condition variable.
+
+GENERIC_COND_WAIT_
+Unlock a mutex, wait for a condition variable to be signaled and lock it again.
+
+GENERIC_COND_SIGNAL_, GENERIC_COND_BROADCAST_
+Wake one or every thread waiting on a condition variable.
+*/
+
+#ifdef _WIN32
+#include <windows.h>
+#define GENERIC_MUTEX_T_   SRWLOCK
+#define GENERIC_COND_T_   CONDITION_VARIABLE
+#define GENERIC_MUTEX_INIT_(m)   InitializeSRWLock(&(m))
+#define GENERIC_MUTEX_DESTROY_(m)   ((void)0)
+#define GENERIC_MUTEX_LOCK_(m)   AcquireSRWLockExclusive(&(m))
+#define GENERIC_MUTEX_UNLOCK_(m)   ReleaseSRWLockExclusive(&(m))
+#define GENERIC_COND_INIT_(c)   InitializeConditionVariable(&(c))
+#define GENERIC_COND_DESTROY_(c)   ((void)0)
+#define GENERIC_COND_WAIT_(c, m)   \
+    SleepConditionVariableSRW(&(c), &(m), INFINITE, 0)
+#define GENERIC_COND_SIGNAL_(c)   WakeConditionVariable(&(c))
+#define GENERIC_COND_BROADCAST_(c)   WakeAllConditionVariable(&(c))
+#else
+#include <pthread.h>
+#define GENERIC_MUTEX_T_   pthread_mutex_t
+#define GENERIC_COND_T_   pthread_cond_t
+#define GENERIC_MUTEX_INIT_(m)   pthread_mutex_init(&(m), NULL)
+#define GENERIC_MUTEX_DESTROY_(m)   pthread_mutex_destroy(&(m))
+#define GENERIC_MUTEX_LOCK_(m)   pthread_mutex_lock(&(m))
+#define GENERIC_MUTEX_UNLOCK_(m)   pthread_mutex_unlock(&(m))
+#define GENERIC_COND_INIT_(c)   pthread_cond_init(&(c), NULL)
+#define GENERIC_COND_DESTROY_(c)   pthread_cond_destroy(&(c))
+#define GENERIC_COND_WAIT_(c, m)   pthread_cond_wait(&(c), &(m))
+#define GENERIC_COND_SIGNAL_(c)   pthread_cond_signal(&(c))
+#define GENERIC_COND_BROADCAST_(c)   pthread_cond_broadcast(&(c))
+#endif
+
+#endif /* GENERIC_MUTEX_H_ */
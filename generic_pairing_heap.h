@@ -0,0 +1,500 @@
+/* Generic helper macros for an intrusive pairing heap.
+*/
+#ifndef GENERIC_PAIRING_HEAP_H_
+#define GENERIC_PAIRING_HEAP_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Generic helper macros for an intrusive pairing heap.
+
+The heap reuses the generic_list node members so that a node can move between
+a list and a heap without any other bookkeeping:
+
+prev : The previous sibling, or the parent node if the node is a first child.
+next : The next sibling.
+parent : Pointer to the heap.
+
+Only one member is added to the node, 'child', the node's first child.
+
+The heap struct is a list struct with a few extra members. Its 'head' is the
+root of the heap and its 'count' is the number of nodes in the heap. Its 'tail'
+is not used and is always NULL. Because the heap struct is a list struct the
+same struct type can be used for both your lists and your heaps.
+
+DECLARE_PAIRING_HEAP_NODE_MEMBERS
+Declare the heap node members (prev, next, parent, child).
+
+DECLARE_PAIRING_HEAP_MEMBERS
+Declare the heap members (head, tail, count, and internal members).
+
+ZERO_OUT_PAIRING_HEAP_NODE_MEMBERS
+Zero out the heap node members (prev, next, parent, child).
+
+ZERO_OUT_PAIRING_HEAP_MEMBERS
+Zero out the heap members (head, tail, count, and internal members).
+
+PAIRING_HEAP_MIN
+The node that orders first in the heap. NULL if none.
+
+PAIRING_HEAP_INSERT
+Link a node to a heap.
+
+PAIRING_HEAP_DELETE_MIN
+Unlink the node that orders first from a heap.
+
+PAIRING_HEAP_DECREASE_KEY
+Reposition a node in a heap after its key has been decreased.
+
+PAIRING_HEAP_REMOVE
+Unlink a node from a heap.
+
+PAIRING_HEAP_MELD
+Move all nodes from a heap to another heap.
+
+---
+Important:
+
+The same rules as generic_list.h apply. The input parameters for the macros are
+evaluated multiple times because they are generic function-like macros. The
+parameters must not have side effects or access the list or heap.
+
+The generic_list macros must not be called on a node that is part of a heap or
+on a heap. To move a node from a heap to a list call PAIRING_HEAP_REMOVE first.
+PAIRING_HEAP_INSERT unlinks a node from its list before linking it to the heap.
+
+---
+Other:
+
+The 'less' parameter of the macros is the name of a function or function-like
+macro that takes two node pointers and returns nonzero if the first node orders
+before the second. For a min heap of an integer 'key' member for example:
+
+#define my_node_less(a, b)   ((a)->key < (b)->key)
+
+'less' is called with the heap's internal members as arguments, so if it is a
+function-like macro it may evaluate its parameters multiple times.
+*/
+
+#include "generic_list.h"
+
+
+/* DECLARE_PAIRING_HEAP_NODE_MEMBERS
+Declare the heap node members (prev, next, parent, child).
+
+Use this declaration in your node struct instead of DECLARE_NODE_MEMBERS.
+
+This macro adds the following members:
+prev, next, parent : Refer to DECLARE_NODE_MEMBERS in generic_list.h.
+child : Pointer to the first child node in the heap. NULL if none.
+
+[in] 'node_tag' : Tag name of your node struct.
+[in] 'list_tag' : Tag name of your list/heap struct.
+*/
+#define DECLARE_PAIRING_HEAP_NODE_MEMBERS(node_tag, list_tag)   \
+    DECLARE_NODE_MEMBERS(node_tag, list_tag); \
+    struct node_tag *child
+
+
+/* DECLARE_PAIRING_HEAP_MEMBERS
+Declare the heap members (head, tail, count, and internal members).
+
+Use this declaration in your list/heap struct instead of DECLARE_LIST_MEMBERS.
+
+This macro adds the following members:
+head, tail, count : Refer to DECLARE_LIST_MEMBERS in generic_list.h.
+meld_a, meld_b, combine_next, combine_rest : For internal use.
+
+[in] 'node_tag' : Tag name of your node struct.
+*/
+#define DECLARE_PAIRING_HEAP_MEMBERS(node_tag)   \
+    DECLARE_LIST_MEMBERS(node_tag); \
+    struct node_tag *meld_a, *meld_b, *combine_next, *combine_rest
+
+
+/* ZERO_OUT_PAIRING_HEAP_NODE_MEMBERS
+Zero out the heap node members (prev, next, parent, child).
+
+[in] 'node' : Pointer to a node.
+*/
+#define ZERO_OUT_PAIRING_HEAP_NODE_MEMBERS(node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node)) { \
+        ZERO_OUT_NODE_MEMBERS((node)); \
+        (node)->child = NULL; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* ZERO_OUT_PAIRING_HEAP_MEMBERS
+Zero out the heap members (head, tail, count, and internal members).
+
+[in] 'heap' : Pointer to a heap.
+*/
+#define ZERO_OUT_PAIRING_HEAP_MEMBERS(heap)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((heap)) { \
+        ZERO_OUT_LIST_MEMBERS((heap)); \
+        (heap)->meld_a = (heap)->meld_b = NULL; \
+        (heap)->combine_next = (heap)->combine_rest = NULL; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* PAIRING_HEAP_MIN
+The node that orders first in the heap. NULL if none.
+
+[in] 'heap' : Pointer to a heap.
+*/
+#define PAIRING_HEAP_MIN(heap)   ((heap)->head)
+
+
+/* PAIRING_HEAP_ADOPT_
+For internal use. Make root node 'node' the first child of root node 'parent'.
+*/
+#define PAIRING_HEAP_ADOPT_(parent_node, node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    (node)->next = (parent_node)->child; \
+    if((parent_node)->child) { \
+        (parent_node)->child->prev = (node); \
+    } \
+    (node)->prev = (parent_node); \
+    (parent_node)->child = (node); \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* PAIRING_HEAP_MELD_
+For internal use. Meld the trees rooted at heap->meld_a and heap->meld_b and
+store the root of the result in heap->meld_a. Either may be NULL. The prev/next
+members of the resulting root are not reset.
+*/
+#define PAIRING_HEAP_MELD_(heap, less)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if(!(heap)->meld_a) { \
+        (heap)->meld_a = (heap)->meld_b; \
+    } \
+    else if((heap)->meld_b) { \
+        if(less((heap)->meld_b, (heap)->meld_a)) { \
+            PAIRING_HEAP_ADOPT_((heap)->meld_b, (heap)->meld_a); \
+            (heap)->meld_a = (heap)->meld_b; \
+        } \
+        else { \
+            PAIRING_HEAP_ADOPT_((heap)->meld_a, (heap)->meld_b); \
+        } \
+    } \
+    (heap)->meld_b = NULL; \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* PAIRING_HEAP_COMBINE_
+For internal use. Combine the sibling trees starting at heap->combine_next
+into one tree using the two-pass pairing method and store its root in
+heap->meld_a. The root's prev/next members are reset.
+*/
+#define PAIRING_HEAP_COMBINE_(heap, less)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    (heap)->combine_rest = NULL; \
+    while((heap)->combine_next) { \
+        (heap)->meld_a = (heap)->combine_next; \
+        (heap)->meld_b = (heap)->meld_a->next; \
+        (heap)->combine_next = \
+            (heap)->meld_b ? (heap)->meld_b->next : NULL; \
+        PAIRING_HEAP_MELD_((heap), less); \
+        (heap)->meld_a->next = (heap)->combine_rest; \
+        (heap)->combine_rest = (heap)->meld_a; \
+    } \
+    (heap)->meld_a = NULL; \
+    while((heap)->combine_rest) { \
+        (heap)->meld_b = (heap)->combine_rest; \
+        (heap)->combine_rest = (heap)->combine_rest->next; \
+        PAIRING_HEAP_MELD_((heap), less); \
+    } \
+    if((heap)->meld_a) { \
+        (heap)->meld_a->prev = (heap)->meld_a->next = NULL; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* PAIRING_HEAP_DETACH_
+For internal use. Cut the subtree rooted at non-root node 'node' from its
+parent and siblings.
+*/
+#define PAIRING_HEAP_DETACH_(node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node)->prev->child == (node)) { \
+        (node)->prev->child = (node)->next; \
+    } \
+    else { \
+        (node)->prev->next = (node)->next; \
+    } \
+    if((node)->next) { \
+        (node)->next->prev = (node)->prev; \
+    } \
+    (node)->prev = (node)->next = NULL; \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* PAIRING_HEAP_INSERT
+Link a node to a heap.
+
+If 'node' is already part of 'heap' then no action is taken. If 'node' is part
+of a list it is unlinked from that list before being linked to 'heap'. 'node'
+must not be part of another heap.
+
+If 'heap' has a node count equal to the maximum value of size_t then no action
+is taken. If 'node' is part of a list it is not unlinked.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list or heap.
+
+[in] 'heap' : Pointer to a heap.
+[in] 'node' : Pointer to a node.
+[in] 'less' : Name of the ordering function or function-like macro.
+*/
+#define PAIRING_HEAP_INSERT(heap, node, less)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((heap) && (node) && ((node)->parent != (heap)) \
+        && ((heap)->count != (size_t)-1)) \
+    { \
+        GENERIC_LIST_STATS_MOVED_DECL_((node), (heap)) \
+        UNLINK_NODE((node)); \
+        (node)->child = NULL; \
+        (node)->parent = (heap); \
+        ++(heap)->count; \
+        GENERIC_LIST_STATS_JOIN_((heap), 1, generic_stats_moved_); \
+        (heap)->meld_a = (heap)->head; \
+        (heap)->meld_b = (node); \
+        PAIRING_HEAP_MELD_((heap), less); \
+        (heap)->head = (heap)->meld_a; \
+        (heap)->meld_a = NULL; \
+    } \
+    else if((heap) && (node) && ((node)->parent != (heap))) { \
+        GENERIC_LIST_STATS_SATURATED_((heap)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* PAIRING_HEAP_DELETE_MIN
+Unlink the node that orders first from a heap.
+
+The unlinked node is the node that was PAIRING_HEAP_MIN before the call. Its
+prev, next, parent and child members are NULL after the call.
+
+If 'heap' is empty then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list or heap.
+
+[in] 'heap' : Pointer to a heap.
+[in] 'less' : Name of the ordering function or function-like macro.
+*/
+#define PAIRING_HEAP_DELETE_MIN(heap, less)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((heap) && (heap)->head) { \
+        (heap)->combine_next = (heap)->head->child; \
+        (heap)->head->child = NULL; \
+        (heap)->head->parent = NULL; \
+        --(heap)->count; \
+        GENERIC_LIST_STATS_LEAVE_((heap), 1); \
+        PAIRING_HEAP_COMBINE_((heap), less); \
+        (heap)->head = (heap)->meld_a; \
+        (heap)->meld_a = NULL; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* PAIRING_HEAP_DECREASE_KEY
+Reposition a node in a heap after its key has been decreased.
+
+Call this after changing 'node' so that it orders before, or the same as, its
+previous position. The subtree rooted at 'node' is cut and melded with the
+root, which is O(1).
+
+If 'node' is not part of 'heap' or is the root of 'heap' then no action is
+taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list or heap.
+
+[in] 'heap' : Pointer to a heap.
+[in] 'node' : Pointer to a node.
+[in] 'less' : Name of the ordering function or function-like macro.
+*/
+#define PAIRING_HEAP_DECREASE_KEY(heap, node, less)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((heap) && (node) && ((node)->parent == (heap)) \
+        && ((node) != (heap)->head)) \
+    { \
+        PAIRING_HEAP_DETACH_((node)); \
+        (heap)->meld_a = (heap)->head; \
+        (heap)->meld_b = (node); \
+        PAIRING_HEAP_MELD_((heap), less); \
+        (heap)->head = (heap)->meld_a; \
+        (heap)->meld_a = NULL; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* PAIRING_HEAP_REMOVE
+Unlink a node from a heap.
+
+'node' may be any node in the heap. Its prev, next, parent and child members
+are NULL after the call.
+
+If 'node' is not part of 'heap' then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list or heap.
+
+[in] 'heap' : Pointer to a heap.
+[in] 'node' : Pointer to a node.
+[in] 'less' : Name of the ordering function or function-like macro.
+*/
+#define PAIRING_HEAP_REMOVE(heap, node, less)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((heap) && (node) && ((node)->parent == (heap))) { \
+        if((node) == (heap)->head) { \
+            PAIRING_HEAP_DELETE_MIN((heap), less); \
+        } \
+        else { \
+            PAIRING_HEAP_DETACH_((node)); \
+            (heap)->combine_next = (node)->child; \
+            (node)->child = NULL; \
+            (node)->parent = NULL; \
+            --(heap)->count; \
+            GENERIC_LIST_STATS_LEAVE_((heap), 1); \
+            PAIRING_HEAP_COMBINE_((heap), less); \
+            (heap)->meld_b = (heap)->head; \
+            PAIRING_HEAP_MELD_((heap), less); \
+            (heap)->head = (heap)->meld_a; \
+            (heap)->meld_a = NULL; \
+        } \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* PAIRING_HEAP_MELD
+Move all nodes from a heap to another heap.
+
+The roots are melded in O(1), however the parent member of every node in
+'src_heap' must be changed to 'heap' so like SPLICE_LIST_LAST this is O(n) in
+the number of nodes in 'src_heap'. 'src_heap' is left empty.
+
+If 'src_heap' is 'heap' or 'src_heap' is empty then no action is taken.
+
+If the combined node count would exceed the maximum value of size_t then no
+action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list or heap.
+
+[in] 'heap' : Pointer to a heap.
+[in] 'src_heap' : Pointer to a heap.
+[in] 'less' : Name of the ordering function or function-like macro.
+*/
+#define PAIRING_HEAP_MELD(heap, src_heap, less)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((heap) && (src_heap) && ((heap) != (src_heap)) && (src_heap)->head \
+        && ((src_heap)->count <= (size_t)-1 - (heap)->count)) \
+    { \
+        (heap)->combine_next = (src_heap)->head; \
+        while((heap)->combine_next) { \
+            (heap)->combine_next->parent = (heap); \
+            if((heap)->combine_next->child) { \
+                (heap)->combine_next = (heap)->combine_next->child; \
+                continue; \
+            } \
+            while((heap)->combine_next && !(heap)->combine_next->next) { \
+                while((heap)->combine_next->prev \
+                    && ((heap)->combine_next->prev->child \
+                        != (heap)->combine_next)) \
+                { \
+                    (heap)->combine_next = (heap)->combine_next->prev; \
+                } \
+                (heap)->combine_next = (heap)->combine_next->prev; \
+            } \
+            if((heap)->combine_next) { \
+                (heap)->combine_next = (heap)->combine_next->next; \
+            } \
+        } \
+        (heap)->meld_a = (heap)->head; \
+        (heap)->meld_b = (src_heap)->head; \
+        PAIRING_HEAP_MELD_((heap), less); \
+        (heap)->head = (heap)->meld_a; \
+        (heap)->meld_a = NULL; \
+        (heap)->count += (src_heap)->count; \
+        GENERIC_LIST_STATS_LEAVE_((src_heap), (src_heap)->count); \
+        GENERIC_LIST_STATS_JOIN_((heap), (src_heap)->count, 1); \
+        (src_heap)->head = NULL; \
+        (src_heap)->count = 0; \
+    } \
+    else if((heap) && (src_heap) && ((heap) != (src_heap)) \
+        && (src_heap)->head) \
+    { \
+        GENERIC_LIST_STATS_SATURATED_((heap)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+#endif /* GENERIC_PAIRING_HEAP_H_ */
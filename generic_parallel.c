@@ -0,0 +1,293 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Thread pool for parallel processing of an anchored list's segments.
+Documentation is in generic_parallel.h.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "generic_parallel.h"
+#include "generic_atomic.h"
+#include "generic_mutex.h"
+
+#ifdef _WIN32
+#define PARALLEL_THREAD_T_   HANDLE
+#else
+#define PARALLEL_THREAD_T_   pthread_t
+#endif
+
+
+struct parallel_task {
+    char *first;
+    size_t count;
+};
+
+struct parallel_pool {
+    unsigned threads;
+    PARALLEL_THREAD_T_ *ids;
+    GENERIC_MUTEX_T_ mutex;
+    /* signaled when a new foreach starts or the pool is stopping */
+    GENERIC_COND_T_ start;
+    /* signaled when the workers are done or a foreach has finished */
+    GENERIC_COND_T_ done;
+    unsigned long generation;
+    int stop;
+    int running;
+    unsigned busy;
+
+    /* the current foreach */
+    struct parallel_task *tasks;
+    size_t task_count;
+    size_t task_capacity;
+    GENERIC_CACHE_ALIGN size_t next_task;
+    size_t next_offset;
+    void (*func)(void *node, void *arg);
+    void *arg;
+};
+
+
+/* Read the pointer member at 'offset' in 'node'. */
+static char *ReadPointer(const char *node, size_t offset) {
+    void *ptr;
+    memcpy(&ptr, node + offset, sizeof(ptr));
+    return (char *)ptr;
+}
+
+/* Visit 'count' nodes starting at 'node'. */
+static void RunSegment(char *node, size_t count, size_t next_offset,
+    void (*func)(void *node, void *arg), void *arg)
+{
+    for(; count; --count) {
+        char *next = ReadPointer(node, next_offset);
+        func(node, arg);
+        node = next;
+    }
+}
+
+/* Take tasks of the current foreach until there are none left. */
+static void RunTasks(struct parallel_pool *pool) {
+    size_t i;
+    while((i = GENERIC_ATOMIC_ADD_SIZE(pool->next_task, 1))
+        < pool->task_count)
+    {
+        RunSegment(pool->tasks[i].first, pool->tasks[i].count,
+            pool->next_offset, pool->func, pool->arg);
+    }
+}
+
+static void WorkerLoop(struct parallel_pool *pool) {
+    unsigned long seen = 0;
+    GENERIC_MUTEX_LOCK_(pool->mutex);
+    for(;;) {
+        while(pool->generation == seen && !pool->stop) {
+            GENERIC_COND_WAIT_(pool->start, pool->mutex);
+        }
+        if(pool->stop) {
+            break;
+        }
+        seen = pool->generation;
+        GENERIC_MUTEX_UNLOCK_(pool->mutex);
+        RunTasks(pool);
+        GENERIC_MUTEX_LOCK_(pool->mutex);
+        if(!--pool->busy) {
+            GENERIC_COND_BROADCAST_(pool->done);
+        }
+    }
+    GENERIC_MUTEX_UNLOCK_(pool->mutex);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI Worker(LPVOID param) {
+    WorkerLoop((struct parallel_pool *)param);
+    return 0;
+}
+#else
+static void *Worker(void *param) {
+    WorkerLoop((struct parallel_pool *)param);
+    return NULL;
+}
+#endif
+
+/* Stop and join the first 'count' worker threads. */
+static void StopWorkers(struct parallel_pool *pool, unsigned count) {
+    unsigned t;
+    GENERIC_MUTEX_LOCK_(pool->mutex);
+    pool->stop = 1;
+    GENERIC_COND_BROADCAST_(pool->start);
+    GENERIC_MUTEX_UNLOCK_(pool->mutex);
+    for(t = 0; t < count; ++t) {
+#ifdef _WIN32
+        WaitForSingleObject(pool->ids[t], INFINITE);
+        CloseHandle(pool->ids[t]);
+#else
+        pthread_join(pool->ids[t], NULL);
+#endif
+    }
+}
+
+
+struct parallel_pool *parallel_pool_create(unsigned threads) {
+    unsigned t;
+    struct parallel_pool *pool;
+
+    pool = (struct parallel_pool *)calloc(1, sizeof(*pool));
+    if(!pool) {
+        return NULL;
+    }
+    if(threads) {
+        pool->ids = (PARALLEL_THREAD_T_ *)calloc(threads, sizeof(*pool->ids));
+        if(!pool->ids) {
+            free(pool);
+            return NULL;
+        }
+    }
+    GENERIC_MUTEX_INIT_(pool->mutex);
+    GENERIC_COND_INIT_(pool->start);
+    GENERIC_COND_INIT_(pool->done);
+    for(t = 0; t < threads; ++t) {
+#ifdef _WIN32
+        pool->ids[t] = CreateThread(NULL, 0, Worker, pool, 0, NULL);
+        if(!pool->ids[t])
+#else
+        if(pthread_create(&pool->ids[t], NULL, Worker, pool))
+#endif
+        {
+            StopWorkers(pool, t);
+            GENERIC_COND_DESTROY_(pool->done);
+            GENERIC_COND_DESTROY_(pool->start);
+            GENERIC_MUTEX_DESTROY_(pool->mutex);
+            free(pool->ids);
+            free(pool);
+            return NULL;
+        }
+    }
+    pool->threads = threads;
+    return pool;
+}
+
+
+void parallel_pool_destroy(struct parallel_pool *pool) {
+    if(!pool) {
+        return;
+    }
+    StopWorkers(pool, pool->threads);
+    GENERIC_COND_DESTROY_(pool->done);
+    GENERIC_COND_DESTROY_(pool->start);
+    GENERIC_MUTEX_DESTROY_(pool->mutex);
+    free(pool->tasks);
+    free(pool->ids);
+    free(pool);
+}
+
+
+void parallel_pool_foreach_segments(struct parallel_pool *pool,
+    void *first_anchor, size_t next_offset, size_t seg_first_offset,
+    size_t seg_count_offset, size_t seg_next_offset,
+    void (*func)(void *node, void *arg), void *arg)
+{
+    char *anchor;
+    size_t count;
+
+    if(!func) {
+        return;
+    }
+    if(pool) {
+        GENERIC_MUTEX_LOCK_(pool->mutex);
+        while(pool->running) {
+            GENERIC_COND_WAIT_(pool->done, pool->mutex);
+        }
+        pool->running = 1;
+        GENERIC_MUTEX_UNLOCK_(pool->mutex);
+
+        pool->task_count = 0;
+        for(anchor = (char *)first_anchor; anchor;
+            anchor = ReadPointer(anchor, seg_next_offset))
+        {
+            if(pool->task_count == pool->task_capacity) {
+                size_t capacity = pool->task_capacity ?
+                    pool->task_capacity * 2 : 64;
+                struct parallel_task *tasks = NULL;
+                if(capacity <= (size_t)-1 / sizeof(*tasks)) {
+                    tasks = (struct parallel_task *)
+                        realloc(pool->tasks, capacity * sizeof(*tasks));
+                }
+                if(!tasks) {
+                    free(pool->tasks);
+                    pool->tasks = NULL;
+                    pool->task_capacity = 0;
+                    break;
+                }
+                pool->tasks = tasks;
+                pool->task_capacity = capacity;
+            }
+            memcpy(&count, anchor + seg_count_offset, sizeof(count));
+            pool->tasks[pool->task_count].first =
+                ReadPointer(anchor, seg_first_offset);
+            pool->tasks[pool->task_count].count = count;
+            ++pool->task_count;
+        }
+
+        if(pool->tasks) {
+            pool->next_offset = next_offset;
+            pool->func = func;
+            pool->arg = arg;
+            GENERIC_MUTEX_LOCK_(pool->mutex);
+            pool->next_task = 0;
+            pool->busy = pool->threads;
+            ++pool->generation;
+            GENERIC_COND_BROADCAST_(pool->start);
+            GENERIC_MUTEX_UNLOCK_(pool->mutex);
+
+            RunTasks(pool);
+
+            GENERIC_MUTEX_LOCK_(pool->mutex);
+            while(pool->busy) {
+                GENERIC_COND_WAIT_(pool->done, pool->mutex);
+            }
+            pool->running = 0;
+            GENERIC_COND_BROADCAST_(pool->done);
+            GENERIC_MUTEX_UNLOCK_(pool->mutex);
+            return;
+        }
+
+        GENERIC_MUTEX_LOCK_(pool->mutex);
+        pool->running = 0;
+        GENERIC_COND_BROADCAST_(pool->done);
+        GENERIC_MUTEX_UNLOCK_(pool->mutex);
+    }
+
+    /* no pool or no memory for the tasks, visit every node serially */
+    for(anchor = (char *)first_anchor; anchor;
+        anchor = ReadPointer(anchor, seg_next_offset))
+    {
+        memcpy(&count, anchor + seg_count_offset, sizeof(count));
+        RunSegment(ReadPointer(anchor, seg_first_offset), count, next_offset,
+            func, arg);
+    }
+}
@@ -0,0 +1,168 @@
+/* Thread pool for parallel processing of an anchored list's segments.
+*/
+#ifndef GENERIC_PARALLEL_H_
+#define GENERIC_PARALLEL_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Thread pool for parallel processing of an anchored list's segments.
+
+This module is self-contained: compile generic_parallel.c with your program.
+It is used with generic_anchored_list.h, whose index of segment anchors lets a
+list be handed out in pieces without first walking it.
+
+LIST_PARALLEL_FOREACH walks the index, which is O(count/k), and the calling
+thread and the pool's worker threads then take segments from it one at a time
+until there are none left, calling a function for every node. Segments are
+taken with an atomic increment so threads that finish early take more of them.
+The call returns when every node has been visited.
+
+parallel_pool_create
+Create a thread pool.
+
+parallel_pool_destroy
+Stop the worker threads and free a thread pool.
+
+parallel_pool_foreach_segments
+Call a function for every node of a chain of segments, in parallel.
+
+LIST_PARALLEL_FOREACH
+Call a function for every node of an anchored list, in parallel.
+
+---
+Important:
+
+The list must not be changed while LIST_PARALLEL_FOREACH is running. The
+function is called concurrently from several threads and in no particular node
+order, so it must only read the list members of the nodes and any state it
+writes must be per node or synchronized.
+
+A pool runs one foreach at a time. Concurrent calls on the same pool are
+serialized.
+*/
+
+#include <stddef.h>
+
+#include "generic_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct parallel_pool;
+
+
+/* parallel_pool_create
+Create a thread pool.
+
+[in] 'threads' : The number of worker threads, in addition to the thread that
+calls the foreach. 0 is allowed, the caller then does all the work.
+
+Returns a pointer to the pool or NULL on failure.
+*/
+struct parallel_pool *parallel_pool_create(unsigned threads);
+
+
+/* parallel_pool_destroy
+Stop the worker threads and free a thread pool.
+
+[in] 'pool' : Pointer to a pool or NULL.
+*/
+void parallel_pool_destroy(struct parallel_pool *pool);
+
+
+/* parallel_pool_foreach_segments
+Call a function for every node of a chain of segments, in parallel.
+
+This is the function behind LIST_PARALLEL_FOREACH, which computes the member
+offsets for you. The segment records are found from 'first_anchor' by the node
+member at 'seg_next_offset', and each segment is walked for the count at
+'seg_count_offset' from the node at 'seg_first_offset' by the member at
+'next_offset'.
+
+If 'pool' is NULL or the pool can't allocate its task array then the calling
+thread visits every node itself.
+
+[in] 'pool' : Pointer to a pool or NULL.
+[in] 'first_anchor' : Pointer to the anchor of the first segment or NULL.
+[in] 'next_offset' : Offset of the 'next' member in a node.
+[in] 'seg_first_offset' : Offset of the 'seg_first' member in a node.
+[in] 'seg_count_offset' : Offset of the 'seg_count' member in a node.
+[in] 'seg_next_offset' : Offset of the 'seg_next' member in a node.
+[in] 'func' : Function called with each node and 'arg'.
+[in] 'arg' : Pointer passed to func.
+*/
+void parallel_pool_foreach_segments(struct parallel_pool *pool,
+    void *first_anchor, size_t next_offset, size_t seg_first_offset,
+    size_t seg_count_offset, size_t seg_next_offset,
+    void (*func)(void *node, void *arg), void *arg);
+
+
+/* PARALLEL_MEMBER_OFFSET_
+For internal use. The offset of a member in the struct that 'ptr' points to.
+*/
+#define PARALLEL_MEMBER_OFFSET_(ptr, member)   \
+    ((size_t)((char *)&(ptr)->member - (char *)(ptr)))
+
+
+/* LIST_PARALLEL_FOREACH
+Call a function for every node of an anchored list, in parallel.
+
+'func' is called with a pointer to each node, as void *, and 'arg'. The calling
+thread works too and the macro returns when every node has been visited. If
+'list' is empty or NULL then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'list' : Pointer to a list from generic_anchored_list.h.
+[in] 'pool' : Pointer to a pool or NULL to visit the nodes serially.
+[in] 'func' : Function of type void (*)(void *node, void *arg).
+[in] 'arg' : Pointer passed to func.
+*/
+#define LIST_PARALLEL_FOREACH(list, pool, func, arg)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((list) && (list)->first_anchor) { \
+        parallel_pool_foreach_segments((pool), (list)->first_anchor, \
+            PARALLEL_MEMBER_OFFSET_((list)->first_anchor, next), \
+            PARALLEL_MEMBER_OFFSET_((list)->first_anchor, seg_first), \
+            PARALLEL_MEMBER_OFFSET_((list)->first_anchor, seg_count), \
+            PARALLEL_MEMBER_OFFSET_((list)->first_anchor, seg_next), \
+            (func), (arg)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GENERIC_PARALLEL_H_ */
@@ -0,0 +1,394 @@
+/* Generic helper macros for a read-mostly list with lock-free readers.
+*/
+#ifndef GENERIC_RCU_LIST_H_
+#define GENERIC_RCU_LIST_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Generic helper macros for a read-mostly list with lock-free readers.
+
+The list and node structs are ordinary generic_list structs. Writers link and
+unlink with the RCU_ macros below while holding a writer lock of your choice,
+and readers traverse forward with RCU_LIST_FOREACH without any lock. A node is
+fully initialized before a release store to a 'next' or 'head' member makes it
+reachable, and readers follow those members with acquire loads.
+
+An unlinked node keeps its 'next' member so that a reader that is on it can
+still continue to the rest of the list. It must not be freed or linked again
+until every reader that could have seen it is gone. Retire it with epoch_retire
+from generic_epoch.h, and bracket each traversal with epoch_enter/epoch_exit.
+
+RCU_LINK_NODE_FIRST
+Link a new node to a list and position it as the head node.
+
+RCU_LINK_NODE_LAST
+Link a new node to a list and position it as the tail node.
+
+RCU_LINK_NODE_BEFORE
+Link a new node to a list and position it before another node in the list.
+
+RCU_LINK_NODE_AFTER
+Link a new node to a list and position it after another node in the list.
+
+RCU_UNLINK_NODE
+Unlink a node from its list, leaving readers that are on it a way forward.
+
+RCU_REPLACE_NODE
+Replace a node in its list with a new node in one step for readers.
+
+RCU_LIST_FIRST
+Read the head of a list in a reader.
+
+RCU_NODE_NEXT
+Read the next node in a reader.
+
+RCU_LIST_FOREACH
+Traverse a list in a reader.
+
+---
+Important:
+
+The same rules as generic_list.h apply. The input parameters for the macros are
+evaluated multiple times because they are generic function-like macros. The
+parameters must not have side effects or access the list.
+
+Writers must be serialized with each other. Readers must only use 'head' and
+'next'; 'prev', 'tail', 'parent' and 'count' are for writers.
+
+The node passed to the RCU_LINK_ macros must not be part of a list and must not
+be reachable by any reader: either newly allocated, or unlinked and then passed
+through a grace period. To update a node, copy it, change the copy and replace
+the node with it. Linking the copy and unlinking the node in two steps would
+let a reader that is between them see both.
+
+The ordinary generic_list macros must not be used on a list that has readers.
+*/
+
+#include "generic_list.h"
+#include "generic_atomic.h"
+
+
+/* RCU_LINK_NODE_FIRST
+Link a new node to a list and position it as the head node.
+
+Writers only. If 'list' has a node count equal to the maximum value of size_t
+then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'node' : Pointer to a node that is not part of a list.
+[in] 'list' : Pointer to a list.
+*/
+#define RCU_LINK_NODE_FIRST(node, list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node) && (list) && !(node)->parent \
+        && ((list)->count != (size_t)-1)) \
+    { \
+        (node)->next = (list)->head; \
+        (node)->prev = NULL; \
+        (node)->parent = (list); \
+        if(!(list)->tail) { \
+            (list)->tail = (node); \
+        } \
+        if((list)->head) { \
+            (list)->head->prev = (node); \
+        } \
+        GENERIC_ATOMIC_STORE_RELEASE((list)->head, (node)); \
+        ++(list)->count; \
+        GENERIC_LIST_STATS_JOIN_((list), 1, 0); \
+    } \
+    else if((node) && (list) && !(node)->parent \
+        && ((list)->count == (size_t)-1)) \
+    { \
+        GENERIC_LIST_STATS_SATURATED_((list)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* RCU_LINK_NODE_LAST
+Link a new node to a list and position it as the tail node.
+
+Writers only. If 'list' has a node count equal to the maximum value of size_t
+then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'node' : Pointer to a node that is not part of a list.
+[in] 'list' : Pointer to a list.
+*/
+#define RCU_LINK_NODE_LAST(node, list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node) && (list) && !(node)->parent \
+        && ((list)->count != (size_t)-1)) \
+    { \
+        (node)->next = NULL; \
+        (node)->prev = (list)->tail; \
+        (node)->parent = (list); \
+        if((list)->tail) { \
+            GENERIC_ATOMIC_STORE_RELEASE((list)->tail->next, (node)); \
+        } \
+        else { \
+            GENERIC_ATOMIC_STORE_RELEASE((list)->head, (node)); \
+        } \
+        (list)->tail = (node); \
+        ++(list)->count; \
+        GENERIC_LIST_STATS_JOIN_((list), 1, 0); \
+    } \
+    else if((node) && (list) && !(node)->parent \
+        && ((list)->count == (size_t)-1)) \
+    { \
+        GENERIC_LIST_STATS_SATURATED_((list)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* RCU_LINK_NODE_BEFORE
+Link a new node to a list and position it before another node in the list.
+
+Writers only. If 'position_node' is not part of a list or is part of a list
+that has a node count equal to the maximum value of size_t then no action is
+taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'node' : Pointer to a node that is not part of a list.
+[in] 'position_node' : Pointer to a node that's part of a list.
+*/
+#define RCU_LINK_NODE_BEFORE(node, position_node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node) && (position_node) && !(node)->parent \
+        && (position_node)->parent \
+        && ((position_node)->parent->count != (size_t)-1)) \
+    { \
+        (node)->next = (position_node); \
+        (node)->prev = (position_node)->prev; \
+        (node)->parent = (position_node)->parent; \
+        if((position_node)->prev) { \
+            GENERIC_ATOMIC_STORE_RELEASE((position_node)->prev->next, \
+                (node)); \
+        } \
+        else { \
+            GENERIC_ATOMIC_STORE_RELEASE((position_node)->parent->head, \
+                (node)); \
+        } \
+        (position_node)->prev = (node); \
+        ++(position_node)->parent->count; \
+        GENERIC_LIST_STATS_JOIN_((position_node)->parent, 1, 0); \
+    } \
+    else if((node) && (position_node) && !(node)->parent \
+        && (position_node)->parent) \
+    { \
+        GENERIC_LIST_STATS_SATURATED_((position_node)->parent); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* RCU_LINK_NODE_AFTER
+Link a new node to a list and position it after another node in the list.
+
+Writers only. If 'position_node' is not part of a list or is part of a list
+that has a node count equal to the maximum value of size_t then no action is
+taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'node' : Pointer to a node that is not part of a list.
+[in] 'position_node' : Pointer to a node that's part of a list.
+*/
+#define RCU_LINK_NODE_AFTER(node, position_node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node) && (position_node) && !(node)->parent \
+        && (position_node)->parent \
+        && ((position_node)->parent->count != (size_t)-1)) \
+    { \
+        (node)->next = (position_node)->next; \
+        (node)->prev = (position_node); \
+        (node)->parent = (position_node)->parent; \
+        if((position_node)->next) { \
+            (position_node)->next->prev = (node); \
+        } \
+        else { \
+            (position_node)->parent->tail = (node); \
+        } \
+        GENERIC_ATOMIC_STORE_RELEASE((position_node)->next, (node)); \
+        ++(position_node)->parent->count; \
+        GENERIC_LIST_STATS_JOIN_((position_node)->parent, 1, 0); \
+    } \
+    else if((node) && (position_node) && !(node)->parent \
+        && (position_node)->parent) \
+    { \
+        GENERIC_LIST_STATS_SATURATED_((position_node)->parent); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* RCU_UNLINK_NODE
+Unlink a node from its list, leaving readers that are on it a way forward.
+
+Writers only. The node's parent and prev are set to NULL but its next is left
+as it is, so a reader that is on the node continues to the node that followed
+it. Retire the node with epoch_retire rather than freeing it.
+
+If 'node' is not part of a list then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'node' : Pointer to a node.
+*/
+#define RCU_UNLINK_NODE(node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node) && (node)->parent) { \
+        if((node)->prev) { \
+            GENERIC_ATOMIC_STORE_RELEASE((node)->prev->next, (node)->next); \
+        } \
+        else { \
+            GENERIC_ATOMIC_STORE_RELEASE((node)->parent->head, (node)->next); \
+        } \
+        if((node)->next) { \
+            (node)->next->prev = (node)->prev; \
+        } \
+        else { \
+            (node)->parent->tail = (node)->prev; \
+        } \
+        --(node)->parent->count; \
+        GENERIC_LIST_STATS_LEAVE_((node)->parent, 1); \
+        (node)->parent = NULL; \
+        (node)->prev = NULL; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* RCU_REPLACE_NODE
+Replace a node in its list with a new node in one step for readers.
+
+Writers only. 'node' takes the position of 'old_node', and a reader sees either
+'old_node' or 'node' but never both. 'old_node' is unlinked the same way as by
+RCU_UNLINK_NODE: its next is left as it is and it must be retired rather than
+freed. The list's count is unchanged, and with GENERIC_LIST_STATS it counts as
+an unlink and a link.
+
+If 'old_node' is not part of a list or 'node' is part of a list then no action
+is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'old_node' : Pointer to a node that's part of a list.
+[in] 'node' : Pointer to a node that is not part of a list.
+*/
+#define RCU_REPLACE_NODE(old_node, node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((old_node) && (node) && (old_node)->parent && !(node)->parent) { \
+        (node)->next = (old_node)->next; \
+        (node)->prev = (old_node)->prev; \
+        (node)->parent = (old_node)->parent; \
+        if((old_node)->prev) { \
+            GENERIC_ATOMIC_STORE_RELEASE((old_node)->prev->next, (node)); \
+        } \
+        else { \
+            GENERIC_ATOMIC_STORE_RELEASE((old_node)->parent->head, (node)); \
+        } \
+        if((old_node)->next) { \
+            (old_node)->next->prev = (node); \
+        } \
+        else { \
+            (old_node)->parent->tail = (node); \
+        } \
+        GENERIC_LIST_STATS_LEAVE_((old_node)->parent, 1); \
+        GENERIC_LIST_STATS_JOIN_((old_node)->parent, 1, 0); \
+        (old_node)->parent = NULL; \
+        (old_node)->prev = NULL; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* RCU_LIST_FIRST
+Read the head of a list in a reader.
+
+[in] 'list' : Pointer to a list.
+*/
+#define RCU_LIST_FIRST(list)   GENERIC_ATOMIC_LOAD_ACQUIRE((list)->head)
+
+
+/* RCU_NODE_NEXT
+Read the next node in a reader.
+
+[in] 'node' : Pointer to a node.
+*/
+#define RCU_NODE_NEXT(node)   GENERIC_ATOMIC_LOAD_ACQUIRE((node)->next)
+
+
+/* RCU_LIST_FOREACH
+Traverse a list in a reader.
+
+Use it like a for statement. The traversal must be inside an epoch critical
+section (epoch_enter/epoch_exit) if nodes are retired with generic_epoch.h.
+
+for example:
+RCU_LIST_FOREACH(node, list) {
+    printf("%s\n", node->name);
+}
+
+[in] 'node' : Node pointer variable that is set to each node in turn.
+[in] 'list' : Pointer to a list.
+*/
+#define RCU_LIST_FOREACH(node, list)   \
+    for((node) = RCU_LIST_FIRST((list)); \
+        (node); \
+        (node) = RCU_NODE_NEXT((node)))
+
+#endif /* GENERIC_RCU_LIST_H_ */
@@ -0,0 +1,308 @@
+/* Generic helper macros for a bitmap-indexed priority run queue.
+*/
+#ifndef GENERIC_RUN_QUEUE_H_
+#define GENERIC_RUN_QUEUE_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Generic helper macros for a bitmap-indexed priority run queue.
+
+The run queue has RUN_QUEUE_LEVELS priority levels and each level is a
+generic_list list. A bitmap has a bit for each level that is set while the
+level is not empty, so the highest non-empty level is found with a
+find-last-set on at most RUN_QUEUE_WORDS words instead of a scan of the levels.
+This is the structure of an O(1) scheduler.
+
+Enqueueing a node is a LINK_NODE_LAST to its level and removing a node is an
+UNLINK_NODE through its parent pointer, both O(1). A node's level is found from
+its parent pointer as well, so requeueing a node at another level is also O(1)
+and the node needs no members other than the generic_list ones. Nodes of the
+same level are dequeued in the order they were enqueued.
+
+DECLARE_RUN_QUEUE_MEMBERS
+Declare the run queue members (levels, bitmap).
+
+ZERO_OUT_RUN_QUEUE_MEMBERS
+Zero out the run queue members (levels, bitmap).
+
+RUN_QUEUE_LEVEL
+The level of a node in the run queue.
+
+RUN_QUEUE_ENQUEUE
+Link a node to the end of a level, moving it from its current level if any.
+
+RUN_QUEUE_REMOVE
+Unlink a node from its level.
+
+RUN_QUEUE_PEEK
+Get the first node of the highest non-empty level.
+
+RUN_QUEUE_POP
+Get and unlink the first node of the highest non-empty level.
+
+---
+Important:
+
+The same rules as generic_list.h apply. The input parameters for the macros are
+evaluated multiple times because they are generic function-like macros. The
+parameters must not have side effects or access the list.
+
+---
+Other:
+
+Level 0 is the lowest priority and RUN_QUEUE_LEVELS - 1 the highest.
+
+A node passed to the macros must be in one of the run queue's levels or in no
+list at all, because its parent pointer is taken to be one of the levels. To
+move a node from another list to the run queue unlink it first.
+
+The levels are ordinary lists. They can be read, for example with
+LIST_FOREACH, but must only be changed by the run queue macros so that the
+bitmap stays in step.
+*/
+
+#include "generic_list.h"
+
+/* The number of priority levels, any number from 1. The bitmap is made of
+64-bit words so a multiple of 64 wastes nothing. */
+#ifndef RUN_QUEUE_LEVELS
+#define RUN_QUEUE_LEVELS   64
+#endif
+
+/* The number of 64-bit words in the bitmap. */
+#define RUN_QUEUE_WORDS   ((RUN_QUEUE_LEVELS + 63) / 64)
+
+#if defined(_MSC_VER)
+#define RUN_QUEUE_INLINE_   static __inline
+#elif defined(__GNUC__) || defined(__clang__)
+#define RUN_QUEUE_INLINE_   static __inline__
+#else
+#define RUN_QUEUE_INLINE_   static inline
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+
+/* run_queue_highest_
+For internal use. Return the highest level whose bit is set in 'bitmap', or -1
+if none is.
+
+The words are searched from the top and the highest set bit of the first
+non-zero word is found with a count-leading-zeros instruction where the
+compiler has one, otherwise with a binary search of the word.
+*/
+RUN_QUEUE_INLINE_ int run_queue_highest_(const unsigned long long *bitmap)
+{
+    int word;
+    for(word = RUN_QUEUE_WORDS - 1; word >= 0; --word) {
+        unsigned long long bits = bitmap[word];
+        if(bits) {
+#if defined(__GNUC__) || defined(__clang__)
+            return word * 64 + (63 - __builtin_clzll(bits));
+#elif defined(_MSC_VER) && defined(_M_X64)
+            unsigned long index;
+            _BitScanReverse64(&index, bits);
+            return word * 64 + (int)index;
+#else
+            int bit = 0, shift;
+            for(shift = 32; shift; shift >>= 1) {
+                if(bits >> shift) {
+                    bits >>= shift;
+                    bit += shift;
+                }
+            }
+            return word * 64 + bit;
+#endif
+        }
+    }
+    return -1;
+}
+
+
+/* DECLARE_RUN_QUEUE_MEMBERS
+Declare the run queue members (levels, bitmap).
+
+Use this declaration in your run queue struct. The level list struct must be
+declared with DECLARE_LIST_MEMBERS and its nodes with DECLARE_NODE_MEMBERS.
+
+This macro adds the following members:
+levels : The level lists, indexed by level.
+bitmap : The bit for level 'n' is bit n % 64 of word n / 64, set if the level
+         is not empty.
+
+[in] 'list_tag' : Tag name of your level list struct.
+*/
+#define DECLARE_RUN_QUEUE_MEMBERS(list_tag)   \
+    struct list_tag levels[RUN_QUEUE_LEVELS]; \
+    unsigned long long bitmap[RUN_QUEUE_WORDS]
+
+
+/* ZERO_OUT_RUN_QUEUE_MEMBERS
+Zero out the run queue members (levels, bitmap).
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'rq' : Pointer to a run queue.
+*/
+#define ZERO_OUT_RUN_QUEUE_MEMBERS(rq)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((rq)) { \
+        int rq_index_; \
+        for(rq_index_ = 0; rq_index_ < RUN_QUEUE_LEVELS; ++rq_index_) { \
+            ZERO_OUT_LIST_MEMBERS(&(rq)->levels[rq_index_]); \
+        } \
+        for(rq_index_ = 0; rq_index_ < RUN_QUEUE_WORDS; ++rq_index_) { \
+            (rq)->bitmap[rq_index_] = 0; \
+        } \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* RUN_QUEUE_LEVEL
+The level of a node in the run queue.
+
+'node' must be in one of the run queue's levels.
+
+[in] 'rq' : Pointer to a run queue.
+[in] 'node' : Pointer to a node.
+*/
+#define RUN_QUEUE_LEVEL(rq, node)   ((int)((node)->parent - (rq)->levels))
+
+
+/* RUN_QUEUE_REMOVE
+Unlink a node from its level.
+
+This is UNLINK_NODE, and the level's bit is cleared if the level is left
+empty. The level is found from the node's parent pointer so no search is done.
+If 'node' is not in the run queue then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'rq' : Pointer to a run queue.
+[in] 'node' : Pointer to a node.
+*/
+#define RUN_QUEUE_REMOVE(rq, node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((rq) && (node) && (node)->parent) { \
+        int rq_level_ = RUN_QUEUE_LEVEL((rq), (node)); \
+        UNLINK_NODE((node)); \
+        if(!(rq)->levels[rq_level_].count) { \
+            (rq)->bitmap[rq_level_ / 64] &= \
+                ~((unsigned long long)1 << (rq_level_ % 64)); \
+        } \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* RUN_QUEUE_ENQUEUE
+Link a node to the end of a level, moving it from its current level if any.
+
+If 'node' is already in the run queue it is removed first, so this macro also
+requeues a node at a new level in O(1). Requeueing a node at its own level
+moves it to the end of the level, which is a round-robin yield.
+
+If 'level' is not less than RUN_QUEUE_LEVELS then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'rq' : Pointer to a run queue.
+[in] 'node' : Pointer to a node.
+[in] 'level' : The level, 0 to RUN_QUEUE_LEVELS - 1.
+*/
+#define RUN_QUEUE_ENQUEUE(rq, node, level)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((rq) && (node) && ((unsigned)(level) < RUN_QUEUE_LEVELS)) { \
+        RUN_QUEUE_REMOVE((rq), (node)); \
+        LINK_NODE_LAST((node), &(rq)->levels[(level)]); \
+        (rq)->bitmap[(unsigned)(level) / 64] |= \
+            (unsigned long long)1 << ((unsigned)(level) % 64); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* RUN_QUEUE_PEEK
+Get the first node of the highest non-empty level.
+
+If the run queue is empty then 'node' is set to NULL. The node is not removed.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'rq' : Pointer to a run queue.
+[out] 'node' : Node pointer variable that receives the node or NULL.
+*/
+#define RUN_QUEUE_PEEK(rq, node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    int rq_top_ = (rq) ? run_queue_highest_((rq)->bitmap) : -1; \
+    (node) = (rq_top_ >= 0) ? (rq)->levels[rq_top_].head : NULL; \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* RUN_QUEUE_POP
+Get and unlink the first node of the highest non-empty level.
+
+If the run queue is empty then 'node' is set to NULL.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'rq' : Pointer to a run queue.
+[out] 'node' : Node pointer variable that receives the node or NULL.
+*/
+#define RUN_QUEUE_POP(rq, node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    RUN_QUEUE_PEEK((rq), (node)); \
+    RUN_QUEUE_REMOVE((rq), (node)); \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+#endif /* GENERIC_RUN_QUEUE_H_ */
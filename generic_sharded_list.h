@@ -0,0 +1,256 @@
+/* Generic helper macros for a sharded list with per-shard locks.
+*/
+#ifndef GENERIC_SHARDED_LIST_H_
+#define GENERIC_SHARDED_LIST_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Generic helper macros for a sharded list with per-shard locks.
+
+A sharded list is an array of generic_list lists, one per thread or CPU, each
+on its own cache line with its own spinlock. Producers append to the shard for
+their thread or CPU so they don't contend on one tail and count. A consumer
+collects all shards into an ordinary list by stitching each shard's chain onto
+it, which is O(shards) and not O(nodes).
+
+Each shard also keeps a small delta of the nodes linked to it that it folds
+into a shared approximate count every SHARDED_LIST_BATCH links, so the count
+can be read in O(1) without touching the shards.
+
+DECLARE_SHARDED_LIST_MEMBERS
+Declare the sharded list members (shards, approx_count).
+
+ZERO_OUT_SHARDED_LIST_MEMBERS
+Zero out the sharded list members.
+
+SHARDED_LIST_SHARD_COUNT
+The number of shards.
+
+SHARDED_LIST_LINK_LAST
+Link a node to the tail of a shard.
+
+SHARDED_LIST_COLLECT
+Move the nodes of every shard to the end of a list.
+
+SHARDED_LIST_APPROX_COUNT
+The approximate number of nodes in all shards.
+
+---
+Important:
+
+The same rules as generic_list.h apply. The input parameters for the macros are
+evaluated multiple times because they are generic function-like macros. The
+parameters must not have side effects or access the list.
+
+Nodes in a shard must only be added by SHARDED_LIST_LINK_LAST and removed by
+SHARDED_LIST_COLLECT.
+
+Collected nodes keep the shard as their parent. Call ADOPT_LIST_NODES on the
+list they were collected to before passing any of them to the other macros, or
+ZERO_OUT_NODE_MEMBERS each node as it is taken off the list by walking 'next'.
+
+---
+Other:
+
+The shards are a struct array in your sharded list struct so your list struct
+must be defined before it. Any shard index can be passed to
+SHARDED_LIST_LINK_LAST, it is taken modulo the number of shards; a thread index
+or the current CPU number (eg sched_getcpu) is typical. A thread that migrates
+to another CPU still links correctly since every shard has a lock.
+
+The locks are the spinlocks from generic_atomic.h, which is included by this
+header.
+*/
+
+#include "generic_list.h"
+#include "generic_atomic.h"
+
+
+/* The number of links a shard counts before it adds them to approx_count. */
+#ifndef SHARDED_LIST_BATCH
+#define SHARDED_LIST_BATCH   32
+#endif
+
+
+/* DECLARE_SHARDED_LIST_MEMBERS
+Declare the sharded list members (shards, approx_count).
+
+Use this declaration in your sharded list struct. Each shard and approx_count
+are aligned to a cache line.
+
+This macro adds the following members:
+shards : Array of shards, each a list (sublist), a spinlock and a delta.
+approx_count : The number of nodes in all shards, less the deltas.
+
+[in] 'list_tag' : Tag name of your list struct.
+[in] 'shard_count' : The number of shards, a constant.
+*/
+#define DECLARE_SHARDED_LIST_MEMBERS(list_tag, shard_count)   \
+    struct { \
+        GENERIC_CACHE_ALIGN struct list_tag sublist; \
+        long lock; \
+        size_t delta; \
+    } shards[shard_count]; \
+    GENERIC_CACHE_ALIGN size_t approx_count
+
+
+/* ZERO_OUT_SHARDED_LIST_MEMBERS
+Zero out the sharded list members.
+
+It must not be called while any other thread is using the sharded list.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'sharded' : Pointer to a sharded list.
+*/
+#define ZERO_OUT_SHARDED_LIST_MEMBERS(sharded)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((sharded)) { \
+        size_t generic_shard_; \
+        for(generic_shard_ = 0; \
+            generic_shard_ < SHARDED_LIST_SHARD_COUNT((sharded)); \
+            ++generic_shard_) \
+        { \
+            ZERO_OUT_LIST_MEMBERS( \
+                &(sharded)->shards[generic_shard_].sublist); \
+            (sharded)->shards[generic_shard_].lock = 0; \
+            (sharded)->shards[generic_shard_].delta = 0; \
+        } \
+        (sharded)->approx_count = 0; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* SHARDED_LIST_SHARD_COUNT
+The number of shards.
+
+[in] 'sharded' : Pointer to a sharded list.
+*/
+#define SHARDED_LIST_SHARD_COUNT(sharded)   \
+    (sizeof((sharded)->shards) / sizeof((sharded)->shards[0]))
+
+
+/* SHARDED_LIST_LINK_LAST
+Link a node to the tail of a shard.
+
+Only the shard's lock is taken. If the shard has a node count equal to the
+maximum value of size_t then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'sharded' : Pointer to a sharded list.
+[in] 'node' : Pointer to a node that is not part of a list.
+[in] 'shard' : Index of the shard, taken modulo the number of shards.
+*/
+#define SHARDED_LIST_LINK_LAST(sharded, node, shard)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((sharded) && (node) && !(node)->parent) { \
+        size_t generic_shard_ = \
+            (size_t)(shard) % SHARDED_LIST_SHARD_COUNT((sharded)); \
+        GENERIC_SPINLOCK_ACQUIRE((sharded)->shards[generic_shard_].lock); \
+        LINK_NODE_LAST((node), &(sharded)->shards[generic_shard_].sublist); \
+        if((node)->parent \
+            && (++(sharded)->shards[generic_shard_].delta \
+                >= SHARDED_LIST_BATCH)) \
+        { \
+            GENERIC_ATOMIC_ADD_SIZE((sharded)->approx_count, \
+                (sharded)->shards[generic_shard_].delta); \
+            (sharded)->shards[generic_shard_].delta = 0; \
+        } \
+        GENERIC_SPINLOCK_RELEASE((sharded)->shards[generic_shard_].lock); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* SHARDED_LIST_COLLECT
+Move the nodes of every shard to the end of a list.
+
+The shards are visited in order and each one's lock is held only while its
+chain is stitched onto 'list' by STITCH_LIST_LAST, O(1) per shard. The nodes'
+parent is not changed, see ADOPT_LIST_NODES. A shard is skipped if moving it
+would overflow the list's count.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'sharded' : Pointer to a sharded list.
+[in] 'list' : Pointer to a list that only the caller is using.
+*/
+#define SHARDED_LIST_COLLECT(sharded, list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((sharded) && (list)) { \
+        size_t generic_shard_; \
+        for(generic_shard_ = 0; \
+            generic_shard_ < SHARDED_LIST_SHARD_COUNT((sharded)); \
+            ++generic_shard_) \
+        { \
+            GENERIC_SPINLOCK_ACQUIRE((sharded)->shards[generic_shard_].lock); \
+            if((sharded)->shards[generic_shard_].sublist.head \
+                && ((sharded)->shards[generic_shard_].sublist.count \
+                    <= (size_t)-1 - (list)->count)) \
+            { \
+                GENERIC_ATOMIC_ADD_SIZE((sharded)->approx_count, \
+                    (sharded)->shards[generic_shard_].delta \
+                    - (sharded)->shards[generic_shard_].sublist.count); \
+                (sharded)->shards[generic_shard_].delta = 0; \
+                STITCH_LIST_LAST((list), \
+                    &(sharded)->shards[generic_shard_].sublist); \
+            } \
+            GENERIC_SPINLOCK_RELEASE((sharded)->shards[generic_shard_].lock); \
+        } \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* SHARDED_LIST_APPROX_COUNT
+The approximate number of nodes in all shards.
+
+No lock is taken. Each shard holds back up to SHARDED_LIST_BATCH - 1 links
+before it counts them, so the result can be low by up to that many per shard,
+and it must not be used for anything other than statistics or heuristics.
+
+[in] 'sharded' : Pointer to a sharded list.
+*/
+#define SHARDED_LIST_APPROX_COUNT(sharded)   \
+    GENERIC_ATOMIC_LOAD_SIZE((sharded)->approx_count)
+
+#endif /* GENERIC_SHARDED_LIST_H_ */
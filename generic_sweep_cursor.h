@@ -0,0 +1,336 @@
+/* Generic helper macros for a resumable sweep cursor registered with a list.
+*/
+#ifndef GENERIC_SWEEP_CURSOR_H_
+#define GENERIC_SWEEP_CURSOR_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Generic helper macros for a resumable sweep cursor registered with a list.
+
+A sweep cursor walks a list a few nodes at a time so that a long walk, for
+example a garbage collection of expired nodes, can be split into short slices
+with other work in between. The cursor remembers the next node it will visit.
+Cursors are registered with the list, and SWEEP_UNLINK_NODE moves every
+cursor that is on the node being unlinked to the next node, so the saved
+position never points to a node that has left the list.
+
+A pass starts at the head when the cursor is registered or reset and ends when
+the cursor reaches the end of the list. Nodes linked ahead of the cursor during
+a pass are visited in the same pass and nodes linked behind it are not.
+
+DECLARE_SWEEP_LIST_MEMBERS
+Declare the sweep list members.
+
+DECLARE_SWEEP_CURSOR_MEMBERS
+Declare the sweep cursor members.
+
+ZERO_OUT_SWEEP_LIST_MEMBERS
+Zero out the sweep list members.
+
+ZERO_OUT_SWEEP_CURSOR_MEMBERS
+Zero out the sweep cursor members.
+
+SWEEP_CURSOR_REGISTER
+Register a cursor with a list and start a pass at the head.
+
+SWEEP_CURSOR_UNREGISTER
+Unregister a cursor from its list.
+
+SWEEP_CURSOR_RESET
+Start a new pass at the head of the list.
+
+SWEEP_CURSOR_DONE
+Whether the cursor has reached the end of the list.
+
+SWEEP_CURSOR_STEP
+Visit up to N nodes from the cursor's position and advance it.
+
+SWEEP_UNLINK_NODE
+Unlink a node and move any cursor on it to the next node.
+
+---
+Important:
+
+The same rules as generic_list.h apply. The input parameters for the macros are
+evaluated multiple times because they are generic function-like macros. The
+parameters must not have side effects or access the list.
+
+Only SWEEP_UNLINK_NODE advances a cursor. UNLINK_NODE and the LINK_NODE_ macros
+don't know about cursors and never move one, so a node must leave a list that
+has cursors only by SWEEP_UNLINK_NODE. That includes moving it with one of the
+LINK_NODE_ macros, which unlink the node from its list first: call
+SWEEP_UNLINK_NODE before linking it elsewhere. Linking a node that is not in a
+list can be done with the other macros as usual.
+
+A cursor must be unregistered before its list is discarded.
+
+---
+Other:
+
+SWEEP_UNLINK_NODE checks every cursor registered with the list, so it is O(1)
+for the usual one or two cursors. The list struct has a scratch member that the
+macros use as a temporary, so the list must not be changed by two threads at
+the same time.
+*/
+
+#include "generic_list.h"
+
+
+/* DECLARE_SWEEP_LIST_MEMBERS
+Declare the sweep list members.
+
+Use this declaration in your list struct instead of DECLARE_LIST_MEMBERS.
+
+This macro adds the members of DECLARE_LIST_MEMBERS and the following members:
+cursors : The first registered cursor. NULL if none.
+cursor_scratch : For internal use.
+
+[in] 'node_tag' : Tag name of your node struct.
+[in] 'cursor_tag' : Tag name of your cursor struct.
+*/
+#define DECLARE_SWEEP_LIST_MEMBERS(node_tag, cursor_tag)   \
+    DECLARE_LIST_MEMBERS(node_tag); \
+    struct cursor_tag *cursors, *cursor_scratch
+
+
+/* DECLARE_SWEEP_CURSOR_MEMBERS
+Declare the sweep cursor members.
+
+Use this declaration in your cursor struct.
+
+This macro adds the following members:
+position : The next node the cursor will visit. NULL at the end of the list.
+owner : The list the cursor is registered with. NULL if none.
+prev_cursor : The previous cursor registered with the list. NULL if none.
+next_cursor : The next cursor registered with the list. NULL if none.
+budget : For internal use.
+
+[in] 'node_tag' : Tag name of your node struct.
+[in] 'list_tag' : Tag name of your list struct.
+[in] 'cursor_tag' : Tag name of your cursor struct.
+*/
+#define DECLARE_SWEEP_CURSOR_MEMBERS(node_tag, list_tag, cursor_tag)   \
+    struct node_tag *position; \
+    struct list_tag *owner; \
+    struct cursor_tag *prev_cursor, *next_cursor; \
+    size_t budget
+
+
+/* ZERO_OUT_SWEEP_LIST_MEMBERS
+Zero out the sweep list members.
+
+[in] 'list' : Pointer to a list.
+*/
+#define ZERO_OUT_SWEEP_LIST_MEMBERS(list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((list)) { \
+        ZERO_OUT_LIST_MEMBERS((list)); \
+        (list)->cursors = (list)->cursor_scratch = NULL; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* ZERO_OUT_SWEEP_CURSOR_MEMBERS
+Zero out the sweep cursor members.
+
+[in] 'cursor' : Pointer to a cursor that is not registered.
+*/
+#define ZERO_OUT_SWEEP_CURSOR_MEMBERS(cursor)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((cursor)) { \
+        (cursor)->position = NULL; \
+        (cursor)->owner = NULL; \
+        (cursor)->prev_cursor = (cursor)->next_cursor = NULL; \
+        (cursor)->budget = 0; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* SWEEP_CURSOR_REGISTER
+Register a cursor with a list and start a pass at the head.
+
+If 'cursor' is already registered then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'cursor' : Pointer to a cursor.
+[in] 'list' : Pointer to a list.
+*/
+#define SWEEP_CURSOR_REGISTER(cursor, list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((cursor) && (list) && !(cursor)->owner) { \
+        (cursor)->owner = (list); \
+        (cursor)->prev_cursor = NULL; \
+        (cursor)->next_cursor = (list)->cursors; \
+        if((cursor)->next_cursor) { \
+            (cursor)->next_cursor->prev_cursor = (cursor); \
+        } \
+        (list)->cursors = (cursor); \
+        (cursor)->position = (list)->head; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* SWEEP_CURSOR_UNREGISTER
+Unregister a cursor from its list.
+
+If 'cursor' is not registered then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'cursor' : Pointer to a cursor.
+*/
+#define SWEEP_CURSOR_UNREGISTER(cursor)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((cursor) && (cursor)->owner) { \
+        if((cursor)->prev_cursor) { \
+            (cursor)->prev_cursor->next_cursor = (cursor)->next_cursor; \
+        } \
+        else { \
+            (cursor)->owner->cursors = (cursor)->next_cursor; \
+        } \
+        if((cursor)->next_cursor) { \
+            (cursor)->next_cursor->prev_cursor = (cursor)->prev_cursor; \
+        } \
+        ZERO_OUT_SWEEP_CURSOR_MEMBERS((cursor)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* SWEEP_CURSOR_RESET
+Start a new pass at the head of the list.
+
+If 'cursor' is not registered then no action is taken.
+
+[in] 'cursor' : Pointer to a cursor.
+*/
+#define SWEEP_CURSOR_RESET(cursor)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((cursor) && (cursor)->owner) { \
+        (cursor)->position = (cursor)->owner->head; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* SWEEP_CURSOR_DONE
+Whether the cursor has reached the end of the list.
+
+[in] 'cursor' : Pointer to a registered cursor.
+
+Evaluates to nonzero if the pass is complete.
+*/
+#define SWEEP_CURSOR_DONE(cursor)   (!(cursor)->position)
+
+
+/* SWEEP_CURSOR_STEP
+Visit up to N nodes from the cursor's position and advance it.
+
+Use it like a for statement. The cursor is moved past each node before the
+body runs, so the body may unlink the node with SWEEP_UNLINK_NODE and free it,
+and may unlink other nodes of the list as well. Other code can run between two
+steps, and the next step continues where this one stopped. Each node counts as
+a visit in the list's statistics if GENERIC_LIST_STATS is defined.
+
+for example, to collect up to 64 nodes per step:
+SWEEP_CURSOR_STEP(cursor, node, 64) {
+    if(node->expires <= now) {
+        SWEEP_UNLINK_NODE(node);
+        free(node);
+    }
+}
+if(SWEEP_CURSOR_DONE(cursor)) {
+    SWEEP_CURSOR_RESET(cursor);
+}
+
+'node' is unspecified after the loop ends.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'cursor' : Pointer to a registered cursor.
+[in] 'node' : Node pointer variable that is set to each node in turn.
+[in] 'max_n' : The maximum number of nodes to visit.
+*/
+#define SWEEP_CURSOR_STEP(cursor, node, max_n)   \
+    for((cursor)->budget = (size_t)(max_n); \
+        (cursor)->budget && (((node) = (cursor)->position) != NULL) \
+            && ((cursor)->position = (node)->next, --(cursor)->budget, \
+                GENERIC_LIST_STATS_VISIT_((cursor)->owner), 1); )
+
+
+/* SWEEP_UNLINK_NODE
+Unlink a node and move any cursor on it to the next node.
+
+If 'node' is not part of a list then no action is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'node' : Pointer to a node.
+*/
+#define SWEEP_UNLINK_NODE(node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node) && (node)->parent) { \
+        for((node)->parent->cursor_scratch = (node)->parent->cursors; \
+            (node)->parent->cursor_scratch; \
+            (node)->parent->cursor_scratch = \
+                (node)->parent->cursor_scratch->next_cursor) \
+        { \
+            if((node)->parent->cursor_scratch->position == (node)) { \
+                (node)->parent->cursor_scratch->position = (node)->next; \
+            } \
+        } \
+        UNLINK_NODE((node)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+#endif /* GENERIC_SWEEP_CURSOR_H_ */
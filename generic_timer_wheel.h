@@ -0,0 +1,317 @@
+/* Generic helper macros for a hierarchical timing wheel.
+*/
+#ifndef GENERIC_TIMER_WHEEL_H_
+#define GENERIC_TIMER_WHEEL_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Generic helper macros for a hierarchical timing wheel.
+
+The wheel has TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SIZE slots and each slot
+is a generic_list list. Level 0 has one slot per tick, each level above it has
+one slot per TIMER_WHEEL_SIZE slots of the level below. A timer is linked to
+the slot of the lowest level that can hold its expiry time, and when the lower
+level wraps around the next slot of the upper level is cascaded down into it.
+
+Arming a timer is a LINK_NODE_LAST and cancelling a timer is an UNLINK_NODE
+through its parent pointer, both O(1). Advancing the wheel splices each due
+level 0 slot to the end of an expired list in one go.
+
+DECLARE_TIMER_NODE_MEMBERS
+Declare the timer node members (prev, next, parent, expires).
+
+DECLARE_TIMER_WHEEL_MEMBERS
+Declare the timer wheel members (slots, now, cascade_node).
+
+ZERO_OUT_TIMER_NODE_MEMBERS
+Zero out the timer node members (prev, next, parent, expires).
+
+ZERO_OUT_TIMER_WHEEL_MEMBERS
+Zero out the timer wheel members (slots, now, cascade_node).
+
+TIMER_WHEEL_ARM
+Link a timer node to the wheel slot for its expiry time.
+
+TIMER_WHEEL_CANCEL
+Unlink a timer node from its wheel slot or expired list.
+
+TIMER_WHEEL_ADVANCE
+Advance the wheel and move all timers that have expired to an expired list.
+
+---
+Important:
+
+The same rules as generic_list.h apply. The input parameters for the macros are
+evaluated multiple times because they are generic function-like macros. The
+parameters must not have side effects or access the list.
+
+---
+Other:
+
+The wheel's slots and the expired list passed to TIMER_WHEEL_ADVANCE are all of
+the same list struct type, so a timer node's parent always points to a list
+struct whether the timer is pending or expired.
+
+Time is measured in ticks of unsigned long long. The wheel's 'now' member is
+the next tick that TIMER_WHEEL_ADVANCE will process. To start the wheel at a
+tick other than 0 set 'now' before arming any timers.
+
+A timer armed with an expiry time that has already passed expires on the next
+call to TIMER_WHEEL_ADVANCE. A timer armed further out than the wheel can hold
+is parked in the top level and cascaded back into it until it is in range.
+*/
+
+#include "generic_list.h"
+
+/* The number of bits of the tick that index a slot in one level. */
+#ifndef TIMER_WHEEL_BITS
+#define TIMER_WHEEL_BITS   6
+#endif
+
+/* The number of levels in the wheel. */
+#ifndef TIMER_WHEEL_LEVELS
+#define TIMER_WHEEL_LEVELS   4
+#endif
+
+#define TIMER_WHEEL_SIZE   (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK   (TIMER_WHEEL_SIZE - 1)
+
+/* The number of ticks from 'now' that the wheel can hold without parking. */
+#define TIMER_WHEEL_RANGE   \
+    ((unsigned long long)1 << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+
+
+/* DECLARE_TIMER_NODE_MEMBERS
+Declare the timer node members (prev, next, parent, expires).
+
+Use this declaration in your timer node struct instead of DECLARE_NODE_MEMBERS.
+
+This macro adds the following members:
+prev, next, parent : Refer to DECLARE_NODE_MEMBERS in generic_list.h.
+expires : The tick at which the timer expires.
+
+[in] 'node_tag' : Tag name of your timer node struct.
+[in] 'list_tag' : Tag name of your slot list struct.
+*/
+#define DECLARE_TIMER_NODE_MEMBERS(node_tag, list_tag)   \
+    DECLARE_NODE_MEMBERS(node_tag, list_tag); \
+    unsigned long long expires
+
+
+/* DECLARE_TIMER_WHEEL_MEMBERS
+Declare the timer wheel members (slots, now, cascade_node).
+
+Use this declaration in your timer wheel struct. The slot list struct must be
+declared with DECLARE_LIST_MEMBERS.
+
+This macro adds the following members:
+slots : The slot lists, indexed [level][slot].
+now : The next tick to be processed by TIMER_WHEEL_ADVANCE.
+cascade_node : For internal use. The node being cascaded.
+
+[in] 'node_tag' : Tag name of your timer node struct.
+[in] 'list_tag' : Tag name of your slot list struct.
+*/
+#define DECLARE_TIMER_WHEEL_MEMBERS(node_tag, list_tag)   \
+    struct list_tag slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SIZE]; \
+    unsigned long long now; \
+    struct node_tag *cascade_node
+
+
+/* ZERO_OUT_TIMER_NODE_MEMBERS
+Zero out the timer node members (prev, next, parent, expires).
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'node' : Pointer to a timer node.
+*/
+#define ZERO_OUT_TIMER_NODE_MEMBERS(node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((node)) { \
+        ZERO_OUT_NODE_MEMBERS((node)); \
+        (node)->expires = 0; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* ZERO_OUT_TIMER_WHEEL_MEMBERS
+Zero out the timer wheel members (slots, now, cascade_node).
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'wheel' : Pointer to a timer wheel.
+*/
+#define ZERO_OUT_TIMER_WHEEL_MEMBERS(wheel)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((wheel)) { \
+        int tw_level_, tw_slot_; \
+        for(tw_level_ = 0; tw_level_ < TIMER_WHEEL_LEVELS; ++tw_level_) { \
+            for(tw_slot_ = 0; tw_slot_ < TIMER_WHEEL_SIZE; ++tw_slot_) { \
+                ZERO_OUT_LIST_MEMBERS(&(wheel)->slots[tw_level_][tw_slot_]); \
+            } \
+        } \
+        (wheel)->now = 0; \
+        (wheel)->cascade_node = NULL; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* TIMER_WHEEL_LINK_
+For internal use. Link a node to the slot for node->expires.
+*/
+#define TIMER_WHEEL_LINK_(wheel, node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    int tw_level_ = 0; \
+    unsigned long long tw_when_ = (node)->expires; \
+    if(tw_when_ < (wheel)->now) { \
+        tw_when_ = (wheel)->now; \
+    } \
+    else if(tw_when_ - (wheel)->now >= TIMER_WHEEL_RANGE) { \
+        tw_when_ = (wheel)->now + (TIMER_WHEEL_RANGE - 1); \
+    } \
+    while((tw_level_ < TIMER_WHEEL_LEVELS - 1) \
+        && ((tw_when_ - (wheel)->now) \
+            >= ((unsigned long long)TIMER_WHEEL_SIZE \
+                << (tw_level_ * TIMER_WHEEL_BITS)))) \
+    { \
+        ++tw_level_; \
+    } \
+    LINK_NODE_LAST((node), &(wheel)->slots[tw_level_] \
+        [(tw_when_ >> (tw_level_ * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK]); \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* TIMER_WHEEL_ARM
+Link a timer node to the wheel slot for its expiry time.
+
+If 'node' is already armed or expired it is unlinked first, so this macro can
+also be used to rearm a timer.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'wheel' : Pointer to a timer wheel.
+[in] 'node' : Pointer to a timer node.
+[in] 'when' : The tick at which the timer expires.
+*/
+#define TIMER_WHEEL_ARM(wheel, node, when)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((wheel) && (node)) { \
+        (node)->expires = (when); \
+        TIMER_WHEEL_LINK_((wheel), (node)); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* TIMER_WHEEL_CANCEL
+Unlink a timer node from its wheel slot or expired list.
+
+This is UNLINK_NODE. The node's parent pointer is its slot so no search is
+done.
+
+[in] 'node' : Pointer to a timer node.
+*/
+#define TIMER_WHEEL_CANCEL(node)   UNLINK_NODE((node))
+
+
+/* TIMER_WHEEL_ADVANCE
+Advance the wheel and move all timers that have expired to an expired list.
+
+Each tick from wheel->now up to and including 'until' is processed. The timers
+that expire on a tick are spliced to the end of 'expired_list' in the order
+they were linked to the tick's level 0 slot, and after the call wheel->now is
+'until' + 1. That is the order they were armed, except that a timer cascaded
+down from an upper level comes after the timers armed directly into the slot
+before the cascade. Timers of different ticks are in tick order. If 'until' is
+less than wheel->now then no action is taken.
+
+The caller fires the timers by unlinking them from 'expired_list'. A timer may
+be cancelled or rearmed while it is in 'expired_list'.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'wheel' : Pointer to a timer wheel.
+[in] 'until' : The last tick to process.
+[in] 'expired_list' : Pointer to a list that is not one of the wheel's slots.
+*/
+#define TIMER_WHEEL_ADVANCE(wheel, until, expired_list)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((wheel) && (expired_list)) { \
+        while((wheel)->now <= (until)) { \
+            int tw_slot_ = (int)((wheel)->now & TIMER_WHEEL_MASK); \
+            if(!tw_slot_) { \
+                int tw_upper_; \
+                for(tw_upper_ = 1; \
+                    tw_upper_ < TIMER_WHEEL_LEVELS; \
+                    ++tw_upper_) \
+                { \
+                    int tw_index_ = (int)(((wheel)->now \
+                        >> (tw_upper_ * TIMER_WHEEL_BITS)) \
+                        & TIMER_WHEEL_MASK); \
+                    while((wheel)->slots[tw_upper_][tw_index_].head) { \
+                        (wheel)->cascade_node = \
+                            (wheel)->slots[tw_upper_][tw_index_].head; \
+                        TIMER_WHEEL_LINK_((wheel), (wheel)->cascade_node); \
+                    } \
+                    if(tw_index_) { \
+                        break; \
+                    } \
+                } \
+                (wheel)->cascade_node = NULL; \
+            } \
+            SPLICE_LIST_LAST((expired_list), &(wheel)->slots[0][tw_slot_]); \
+            if(!++(wheel)->now) { \
+                break; \
+            } \
+        } \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+#endif /* GENERIC_TIMER_WHEEL_H_ */
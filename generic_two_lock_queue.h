@@ -0,0 +1,234 @@
+/* Generic helper macros for a two-lock concurrent queue.
+*/
+#ifndef GENERIC_TWO_LOCK_QUEUE_H_
+#define GENERIC_TWO_LOCK_QUEUE_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Generic helper macros for a two-lock concurrent queue.
+
+This is the Michael-Scott two-lock queue for intrusive nodes. Producers only
+take the tail lock and consumers only take the head lock, so one producer and
+one consumer run in parallel. The head side (head, head_lock, dequeued) and the
+tail side (tail, tail_lock, enqueued) are each aligned to their own cache line
+so that the two sides don't false-share.
+
+There is no shared count. Each side counts the nodes it has passed through and
+TWO_LOCK_QUEUE_APPROX_COUNT subtracts one from the other without taking either
+lock.
+
+DECLARE_TWO_LOCK_QUEUE_MEMBERS
+Declare the queue members (head side, tail side, stub).
+
+INIT_TWO_LOCK_QUEUE_MEMBERS
+Initialize the queue members to an empty queue.
+
+TWO_LOCK_QUEUE_PUSH
+Push a node to the tail of the queue.
+
+TWO_LOCK_QUEUE_POP
+Pop a node from the head of the queue.
+
+TWO_LOCK_QUEUE_APPROX_COUNT
+The approximate number of nodes in the queue.
+
+---
+Important:
+
+The same rules as generic_list.h apply. The input parameters for the macros are
+evaluated multiple times because they are generic function-like macros. The
+parameters must not have side effects or access the list or queue.
+
+A node that is pushed must not be part of a list (node->parent == NULL). While
+it is in the queue only its 'next' member is used, and the generic_list macros
+must not be called on it. A popped node has its 'next' member reset to NULL and
+can be linked to a list.
+
+---
+Other:
+
+The queue struct holds a stub node so your node struct must be defined before
+your queue struct. The stub node is never returned by TWO_LOCK_QUEUE_POP.
+
+The alignment of the queue struct is GENERIC_CACHE_LINE_SIZE. A queue that is
+allocated with malloc may not get that alignment, in which case its first and
+last cache lines may be shared with neighbouring memory.
+
+The locks are the spinlocks from generic_atomic.h, which is included by this
+header.
+*/
+
+#include "generic_list.h"
+#include "generic_atomic.h"
+
+
+/* DECLARE_TWO_LOCK_QUEUE_MEMBERS
+Declare the queue members (head side, tail side, stub).
+
+Use this declaration in your queue struct. The members are aligned so the
+struct will be padded to a multiple of GENERIC_CACHE_LINE_SIZE.
+
+This macro adds the following members:
+head : The next node to pop, or the stub node.
+head_lock : The consumers' spinlock.
+dequeued : The number of nodes popped.
+tail : The last node pushed, or the stub node.
+tail_lock : The producers' spinlock.
+enqueued : The number of nodes pushed.
+stub : For internal use. A node that keeps the queue from being empty.
+
+[in] 'node_tag' : Tag name of your node struct.
+*/
+#define DECLARE_TWO_LOCK_QUEUE_MEMBERS(node_tag)   \
+    GENERIC_CACHE_ALIGN struct node_tag *head; \
+    long head_lock; \
+    size_t dequeued; \
+    GENERIC_CACHE_ALIGN struct node_tag *tail; \
+    long tail_lock; \
+    size_t enqueued; \
+    GENERIC_CACHE_ALIGN struct node_tag stub
+
+
+/* INIT_TWO_LOCK_QUEUE_MEMBERS
+Initialize the queue members to an empty queue.
+
+Zeroing the queue struct is not enough, this must be called before the queue
+is used. It must not be called while any other thread is using the queue.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the queue.
+
+[in] 'queue' : Pointer to a queue.
+*/
+#define INIT_TWO_LOCK_QUEUE_MEMBERS(queue)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((queue)) { \
+        ZERO_OUT_NODE_MEMBERS(&(queue)->stub); \
+        (queue)->head = (queue)->tail = &(queue)->stub; \
+        (queue)->head_lock = (queue)->tail_lock = 0; \
+        (queue)->dequeued = (queue)->enqueued = 0; \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* TWO_LOCK_QUEUE_PUSH
+Push a node to the tail of the queue.
+
+Only the tail lock is taken.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the queue.
+
+[in] 'queue' : Pointer to a queue.
+[in] 'node' : Pointer to a node that is not part of a list or queue.
+*/
+#define TWO_LOCK_QUEUE_PUSH(queue, node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((queue) && (node)) { \
+        (node)->next = NULL; \
+        GENERIC_SPINLOCK_ACQUIRE((queue)->tail_lock); \
+        GENERIC_ATOMIC_STORE_RELEASE((queue)->tail->next, (node)); \
+        (queue)->tail = (node); \
+        GENERIC_ATOMIC_STORE_SIZE((queue)->enqueued, (queue)->enqueued + 1); \
+        GENERIC_SPINLOCK_RELEASE((queue)->tail_lock); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* TWO_LOCK_QUEUE_POP
+Pop a node from the head of the queue.
+
+'node' is set to the popped node, or NULL if the queue is empty. The popped
+node's next member is reset to NULL.
+
+Only the head lock is taken, except when the last node is popped: then the stub
+node is pushed behind it, which briefly takes the tail lock too.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the queue.
+
+[in] 'queue' : Pointer to a queue.
+[out] 'node' : Node pointer variable that receives the popped node.
+*/
+#define TWO_LOCK_QUEUE_POP(queue, node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    (node) = NULL; \
+    if((queue)) { \
+        GENERIC_SPINLOCK_ACQUIRE((queue)->head_lock); \
+        if((queue)->head == &(queue)->stub) { \
+            (node) = GENERIC_ATOMIC_LOAD_ACQUIRE((queue)->stub.next); \
+            if((node)) { \
+                (queue)->head = (node); \
+            } \
+        } \
+        if((queue)->head != &(queue)->stub) { \
+            (node) = (queue)->head; \
+            if(!GENERIC_ATOMIC_LOAD_ACQUIRE((node)->next)) { \
+                (queue)->stub.next = NULL; \
+                GENERIC_SPINLOCK_ACQUIRE((queue)->tail_lock); \
+                GENERIC_ATOMIC_STORE_RELEASE((queue)->tail->next, \
+                    &(queue)->stub); \
+                (queue)->tail = &(queue)->stub; \
+                GENERIC_SPINLOCK_RELEASE((queue)->tail_lock); \
+            } \
+            (queue)->head = GENERIC_ATOMIC_LOAD_ACQUIRE((node)->next); \
+            GENERIC_ATOMIC_STORE_SIZE((queue)->dequeued, \
+                (queue)->dequeued + 1); \
+            (node)->next = NULL; \
+        } \
+        GENERIC_SPINLOCK_RELEASE((queue)->head_lock); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* TWO_LOCK_QUEUE_APPROX_COUNT
+The approximate number of nodes in the queue.
+
+Neither lock is taken. The two counters are read one after the other so the
+result can be off by however many pushes and pops happen in between, and must
+not be used for anything other than statistics or heuristics.
+
+[in] 'queue' : Pointer to a queue.
+*/
+#define TWO_LOCK_QUEUE_APPROX_COUNT(queue)   \
+    ((size_t)(GENERIC_ATOMIC_LOAD_SIZE((queue)->enqueued) \
+        - GENERIC_ATOMIC_LOAD_SIZE((queue)->dequeued)))
+
+#endif /* GENERIC_TWO_LOCK_QUEUE_H_ */
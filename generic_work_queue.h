@@ -0,0 +1,415 @@
+/* Generic helper macros for a bounded blocking work queue.
+*/
+#ifndef GENERIC_WORK_QUEUE_H_
+#define GENERIC_WORK_QUEUE_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Generic helper macros for a bounded blocking work queue.
+
+The queue is a generic_list list guarded by a mutex, with one condition
+variable for consumers waiting for work and one for producers waiting for room.
+A push blocks while the queue holds 'capacity' nodes (back-pressure) and a pop
+blocks while it is empty. WORK_QUEUE_POP_BATCH takes up to N nodes in a single
+critical section, so a consumer pays one lock round-trip for N jobs, and when
+the whole queue fits in the batch it is moved in O(1).
+
+Waiting is spin-then-block: before taking the mutex to sleep, a thread spins up
+to WORK_QUEUE_SPIN_COUNT times on a lock-free copy of the count, so a short gap
+between jobs doesn't cost a sleep and a wakeup. INIT_WORK_QUEUE turns spinning
+off when only one processor is online, where it would only delay the thread
+that is waited for. The condition variables are only signaled when a thread is
+actually asleep on them.
+
+INIT_WORK_QUEUE
+Initialize a queue and its mutex and condition variables.
+
+DESTROY_WORK_QUEUE
+Destroy a queue's mutex and condition variables.
+
+WORK_QUEUE_PUSH
+Link a node to the tail of the queue, waiting while it is full.
+
+WORK_QUEUE_POP
+Unlink the head node of the queue, waiting while it is empty.
+
+WORK_QUEUE_POP_BATCH
+Move up to N nodes from the head of the queue to a list, waiting while it is
+empty.
+
+WORK_QUEUE_CLOSE
+Close a queue and wake every waiting thread.
+
+---
+Important:
+
+The same rules as generic_list.h apply. The input parameters for the macros are
+evaluated multiple times because they are generic function-like macros. The
+parameters must not have side effects or access the list.
+
+Nodes in the queue must only be added and removed by these macros. Popped nodes
+are unlinked normally and can be passed to any macro.
+
+---
+Other:
+
+The mutex and condition variables are from generic_mutex.h, pthreads on Unix
+and a slim reader/writer lock and condition variables (Windows Vista or later)
+on Windows. The lock-free count is read with generic_atomic.h. Both are
+included by this header.
+*/
+
+#include "generic_list.h"
+#include "generic_atomic.h"
+#include "generic_mutex.h"
+
+
+/* The number of times a waiting thread spins before it blocks. */
+#ifndef WORK_QUEUE_SPIN_COUNT
+#define WORK_QUEUE_SPIN_COUNT   GENERIC_SPIN_COUNT
+#endif
+
+#if defined(_MSC_VER)
+#define WORK_QUEUE_INLINE_   static __inline
+#elif defined(__GNUC__)
+#define WORK_QUEUE_INLINE_   static __inline__
+#else
+#define WORK_QUEUE_INLINE_   static inline
+#endif
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+/* work_queue_processors_
+For internal use. The number of processors online, 1 if it can't be found.
+*/
+WORK_QUEUE_INLINE_ unsigned long work_queue_processors_(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors ? info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (unsigned long)count : 1;
+#endif
+}
+
+
+/* DECLARE_WORK_QUEUE_MEMBERS
+Declare the work queue members.
+
+Use this declaration in your queue struct.
+
+This macro adds the following members:
+items : The list of queued nodes.
+capacity : The maximum number of queued nodes.
+approx_count : A copy of items.count that is read without the mutex.
+closed : Nonzero once WORK_QUEUE_CLOSE has been called.
+mutex : Guards every other member.
+not_empty : Signaled when a node is pushed and a consumer is asleep.
+not_full : Signaled when a node is popped and a producer is asleep.
+sleeping_consumers : The number of consumers asleep on not_empty.
+sleeping_producers : The number of producers asleep on not_full.
+spin_count : WORK_QUEUE_SPIN_COUNT, or 0 if only one processor is online.
+moving : For internal use. Its head is the node WORK_QUEUE_POP_BATCH is moving.
+
+[in] 'list_tag' : Tag name of your list struct.
+*/
+#define DECLARE_WORK_QUEUE_MEMBERS(list_tag)   \
+    struct list_tag items; \
+    size_t capacity; \
+    size_t approx_count; \
+    int closed; \
+    GENERIC_MUTEX_T_ mutex; \
+    GENERIC_COND_T_ not_empty; \
+    GENERIC_COND_T_ not_full; \
+    size_t sleeping_consumers; \
+    size_t sleeping_producers; \
+    unsigned spin_count; \
+    struct list_tag moving
+
+
+/* INIT_WORK_QUEUE
+Initialize a queue and its mutex and condition variables.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'queue' : Pointer to a queue.
+[in] 'max_count' : The capacity of the queue, at least 1.
+*/
+#define INIT_WORK_QUEUE(queue, max_count)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((queue)) { \
+        ZERO_OUT_LIST_MEMBERS(&(queue)->items); \
+        (queue)->capacity = (max_count) ? (size_t)(max_count) : 1; \
+        (queue)->approx_count = 0; \
+        (queue)->closed = 0; \
+        GENERIC_MUTEX_INIT_((queue)->mutex); \
+        GENERIC_COND_INIT_((queue)->not_empty); \
+        GENERIC_COND_INIT_((queue)->not_full); \
+        (queue)->sleeping_consumers = (queue)->sleeping_producers = 0; \
+        (queue)->spin_count = (work_queue_processors_() > 1) \
+            ? WORK_QUEUE_SPIN_COUNT : 0; \
+        ZERO_OUT_LIST_MEMBERS(&(queue)->moving); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* DESTROY_WORK_QUEUE
+Destroy a queue's mutex and condition variables.
+
+No thread may be using the queue. Nodes still in the queue are left linked to
+queue->items.
+
+[in] 'queue' : Pointer to a queue.
+*/
+#define DESTROY_WORK_QUEUE(queue)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((queue)) { \
+        GENERIC_COND_DESTROY_((queue)->not_full); \
+        GENERIC_COND_DESTROY_((queue)->not_empty); \
+        GENERIC_MUTEX_DESTROY_((queue)->mutex); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* WORK_QUEUE_SPIN_WHILE_
+For internal use. Spin up to queue->spin_count times while 'condition' holds.
+*/
+#define WORK_QUEUE_SPIN_WHILE_(queue, condition)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    unsigned generic_spins_; \
+    for(generic_spins_ = 0; \
+        (generic_spins_ < (queue)->spin_count) && (condition); \
+        ++generic_spins_) \
+    { \
+        GENERIC_CPU_RELAX(); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* WORK_QUEUE_PUSH
+Link a node to the tail of the queue, waiting while it is full.
+
+'pushed' is set to 1 if the node was linked, or 0 if the queue is closed (the
+node is left as it was).
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'queue' : Pointer to a queue.
+[in] 'node' : Pointer to a node that is not part of a list.
+[out] 'pushed' : An int variable.
+*/
+#define WORK_QUEUE_PUSH(queue, node, pushed)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    (pushed) = 0; \
+    if((queue) && (node) && !(node)->parent) { \
+        WORK_QUEUE_SPIN_WHILE_((queue), \
+            GENERIC_ATOMIC_LOAD_SIZE((queue)->approx_count) \
+                >= (queue)->capacity); \
+        GENERIC_MUTEX_LOCK_((queue)->mutex); \
+        while(((queue)->items.count >= (queue)->capacity) \
+            && !(queue)->closed) \
+        { \
+            ++(queue)->sleeping_producers; \
+            GENERIC_COND_WAIT_((queue)->not_full, (queue)->mutex); \
+            --(queue)->sleeping_producers; \
+        } \
+        if(!(queue)->closed) { \
+            LINK_NODE_LAST((node), &(queue)->items); \
+            GENERIC_ATOMIC_STORE_SIZE((queue)->approx_count, \
+                (queue)->items.count); \
+            if((queue)->sleeping_consumers) { \
+                GENERIC_COND_SIGNAL_((queue)->not_empty); \
+            } \
+            (pushed) = 1; \
+        } \
+        GENERIC_MUTEX_UNLOCK_((queue)->mutex); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* WORK_QUEUE_POP
+Unlink the head node of the queue, waiting while it is empty.
+
+'node' is set to the unlinked node, or NULL if the queue is closed and empty.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'queue' : Pointer to a queue.
+[out] 'node' : Node pointer variable that receives the popped node.
+*/
+#define WORK_QUEUE_POP(queue, node)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    (node) = NULL; \
+    if((queue)) { \
+        WORK_QUEUE_SPIN_WHILE_((queue), \
+            !GENERIC_ATOMIC_LOAD_SIZE((queue)->approx_count)); \
+        GENERIC_MUTEX_LOCK_((queue)->mutex); \
+        while(!(queue)->items.head && !(queue)->closed) { \
+            ++(queue)->sleeping_consumers; \
+            GENERIC_COND_WAIT_((queue)->not_empty, (queue)->mutex); \
+            --(queue)->sleeping_consumers; \
+        } \
+        if((queue)->items.head) { \
+            (node) = (queue)->items.head; \
+            UNLINK_NODE((node)); \
+            GENERIC_ATOMIC_STORE_SIZE((queue)->approx_count, \
+                (queue)->items.count); \
+            if((queue)->sleeping_producers) { \
+                GENERIC_COND_SIGNAL_((queue)->not_full); \
+            } \
+        } \
+        GENERIC_MUTEX_UNLOCK_((queue)->mutex); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* WORK_QUEUE_POP_BATCH
+Move up to N nodes from the head of the queue to a list, waiting while it is
+empty.
+
+The nodes are linked to the end of 'list' in queue order, all in one critical
+section. If the queue holds at most 'max_n' nodes they are all moved in O(1)
+with STITCH_LIST_LAST and then adopted with ADOPT_LIST_NODES after the mutex is
+released, which walks all of 'list'. Otherwise each node is moved with
+LINK_NODE_LAST. Nothing is moved if the queue is closed and empty, so a caller
+that passes an empty list can stop when it is still empty.
+
+The input parameters below are evaluated multiple times because this is a
+generic function-like macro. The parameters must not have side effects or
+access the list.
+
+[in] 'queue' : Pointer to a queue.
+[in] 'list' : Pointer to a list that only the caller is using.
+[in] 'max_n' : The maximum number of nodes to move.
+*/
+#define WORK_QUEUE_POP_BATCH(queue, list, max_n)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((queue) && (list) && (max_n)) { \
+        size_t generic_batch_; \
+        int generic_adopt_; \
+        WORK_QUEUE_SPIN_WHILE_((queue), \
+            !GENERIC_ATOMIC_LOAD_SIZE((queue)->approx_count)); \
+        GENERIC_MUTEX_LOCK_((queue)->mutex); \
+        while(!(queue)->items.head && !(queue)->closed) { \
+            ++(queue)->sleeping_consumers; \
+            GENERIC_COND_WAIT_((queue)->not_empty, (queue)->mutex); \
+            --(queue)->sleeping_consumers; \
+        } \
+        generic_batch_ = 0; \
+        generic_adopt_ = 0; \
+        if((queue)->items.head \
+            && ((queue)->items.count <= (size_t)(max_n))) \
+        { \
+            generic_batch_ = (queue)->items.count; \
+            STITCH_LIST_LAST((list), &(queue)->items); \
+            if((queue)->items.head) { \
+                generic_batch_ = 0; \
+            } \
+            else { \
+                generic_adopt_ = 1; \
+            } \
+        } \
+        for(; (generic_batch_ < (size_t)(max_n)) && (queue)->items.head \
+                && ((list)->count != (size_t)-1); \
+            ++generic_batch_) \
+        { \
+            (queue)->moving.head = (queue)->items.head; \
+            LINK_NODE_LAST((queue)->moving.head, (list)); \
+        } \
+        (queue)->moving.head = NULL; \
+        if(generic_batch_) { \
+            GENERIC_ATOMIC_STORE_SIZE((queue)->approx_count, \
+                (queue)->items.count); \
+            if((queue)->sleeping_producers) { \
+                if(generic_batch_ > 1) { \
+                    GENERIC_COND_BROADCAST_((queue)->not_full); \
+                } \
+                else { \
+                    GENERIC_COND_SIGNAL_((queue)->not_full); \
+                } \
+            } \
+        } \
+        GENERIC_MUTEX_UNLOCK_((queue)->mutex); \
+        if(generic_adopt_) { \
+            ADOPT_LIST_NODES((list)); \
+        } \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+
+/* WORK_QUEUE_CLOSE
+Close a queue and wake every waiting thread.
+
+Pushes fail from then on. Pops still return the nodes that are left and then
+return nothing instead of waiting.
+
+[in] 'queue' : Pointer to a queue.
+*/
+#define WORK_QUEUE_CLOSE(queue)   \
+MS_INLINE_PRAGMA(warning(push)) \
+MS_INLINE_PRAGMA(warning(disable:4127)) \
+do { \
+    if((queue)) { \
+        GENERIC_MUTEX_LOCK_((queue)->mutex); \
+        (queue)->closed = 1; \
+        GENERIC_COND_BROADCAST_((queue)->not_empty); \
+        GENERIC_COND_BROADCAST_((queue)->not_full); \
+        GENERIC_MUTEX_UNLOCK_((queue)->mutex); \
+    } \
+} while(0) \
+MS_INLINE_PRAGMA(warning(pop))
+
+#endif /* GENERIC_WORK_QUEUE_H_ */
@@ -0,0 +1,168 @@
+/*
+Copyright (C) 2014-2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+This file is part of generic_list.
+
+https://github.com/jay/generic_list
+
+generic_list is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+generic_list is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with generic_list. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** Latency histograms of the list macros
+*/
+
+#include "latency.hpp"
+
+#include <stdint.h>
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "util.hpp"
+
+
+using namespace std;
+
+
+thread_local latency_histogram *thread_latency;
+
+
+latency_histogram::latency_histogram()
+{
+    for( size_t i = 0; i < BUCKETS; ++i )
+        counts[ i ].store( 0, memory_order_relaxed );
+    sum.store( 0, memory_order_relaxed );
+}
+
+
+/* Values below SUB_COUNT have a bucket each. Above that each power of two from 2^SUB_BITS up is
+split into SUB_COUNT buckets by the SUB_BITS bits below the highest set bit.
+*/
+size_t latency_histogram::index( uint64_t ns )
+{
+    if( ns < SUB_COUNT )
+        return (size_t)ns;
+
+    unsigned msb = 0;
+    for( uint64_t v = ns; v >>= 1; )
+        ++msb;
+
+    unsigned shift = msb - SUB_BITS;
+    return (size_t)( ( msb - SUB_BITS + 1 ) * SUB_COUNT + ( ( ns >> shift ) & ( SUB_COUNT - 1 ) ) );
+}
+
+
+uint64_t latency_histogram::highest_equivalent( size_t index )
+{
+    if( index < SUB_COUNT )
+        return index;
+
+    unsigned shift = (unsigned)( index / SUB_COUNT - 1 );
+    uint64_t lowest = (uint64_t)( SUB_COUNT + index % SUB_COUNT ) << shift;
+    return lowest + ( ( (uint64_t)1 << shift ) - 1 );
+}
+
+
+latency_snapshot::latency_snapshot()
+    : counts( latency_histogram::BUCKETS ), sum( 0 ), total( 0 )
+{
+}
+
+
+void latency_snapshot::add( const vector<latency_histogram> &histograms, size_t first,
+    size_t stride )
+{
+    for( size_t h = first; h < histograms.size(); h += stride )
+    {
+        for( size_t i = 0; i < counts.size(); ++i )
+        {
+            uint64_t n = histograms[ h ].counts[ i ].load( memory_order_relaxed );
+            counts[ i ] += n;
+            total += n;
+        }
+        sum += histograms[ h ].sum.load( memory_order_relaxed );
+    }
+}
+
+
+latency_snapshot latency_snapshot::operator-( const latency_snapshot &earlier ) const
+{
+    latency_snapshot d;
+    for( size_t i = 0; i < counts.size(); ++i )
+    {
+        d.counts[ i ] = counts[ i ] - earlier.counts[ i ];
+        d.total += d.counts[ i ];
+    }
+    d.sum = sum - earlier.sum;
+    return d;
+}
+
+
+uint64_t latency_snapshot::percentile( double p ) const
+{
+    if( !total )
+        return 0;
+
+    // the rank of the value, at least 1 so that percentile 0 is the lowest value
+    uint64_t rank = (uint64_t)( p / 100 * (double)total + 0.5 );
+    if( rank < 1 )
+        rank = 1;
+    if( rank > total )
+        rank = total;
+
+    uint64_t seen = 0;
+    for( size_t i = 0; i < counts.size(); ++i )
+    {
+        seen += counts[ i ];
+        if( seen >= rank )
+            return latency_histogram::highest_equivalent( i );
+    }
+    return 0;
+}
+
+
+vector<latency_snapshot> latency_snapshots( const vector<latency_histogram> &histograms )
+{
+    vector<latency_snapshot> snapshots( LATENCY_OPS );
+    for( size_t op = 0; op < LATENCY_OPS; ++op )
+        snapshots[ op ].add( histograms, op, LATENCY_OPS );
+    return snapshots;
+}
+
+
+string latency_summary( const vector<latency_snapshot> &snapshots )
+{
+    static const double percentiles[] = { 50, 90, 99, 99.9, 100 };
+
+    stringstream ss;
+    ss << "  " << left << setw( 8 ) << "op" << right << setw( 16 ) << "count" << setw( 9 )
+        << "mean" << setw( 9 ) << "p50" << setw( 9 ) << "p90" << setw( 9 ) << "p99" << setw( 9 )
+        << "p99.9" << setw( 9 ) << "max" << endl;
+
+    for( size_t op = 0; op < snapshots.size(); ++op )
+    {
+        const latency_snapshot &s = snapshots[ op ];
+        ss << "  " << left << setw( 8 ) << op_names[ op ] << right << setw( 16 )
+            << FormatWithCommas<uint64_t>( s.count() ) << setw( 9 ) << fixed << setprecision( 1 )
+            << s.mean();
+        for( size_t i = 0; i < sizeof( percentiles ) / sizeof( percentiles[ 0 ] ); ++i )
+            ss << setw( 9 ) << s.percentile( percentiles[ i ] );
+        ss << endl;
+    }
+
+    return ss.str();
+}
@@ -0,0 +1,133 @@
+/*
+Copyright (C) 2014-2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+This file is part of generic_list.
+
+https://github.com/jay/generic_list
+
+generic_list is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+generic_list is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with generic_list. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STRESSTEST_LATENCY_
+#define STRESSTEST_LATENCY_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "workload.hpp"
+
+
+/* Latency histograms of the list macros
+
+Each worker thread times every link and unlink macro it runs, without the checks around it, and
+counts the time in a histogram of its own for each operation. The histograms are HDR style: the
+buckets are log-linear with 32 sub-buckets for each power of two, so a value is recorded to within
+about 3% from a nanosecond up to the full 64-bit range with no configuration, and the percentiles
+are computed from the buckets.
+
+A time includes one read of the steady clock, a few tens of nanoseconds on most systems and more
+than most macros take, but the cost is constant so a change in a macro still shows.
+
+A thread is the only writer of its histograms. The counts are relaxed atomics so that the main
+thread can read them at any time for a summary without a lock or a slower increment.
+
+--stats=SECONDS    Print a summary of the counts and latencies since the previous summary every
+                   SECONDS (default 10) and an overall one at the end. 0 doesn't time the macros.
+*/
+
+// the timed operations, UNLINK to AFTER
+enum { LATENCY_OPS = OP_AFTER + 1 };
+
+class latency_histogram
+{
+public:
+    enum { SUB_BITS = 5, SUB_COUNT = 1 << SUB_BITS, BUCKETS = ( 64 - SUB_BITS + 1 ) * SUB_COUNT };
+
+    latency_histogram();
+
+    // Called only by the thread that owns the histogram
+    void record( uint64_t ns )
+    {
+        std::atomic<uint64_t> &bucket = counts[ index( ns ) ];
+        bucket.store( bucket.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+        sum.store( sum.load( std::memory_order_relaxed ) + ns, std::memory_order_relaxed );
+    }
+
+    // The bucket of a value and the highest value that's counted in a bucket
+    static size_t index( uint64_t ns );
+    static uint64_t highest_equivalent( size_t index );
+
+private:
+    friend class latency_snapshot;
+    std::atomic<uint64_t> counts[ BUCKETS ];
+    std::atomic<uint64_t> sum;
+};
+
+/* The counts of one operation's histograms summed over threads, at the time they were read.
+Subtracting an earlier snapshot leaves the operations recorded between the two.
+*/
+class latency_snapshot
+{
+public:
+    latency_snapshot();
+    // Add the histograms 'first', 'first' + 'stride' and so on, ie one operation's of each thread
+    void add( const std::vector<latency_histogram> &histograms, size_t first, size_t stride );
+    latency_snapshot operator-( const latency_snapshot &earlier ) const;
+
+    uint64_t count() const { return total; }
+    double mean() const { return total ? (double)sum / (double)total : 0; }
+    // The value at a percentile, 0 to 100. 100 is the highest value recorded.
+    uint64_t percentile( double p ) const;
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t sum, total;
+};
+
+/* Snapshots of each operation over the histograms of every thread. The histogram of operation
+'op' of thread 't' is histograms[ t * LATENCY_OPS + op ].
+*/
+std::vector<latency_snapshot> latency_snapshots( const std::vector<latency_histogram> &histograms );
+
+// A table of the count, mean and percentiles of each operation in nanoseconds
+std::string latency_summary( const std::vector<latency_snapshot> &snapshots );
+
+
+// The calling thread's histograms, NULL if the macros aren't timed
+extern thread_local latency_histogram *thread_latency;
+
+// The start time of a macro, or nothing if the macros aren't timed
+inline std::chrono::steady_clock::time_point latency_start()
+{
+    return thread_latency ? std::chrono::steady_clock::now()
+        : std::chrono::steady_clock::time_point();
+}
+
+// Record the time since the start of the macro
+inline void latency_stop( int op, std::chrono::steady_clock::time_point start )
+{
+    if( thread_latency )
+    {
+        thread_latency[ op ].record( (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start ).count() );
+    }
+}
+
+#endif // STRESSTEST_LATENCY_
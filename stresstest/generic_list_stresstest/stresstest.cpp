@@ -21,37 +21,67 @@ along with generic_list. If not, see <http://www.gnu.org/licenses/>.
 */
 
 /** Stresstest for generic_list
-Expects a temporary ramdisk on drive T. Refer to drive variable in main().
+The state of each thread's random number generator before its current and previous iteration is
+kept in memory and written to files only when an iteration fails, refer to SaveErrorState().
+
+stresstest [--threads=N] [--iterations=N] [--stats=SECONDS]
+           [--shadow=N [--check-every=N] [--record=PREFIX] [workload options]] [state file]
+stresstest --threads=N --rcu=N [--iterations=N]
+
+Each worker thread runs iterations independently with its own mersenne twister, until one of them
+fails or each has run 'iterations' (default unlimited). The default is one thread. --shadow runs
+long-lived lists of up to N nodes checked against a shadow model instead, refer to shadow_model,
+with a workload that's set by the options in workload.hpp. --rcu runs one writer and N-1 lock-free
+readers on one shared list instead, refer to run_rcu.
+
+The link and unlink macros are timed apart from the checks and a summary of their latencies is
+printed every --stats seconds, refer to latency.hpp.
 */
 
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <list>
+#include <mutex>
 #include <random>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "latency.hpp"
 #include "strerror.hpp"
 #include "util.hpp"
+#include "workload.hpp"
 
 #include "generic_list.h"
+#include "generic_rcu_list.h"
+#include "generic_epoch.h"
+#include "tools/list_optrace.h"
 
 
 using namespace std;
 
 
+#ifdef _WIN32
 static void pause( void )
 {
         system( "pause" );
         return;
 }
+#endif
 
 void init()
 {
+#ifdef _WIN32
     /* If the program is started in its own window then pause before exit
     (eg user clicks on program in explorer, or vs debugger initiated program)
     */
@@ -79,6 +109,7 @@ void init()
             atexit( pause );
         }
     }
+#endif
 
     util_init();
 }
@@ -159,12 +190,91 @@ bool sanity_check_list( my_list *list )
 }
 
 
+// Hide random nodes and then restore them in reverse order
+bool hide_and_restore_nodes( my_list *list )
+{
+    DEBUG_IF( !list, "Missing list" );
+
+    const size_t count = list->count;
+    vector<my_node *> hidden;
+
+    unsigned max_hide_count = getrand<unsigned>( 0, (unsigned)count );
+    for( unsigned i = 0; i < max_hide_count; ++i )
+    {
+        my_node *node = list->head;
+        unsigned pos_node = getrand<unsigned>( 0, (unsigned)list->count - 1 );
+        for( unsigned j = 0; j < pos_node; ++j )
+        {
+            node = node->next;
+        }
+
+        HIDE_NODE( node );
+        hidden.push_back( node );
+
+        DEBUG_IF( node->parent != list,
+            "node was not properly hidden, its parent was changed."
+            << " list: 0x" << list
+            << ", node: 0x" << node
+            << ", node->parent: 0x" << node->parent
+            << " (" << "HIDE" << ")"
+            );
+
+        for( my_node *p = list->head; p; p = p->next )
+        {
+            DEBUG_IF( p == node,
+                "node should have been hidden but was found in the list."
+                << " list: 0x" << list
+                << ", node: 0x" << node
+                << " (" << "HIDE" << ")"
+                );
+        }
+
+        if( !sanity_check_list( list ) )
+            return false;
+    }
+
+    while( hidden.size() )
+    {
+        my_node *node = hidden.back();
+        hidden.pop_back();
+
+        RESTORE_NODE( node );
+
+        DEBUG_IF( ( node->prev ? node->prev->next : list->head ) != node
+                || ( node->next ? node->next->prev : list->tail ) != node,
+            "node was not properly restored to the list."
+            << " list: 0x" << list
+            << ", list->head: 0x" << list->head
+            << ", list->tail: 0x" << list->tail
+            << ", node: 0x" << node
+            << ", node->prev: 0x" << node->prev
+            << ", node->next: 0x" << node->next
+            << " (" << "RESTORE" << ")"
+            );
+
+        if( !sanity_check_list( list ) )
+            return false;
+    }
+
+    DEBUG_IF( list->count != count,
+        "list->count was not restored."
+        << " list: 0x" << list
+        << ", list->count: " << list->count
+        << ", expected: " << count
+        << " (" << "RESTORE" << ")"
+        );
+
+    return true;
+}
+
+
 // Generate a list and randomly modify its contents
 bool generate_and_modify_list()
 {
     my_list *list = NULL;
-    DEBUG_IF( !( list = (my_list *)calloc( 1, sizeof my_list ) ), "Out of memory" );
-    sanity_check_list( list );
+    DEBUG_IF( !( list = (my_list *)calloc( 1, sizeof( my_list ) ) ), "Out of memory" );
+    if( !sanity_check_list( list ) )
+        return false;
 
     unsigned max_loop_count = getrand<unsigned>(0, 10);
 
@@ -174,7 +284,7 @@ bool generate_and_modify_list()
         unsigned pos_node = 0, pos_position_node = 0;
 
         enum e_link { UNLINK, FIRST, LAST, BEFORE, AFTER };
-        char *e_link_names[] = { "UNLINK", "FIRST", "LAST", "BEFORE", "AFTER" };
+        const char *e_link_names[] = { "UNLINK", "FIRST", "LAST", "BEFORE", "AFTER" };
         // If there's no head there are no nodes so we can't link BEFORE or AFTER
         e_link link = list->head
             ? e_link( getrand<int>( (int)e_link( UNLINK ), (int)e_link( AFTER ) ) )
@@ -208,14 +318,19 @@ bool generate_and_modify_list()
         }
         else // NEW_NODE
         {
-            DEBUG_IF( !( node = (my_node *)calloc( 1, sizeof my_node ) ),
+            DEBUG_IF( !( node = (my_node *)calloc( 1, sizeof( my_node ) ) ),
                 "Out of memory" );
         }
 
+        // only the macros are timed
+        chrono::steady_clock::time_point start;
+
         switch(link)
         {
         case UNLINK:
+            start = latency_start();
             UNLINK_NODE( node );
+            latency_stop( link, start );
             DEBUG_IF( node->next || node->prev || node->parent,
                 "node was not properly unlinked from the list."
                 << " list: 0x" << list
@@ -228,7 +343,9 @@ bool generate_and_modify_list()
                 );
             break;
         case FIRST:
+            start = latency_start();
             LINK_NODE_FIRST( node, list );
+            latency_stop( link, start );
             DEBUG_IF( list != node->parent || list->head != node
                     || ( list->count == 1 && list->tail != node ),
                 "node was not properly linked to the list."
@@ -242,7 +359,9 @@ bool generate_and_modify_list()
                 );
             break;
         case LAST:
+            start = latency_start();
             LINK_NODE_LAST( node, list );
+            latency_stop( link, start );
             DEBUG_IF( list != node->parent || list->tail != node
                     || ( list->count == 1 && list->head != node ),
                 "node was not properly linked to the list."
@@ -256,7 +375,9 @@ bool generate_and_modify_list()
                 );
             break;
         case BEFORE:
+            start = latency_start();
             LINK_NODE_BEFORE( node, position_node );
+            latency_stop( link, start );
             DEBUG_IF( position_node != node
                     && ( ( position_node->prev != node || node->next != position_node )
                         || ( list->count == 1 && ( list->head != node || list->tail != node ) )
@@ -272,7 +393,9 @@ bool generate_and_modify_list()
                 );
             break;
         case AFTER:
+            start = latency_start();
             LINK_NODE_AFTER( node, position_node );
+            latency_stop( link, start );
             DEBUG_IF( position_node != node
                     && ( ( position_node->next != node || node->prev != position_node )
                         || ( list->count == 1 && ( list->head != node || list->tail != node ) )
@@ -318,7 +441,14 @@ bool generate_and_modify_list()
             node = NULL;
         }
 
-        sanity_check_list( list );
+        if( !sanity_check_list( list ) )
+            return false;
+
+        if( list->head && getrand<bool>() )
+        {
+            if( !hide_and_restore_nodes( list ) )
+                return false;
+        }
     }
 
     for( my_node *p = list->head; p; /**/ )
@@ -335,16 +465,810 @@ bool generate_and_modify_list()
 }
 
 
-size_t iteration;
-stringstream mersenne_state_initial, mersenne_state_iteration, mersenne_state_iteration_prev;
+thread_local size_t iteration;
+thread_local mt19937 mersenne_state_initial, mersenne_state_iteration,
+    mersenne_state_iteration_prev;
+
+// the iterations completed by all threads
+atomic<size_t> total_iterations( 0 );
+
+// set when any thread fails so the others stop
+atomic<bool> failed( false );
+
+// the nodes in the shadow model mode, 0 if the mode is off
+size_t shadow_capacity = 0;
+
+// the operations between two full checks in the shadow model mode
+size_t shadow_check_every = 0;
+
+// the keys of the shared list in the RCU mode, 0 if the mode is off
+size_t rcu_capacity = 0;
+
+// the workload of the shadow model mode, refer to workload.hpp
+workload shadow_workload;
+
+// the prefix of the operation trace files of the shadow model mode, empty if not recorded
+string record_prefix;
+
+// the calling thread's operation trace file, refer to tools/list_optrace.h
+thread_local FILE *op_trace;
+
+static_assert( (int)OP_UNLINK == (int)LIST_OPTRACE_UNLINK
+    && (int)OP_FIRST == (int)LIST_OPTRACE_FIRST && (int)OP_LAST == (int)LIST_OPTRACE_LAST
+    && (int)OP_BEFORE == (int)LIST_OPTRACE_BEFORE && (int)OP_AFTER == (int)LIST_OPTRACE_AFTER
+    && (int)OP_HIDE == (int)LIST_OPTRACE_HIDE,
+    "The workload operations must have the values of the trace operations." );
+
+
+/* Shadow model mode (--shadow=N)
+
+A worker links, unlinks, moves, hides and restores nodes from a pool of N nodes in long-lived lists
+as the workload says, two lists with every operation on uniformly picked nodes by default, and
+mirrors every operation in a model that keeps the expected prev, next and list of each
+node as pool indexes. After each operation only the nodes whose links changed and the two lists
+are compared to the model, which is O(1), so the lists can grow to millions of nodes. Every
+'shadow_check_every' operations (default N) both lists are checked in full by sanity_check_list
+and a walk that compares every node to the model. Nodes and positions are picked in O(1).
+
+An iteration is one operation. The list state depends on every earlier operation, so a failure is
+reproduced by passing the failed thread's initial state back with one thread and the same --shadow:
+it fails again at the same iteration. With --record=PREFIX each thread also writes the operations
+it does to PREFIX_threadN.glops before it does them, and tools/list_replay runs that trace without
+the random number generator, optionally stopping at any operation.
+*/
+struct shadow_model
+{
+    static const size_t none = SIZE_MAX;
+
+    vector<my_node> pool;
+    vector<my_list> lists;
+
+    // the expected links of each pool node as pool indexes, and the index of its list
+    vector<size_t> prev, next, owner;
+    vector<size_t> head, tail, count;
+
+    // the linked nodes in any order and the position of each in it, for O(1) random picks
+    vector<size_t> linked, linked_pos;
+
+    shadow_model( size_t capacity, size_t list_count )
+        : pool( capacity ), lists( list_count ), prev( capacity, none ), next( capacity, none ),
+        owner( capacity, none ), head( list_count, none ), tail( list_count, none ),
+        count( list_count, 0 ), linked_pos( capacity, none )
+    {
+        for( size_t i = 0; i < capacity; ++i )
+        {
+            ZERO_OUT_NODE_MEMBERS( &pool[ i ] );
+        }
+        for( size_t l = 0; l < list_count; ++l )
+        {
+            ZERO_OUT_LIST_MEMBERS( &lists[ l ] );
+        }
+        linked.reserve( capacity );
+    }
+
+    my_node *node_ptr( size_t id )
+    {
+        return ( id == none ) ? NULL : &pool[ id ];
+    }
+
+    my_list *list_ptr( size_t l )
+    {
+        return ( l == none ) ? NULL : &lists[ l ];
+    }
+
+    void unlink( size_t id )
+    {
+        size_t l = owner[ id ];
+        if( l == none )
+            return;
+
+        if( prev[ id ] != none )
+            next[ prev[ id ] ] = next[ id ];
+        else
+            head[ l ] = next[ id ];
+
+        if( next[ id ] != none )
+            prev[ next[ id ] ] = prev[ id ];
+        else
+            tail[ l ] = prev[ id ];
+
+        --count[ l ];
+        prev[ id ] = next[ id ] = owner[ id ] = none;
+
+        size_t moved = linked.back();
+        linked[ linked_pos[ id ] ] = moved;
+        linked_pos[ moved ] = linked_pos[ id ];
+        linked.pop_back();
+        linked_pos[ id ] = none;
+    }
+
+    // link an unlinked node between 'p' and 'n' in list 'l'
+    void link( size_t id, size_t l, size_t p, size_t n )
+    {
+        prev[ id ] = p;
+        next[ id ] = n;
+        owner[ id ] = l;
+
+        if( p != none )
+            next[ p ] = id;
+        else
+            head[ l ] = id;
+
+        if( n != none )
+            prev[ n ] = id;
+        else
+            tail[ l ] = id;
+
+        ++count[ l ];
+        linked_pos[ id ] = linked.size();
+        linked.push_back( id );
+    }
+
+    // The model of each macro, including the cases in which the macro does nothing.
+
+    void link_first( size_t id, size_t l )
+    {
+        if( head[ l ] == id )
+            return;
+        unlink( id );
+        link( id, l, none, head[ l ] );
+    }
+
+    void link_last( size_t id, size_t l )
+    {
+        if( tail[ l ] == id )
+            return;
+        unlink( id );
+        link( id, l, tail[ l ], none );
+    }
+
+    void link_before( size_t id, size_t position )
+    {
+        if( id == position )
+            return;
+        unlink( id );
+        link( id, owner[ position ], prev[ position ], position );
+    }
+
+    void link_after( size_t id, size_t position )
+    {
+        if( id == position )
+            return;
+        unlink( id );
+        link( id, owner[ position ], position, next[ position ] );
+    }
+};
+
+
+// true if the node's links and list are the ones in the model
+bool shadow_check_node( shadow_model &m, size_t id, const char *op )
+{
+    if( id == shadow_model::none )
+        return true;
+
+    my_node *node = &m.pool[ id ];
+
+    DEBUG_IF( node->prev != m.node_ptr( m.prev[ id ] )
+            || node->next != m.node_ptr( m.next[ id ] )
+            || node->parent != m.list_ptr( m.owner[ id ] ),
+        "node is not linked as in the shadow model."
+        << " node: 0x" << node
+        << ", node->prev: 0x" << node->prev
+        << ", node->next: 0x" << node->next
+        << ", node->parent: 0x" << node->parent
+        << ", expected prev: 0x" << m.node_ptr( m.prev[ id ] )
+        << ", next: 0x" << m.node_ptr( m.next[ id ] )
+        << ", parent: 0x" << m.list_ptr( m.owner[ id ] )
+        << " (" << op << ")"
+        );
+
+    return true;
+}
+
+
+// true if the head, tail and count of the lists are the ones in the model
+bool shadow_check_lists( shadow_model &m, const char *op )
+{
+    for( size_t l = 0; l < m.lists.size(); ++l )
+    {
+        my_list *list = &m.lists[ l ];
+
+        DEBUG_IF( list->head != m.node_ptr( m.head[ l ] )
+                || list->tail != m.node_ptr( m.tail[ l ] )
+                || list->count != m.count[ l ],
+            "list is not as in the shadow model."
+            << " list: 0x" << list
+            << ", list->head: 0x" << list->head
+            << ", list->tail: 0x" << list->tail
+            << ", list->count: " << list->count
+            << ", expected head: 0x" << m.node_ptr( m.head[ l ] )
+            << ", tail: 0x" << m.node_ptr( m.tail[ l ] )
+            << ", count: " << m.count[ l ]
+            << " (" << op << ")"
+            );
+    }
+
+    return true;
+}
+
+
+// true if the lists are sane and every node is in the order of the model
+bool shadow_check_all( shadow_model &m )
+{
+    for( size_t l = 0; l < m.lists.size(); ++l )
+    {
+        my_list *list = &m.lists[ l ];
+
+        if( !sanity_check_list( list ) )
+            return false;
+
+        size_t id = m.head[ l ];
+        for( my_node *node = list->head; node; node = node->next, id = m.next[ id ] )
+        {
+            DEBUG_IF( node != m.node_ptr( id ),
+                "list order is not as in the shadow model."
+                << " list: 0x" << list
+                << ", node: 0x" << node
+                << ", expected: 0x" << m.node_ptr( id )
+                );
+        }
+    }
+
+    return shadow_check_lists( m, "FULL" );
+}
+
+
+// Hide random linked nodes and restore them in reverse order, checking each step locally
+bool shadow_hide_and_restore( shadow_model &m )
+{
+    size_t hidden[ 8 ];
+    unsigned hide_count = getrand<unsigned>( 1, 8 ), n = 0, hidden_count;
+
+    for( unsigned i = 0; i < hide_count; ++i )
+    {
+        size_t id = m.linked[ getrand<size_t>( 0, m.linked.size() - 1 ) ];
+        bool again = false;
+        for( unsigned j = 0; j < n; ++j )
+        {
+            again = again || ( hidden[ j ] == id );
+        }
+        if( !again )
+            hidden[ n++ ] = id;
+    }
+
+    if( op_trace )
+    {
+        list_optrace_put( op_trace, LIST_OPTRACE_HIDE );
+        list_optrace_put( op_trace, n );
+        for( unsigned i = 0; i < n; ++i )
+        {
+            list_optrace_put( op_trace, hidden[ i ] );
+        }
+    }
+
+    for( unsigned i = 0; i < n; ++i )
+    {
+        my_node *node = &m.pool[ hidden[ i ] ];
+        my_list *list = node->parent;
+        HIDE_NODE( node );
+
+        DEBUG_IF( node->parent != list
+                || ( node->prev ? node->prev->next : list->head ) != node->next
+                || ( node->next ? node->next->prev : list->tail ) != node->prev,
+            "node was not properly hidden."
+            << " list: 0x" << list
+            << ", node: 0x" << node
+            << ", node->prev: 0x" << node->prev
+            << ", node->next: 0x" << node->next
+            << ", node->parent: 0x" << node->parent
+            << " (" << "HIDE" << ")"
+            );
+    }
+
+    for( hidden_count = n; n; )
+    {
+        my_node *node = &m.pool[ hidden[ --n ] ];
+        RESTORE_NODE( node );
+    }
+
+    // the model doesn't change, a hide and restore in reverse order is no change
+    for( unsigned i = 0; i < hidden_count; ++i )
+    {
+        size_t id = hidden[ i ];
+        if( !shadow_check_node( m, id, "RESTORE" )
+            || !shadow_check_node( m, m.prev[ id ], "RESTORE" )
+            || !shadow_check_node( m, m.next[ id ], "RESTORE" ) )
+        {
+            return false;
+        }
+    }
+
+    return shadow_check_lists( m, "RESTORE" );
+}
+
+
+// Pick the node to unlink as the workload says, which may be an unlinked node
+size_t shadow_pick_unlink( shadow_model &m, workload_picker &picker, size_t l )
+{
+    if( shadow_workload.unlink_from == workload::UNLINK_HEAD && m.head[ l ] != shadow_model::none )
+        return m.head[ l ];
+
+    if( shadow_workload.unlink_from == workload::UNLINK_TAIL && m.tail[ l ] != shadow_model::none )
+        return m.tail[ l ];
+
+    return picker.pick_node();
+}
+
+
+// Do one operation of the workload on the lists and the model and check the affected nodes
+bool shadow_step( shadow_model &m, workload_picker &picker )
+{
+    e_op op = picker.pick_op();
+    size_t l = getrand<size_t>( 0, m.lists.size() - 1 );
+    size_t id = picker.pick_node();
+
+    // hold the number of linked nodes at the target
+    if( shadow_workload.target )
+    {
+        if( op == OP_UNLINK && m.linked.size() < shadow_workload.target )
+            op = OP_LAST;
+        else if( op != OP_UNLINK && op != OP_HIDE && m.owner[ id ] == shadow_model::none
+            && m.linked.size() >= shadow_workload.target )
+        {
+            op = OP_UNLINK;
+        }
+    }
+
+    // there must be a linked node to position before or after, or to hide
+    if( m.linked.empty() && op >= OP_BEFORE )
+        op = OP_FIRST;
+
+    if( op == OP_HIDE )
+        return shadow_hide_and_restore( m );
+
+    if( op == OP_UNLINK )
+        id = shadow_pick_unlink( m, picker, l );
+
+    size_t position = shadow_model::none;
+    if( op == OP_BEFORE || op == OP_AFTER )
+    {
+        position = picker.pick_node();
+        if( m.owner[ position ] == shadow_model::none )
+            position = m.linked[ getrand<size_t>( 0, m.linked.size() - 1 ) ];
+    }
+
+    /* the nodes whose links may change: the node and its old and new neighbours. The position
+    node is always one of the new neighbours, or the node itself if nothing is done. */
+    size_t affected[ 5 ] = { id, m.prev[ id ], m.next[ id ], shadow_model::none, shadow_model::none };
+    my_node *node = &m.pool[ id ];
+    my_node *position_node = m.node_ptr( position );
+    my_list *list = &m.lists[ l ];
+
+    // the op values are the same as in the trace format
+    if( op_trace )
+    {
+        list_optrace_put( op_trace, op );
+        if( op == OP_FIRST || op == OP_LAST )
+            list_optrace_put( op_trace, l );
+        list_optrace_put( op_trace, id );
+        if( position != shadow_model::none )
+            list_optrace_put( op_trace, position );
+    }
+
+    // only the macros are timed
+    chrono::steady_clock::time_point start;
+
+    switch( op )
+    {
+    case OP_UNLINK:
+        start = latency_start();
+        UNLINK_NODE( node );
+        latency_stop( op, start );
+        m.unlink( id );
+        break;
+    case OP_FIRST:
+        start = latency_start();
+        LINK_NODE_FIRST( node, list );
+        latency_stop( op, start );
+        m.link_first( id, l );
+        break;
+    case OP_LAST:
+        start = latency_start();
+        LINK_NODE_LAST( node, list );
+        latency_stop( op, start );
+        m.link_last( id, l );
+        break;
+    case OP_BEFORE:
+        start = latency_start();
+        LINK_NODE_BEFORE( node, position_node );
+        latency_stop( op, start );
+        m.link_before( id, position );
+        break;
+    default:
+        start = latency_start();
+        LINK_NODE_AFTER( node, position_node );
+        latency_stop( op, start );
+        m.link_after( id, position );
+        break;
+    }
+
+    affected[ 3 ] = m.prev[ id ];
+    affected[ 4 ] = m.next[ id ];
+
+    for( int i = 0; i < 5; ++i )
+    {
+        if( !shadow_check_node( m, affected[ i ], op_names[ op ] ) )
+            return false;
+    }
+
+    return shadow_check_lists( m, op_names[ op ] );
+}
+
+
+// Run shadow model operations on the calling thread until any thread fails or 'max_iterations'
+bool run_shadow( size_t max_iterations )
+{
+    shadow_model m( shadow_capacity, shadow_workload.lists );
+    workload_picker picker( shadow_workload, shadow_capacity );
+
+    // closes the trace file however the worker returns, so it ends with the failed operation
+    struct trace_closer
+    {
+        ~trace_closer()
+        {
+            if( op_trace )
+                fclose( op_trace );
+            op_trace = NULL;
+        }
+    } closer;
+
+    if( !record_prefix.empty() )
+    {
+        stringstream ss;
+        ss << record_prefix << "_thread" << thread_number << ".glops";
+        op_trace = fopen( ss.str().c_str(), "wb" );
+        DEBUG_IF( !op_trace, "Failed to create the operation trace " << ss.str() );
+        fputs( LIST_OPTRACE_MAGIC, op_trace );
+        list_optrace_put( op_trace, shadow_capacity );
+        list_optrace_put( op_trace, shadow_workload.lists );
+    }
+    size_t check_every = shadow_check_every ? shadow_check_every : shadow_capacity;
+    size_t unreported = 0;
+
+    for( iteration = 1; iteration <= max_iterations && !failed; ++iteration )
+    {
+        if( !shadow_step( m, picker ) )
+            return false;
+
+        if( !( iteration % check_every ) && !shadow_check_all( m ) )
+            return false;
+
+        // the shared counter is updated in batches so the threads don't contend on it
+        if( ++unreported == 1024 )
+        {
+            total_iterations += unreported;
+            unreported = 0;
+        }
+    }
+
+    total_iterations += unreported;
+    return shadow_check_all( m );
+}
+
+
+/* RCU mode (--rcu=N)
+
+Thread 0 is the writer and every other thread is a reader of one shared list, sorted by key, of up
+to N nodes with keys 0 to N-1. Each writer iteration picks a random key and replaces its node with
+a copy (RCU_REPLACE_NODE), unlinks it (RCU_UNLINK_NODE) or links a new node for it in key order
+(RCU_LINK_NODE_BEFORE/RCU_LINK_NODE_LAST). Replaced and unlinked nodes are passed to epoch_retire.
+Each reader iteration is one traversal with RCU_LIST_FOREACH between epoch_enter and epoch_exit.
+
+The nodes come from a pool of 3N that is never freed during the run. When epoch reclamation frees
+a node it is poisoned and linked to the end of a free list that the writer takes nodes from the
+head of, so it stays poisoned for about 2N writes and reading it is never a use after free. A
+reader fails if it sees a poisoned node, a key that is not greater than the one before it or more
+than N nodes; the writer checks the list against its own index of the nodes at the end. The
+interleaving of the threads is not reproducible from a saved state.
+*/
+struct rcu_list;
+struct rcu_node {
+    DECLARE_NODE_MEMBERS( rcu_node, rcu_list );
+    epoch_entry retire;
+    size_t magic;
+    size_t key;
+};
+struct rcu_list {
+    DECLARE_LIST_MEMBERS( rcu_node );
+};
+
+const size_t RCU_LIVE = 0x11FE11FE, RCU_DEAD = 0xDEADDEAD;
+
+epoch_domain rcu_domain;
+rcu_list rcu_shared;
+vector<rcu_node> rcu_pool;
+
+// the writer's nodes that aren't linked or retired, and the node of each key or NULL
+rcu_list rcu_free;
+vector<rcu_node *> rcu_index;
+
+
+// Link the pool to the free list. Called before the threads start.
+void rcu_setup()
+{
+    epoch_domain_init( &rcu_domain );
+    ZERO_OUT_LIST_MEMBERS( &rcu_shared );
+    ZERO_OUT_LIST_MEMBERS( &rcu_free );
+    rcu_pool = vector<rcu_node>( rcu_capacity * 3 );
+    rcu_index.assign( rcu_capacity, (rcu_node *)NULL );
+    for( size_t i = 0; i < rcu_pool.size(); ++i )
+    {
+        rcu_node *node = &rcu_pool[ i ];
+        ZERO_OUT_NODE_MEMBERS( node );
+        node->magic = RCU_DEAD;
+        LINK_NODE_LAST( node, &rcu_free );
+    }
+}
+
+
+// The epoch_retire free function, it's only called on the writer's thread
+void rcu_reclaim( void *ptr )
+{
+    rcu_node *node = (rcu_node *)ptr;
+    GENERIC_ATOMIC_STORE_SIZE( node->magic, RCU_DEAD );
+    ZERO_OUT_NODE_MEMBERS( node );
+    LINK_NODE_LAST( node, &rcu_free );
+}
+
+
+// Take the oldest free node for 'key', waiting for the readers if every node is in limbo
+rcu_node *rcu_alloc( epoch_thread *thread, size_t key )
+{
+    while( !rcu_free.head )
+    {
+        if( !epoch_collect( thread ) )
+            this_thread::yield();
+    }
+    rcu_node *node = rcu_free.head;
+    UNLINK_NODE( node );
+    node->key = key;
+    GENERIC_ATOMIC_STORE_SIZE( node->magic, RCU_LIVE );
+    return node;
+}
+
+
+bool rcu_read( epoch_thread *thread )
+{
+    rcu_node *node = NULL;
+    size_t count = 0, prev_key = 0;
+    bool ok = true;
+
+    epoch_enter( thread );
+    RCU_LIST_FOREACH( node, &rcu_shared )
+    {
+        size_t magic = GENERIC_ATOMIC_LOAD_SIZE( node->magic );
+        size_t key = node->key;
+        if( magic != RCU_LIVE || ( count && key <= prev_key ) || ++count > rcu_capacity )
+        {
+            ok = false;
+            break;
+        }
+        prev_key = key;
+    }
+    epoch_exit( thread );
+
+    DEBUG_IF( !ok, "A reader found a "
+        << ( GENERIC_ATOMIC_LOAD_SIZE( node->magic ) != RCU_LIVE ? "reclaimed node" : "broken list" )
+        << " after " << count << " nodes" );
+    return true;
+}
+
+
+bool rcu_write( epoch_thread *thread )
+{
+    size_t key = getrand<size_t>( 0, rcu_capacity - 1 );
+    rcu_node *old = rcu_index[ key ];
+
+    if( old && getrand<bool>() )
+    {
+        rcu_node *node = rcu_alloc( thread, key );
+        RCU_REPLACE_NODE( old, node );
+        rcu_index[ key ] = node;
+        epoch_retire( thread, &old->retire, old, rcu_reclaim );
+    }
+    else if( old )
+    {
+        RCU_UNLINK_NODE( old );
+        rcu_index[ key ] = NULL;
+        epoch_retire( thread, &old->retire, old, rcu_reclaim );
+    }
+    else
+    {
+        rcu_node *node = rcu_alloc( thread, key ), *position = NULL;
+        for( size_t k = key + 1; k < rcu_capacity && !position; ++k )
+            position = rcu_index[ k ];
+        if( position )
+            RCU_LINK_NODE_BEFORE( node, position );
+        else
+            RCU_LINK_NODE_LAST( node, &rcu_shared );
+        rcu_index[ key ] = node;
+    }
+
+    epoch_collect( thread );
+    return true;
+}
+
+
+// Check the list against the writer's index
+bool rcu_check_index()
+{
+    size_t count = 0;
+    rcu_node *node = rcu_shared.head;
+    for( size_t key = 0; key < rcu_capacity; ++key )
+    {
+        if( !rcu_index[ key ] )
+            continue;
+        DEBUG_IF( node != rcu_index[ key ], "The node of key " << key << " is not in order" );
+        DEBUG_IF( node->parent != &rcu_shared, "The node of key " << key << " has no parent" );
+        node = node->next;
+        ++count;
+    }
+    DEBUG_IF( node, "The list has a node that is not in the index" );
+    DEBUG_IF( count != rcu_shared.count,
+        "list count " << rcu_shared.count << " but " << count << " nodes" );
+    return true;
+}
+
+
+// Run the writer on thread 0 and a reader on the others until any thread fails or 'max_iterations'
+bool run_rcu( size_t max_iterations )
+{
+    epoch_thread thread;
+    epoch_thread_register( &rcu_domain, &thread );
+
+    struct unregisterer
+    {
+        epoch_thread *thread;
+        ~unregisterer()
+        {
+            epoch_thread_unregister( thread );
+        }
+    } unregister = { &thread };
+
+    size_t unreported = 0;
+    for( iteration = 1; iteration <= max_iterations && !failed; ++iteration )
+    {
+        mersenne_state_iteration_prev = mersenne_state_iteration;
+        mersenne_state_iteration = mersenne;
+
+        if( !( thread_number ? rcu_read( &thread ) : rcu_write( &thread ) ) )
+            return false;
+
+        // the shared counter is updated in batches so the threads don't contend on it
+        if( ++unreported == 1024 )
+        {
+            total_iterations += unreported;
+            unreported = 0;
+        }
+    }
+
+    total_iterations += unreported;
+    return thread_number || rcu_check_index();
+}
+
+
+/* Run iterations on the calling thread, starting from the state of 'engine', until any thread
+fails or 'max_iterations' have run. The state before each iteration is kept in memory and saved on
+failure so that the iteration can be rerun by passing the file to the stresstest. The checks
+return false after DEBUG_IF has saved the error state and the callers pass that up, so a failed
+check stops the worker.
+*/
+bool run_worker( unsigned number, const mt19937 &engine, size_t max_iterations )
+{
+    thread_number = number;
+    mersenne = engine;
+
+    // copy the initial state of the PRNG
+    mersenne_state_initial = mersenne;
+    mersenne_state_iteration = mersenne;
+    mersenne_state_iteration_prev = mersenne;
+
+    if( shadow_capacity )
+        return run_shadow( max_iterations );
+
+    if( rcu_capacity )
+        return run_rcu( max_iterations );
+
+    for( iteration = 1; iteration <= max_iterations && !failed; ++iteration )
+    {
+        // a copy of the engine, it's only converted to text by SaveErrorState
+        mersenne_state_iteration_prev = mersenne_state_iteration;
+        mersenne_state_iteration = mersenne;
+
+        // the failed check has already saved the error state
+        if( !generate_and_modify_list() )
+            return false;
+
+        ++total_iterations;
+    }
+
+    return true;
+}
+
 
 int main( int argc, char *argv[] )
 {
     init();
 
-    if( argc > 1 )
+    unsigned threads = 1;
+    size_t max_iterations = SIZE_MAX;
+    unsigned stats_every = 10;
+    bool workload_given = false;
+
+    set_profile( shadow_workload, "uniform" );
+
+    for( int i = 1; i < argc; ++i )
     {
-        string filename = argv[ 1 ];
+        if( !strncmp( argv[ i ], "--threads=", 10 ) )
+        {
+            threads = (unsigned)strtoul( argv[ i ] + 10, NULL, 10 );
+            if( !threads )
+            {
+                threads = thread::hardware_concurrency() ? thread::hardware_concurrency() : 1;
+            }
+            continue;
+        }
+
+        if( !strncmp( argv[ i ], "--stats=", 8 ) )
+        {
+            stats_every = (unsigned)strtoul( argv[ i ] + 8, NULL, 10 );
+            continue;
+        }
+
+        if( !strncmp( argv[ i ], "--shadow=", 9 ) )
+        {
+            shadow_capacity = (size_t)strtoull( argv[ i ] + 9, NULL, 10 );
+            continue;
+        }
+
+        if( !strncmp( argv[ i ], "--rcu=", 6 ) )
+        {
+            rcu_capacity = (size_t)strtoull( argv[ i ] + 6, NULL, 10 );
+            continue;
+        }
+
+        if( !strncmp( argv[ i ], "--record=", 9 ) )
+        {
+            record_prefix = argv[ i ] + 9;
+            workload_given = true;
+            continue;
+        }
+
+        if( !strncmp( argv[ i ], "--check-every=", 14 ) )
+        {
+            shadow_check_every = (size_t)strtoull( argv[ i ] + 14, NULL, 10 );
+            continue;
+        }
+
+        if( !strncmp( argv[ i ], "--iterations=", 13 ) )
+        {
+            max_iterations = (size_t)strtoull( argv[ i ] + 13, NULL, 10 );
+            continue;
+        }
+
+        int applied = parse_workload_option( shadow_workload, argv[ i ] );
+        if( applied < 0 )
+        {
+            cerr << "Invalid workload option: " << argv[ i ] << endl;
+            exit( 1 );
+        }
+        if( applied )
+        {
+            workload_given = true;
+            continue;
+        }
+
+        string filename = argv[ i ];
         cout << "Restoring state from " << filename << endl;
         ifstream file( filename );
         if( !file.is_open() )
@@ -357,49 +1281,102 @@ int main( int argc, char *argv[] )
         cout << endl;
     }
 
-    // spec ios::left flag must be used on strinsgream before writing engine state
-    mersenne_state_initial.setf( ios::left );
-    mersenne_state_iteration.setf( ios::left );
-    mersenne_state_iteration_prev.setf( ios::left );
+    // a workload or a recording is for the shadow model mode, with a default pool if none given
+    if( workload_given && !shadow_capacity )
+        shadow_capacity = 100000;
 
-    // copy the initial state of the PRNG
-    mersenne_state_initial << mersenne;
-    mersenne_state_iteration << mersenne;
-    mersenne_state_iteration_prev << mersenne;
+    if( rcu_capacity && ( shadow_capacity || threads < 2 ) )
+    {
+        cerr << "--rcu needs --threads=2 or more and can't be used with the shadow model." << endl;
+        exit( 1 );
+    }
 
+    if( rcu_capacity )
+    {
+        cout << "RCU: --rcu=" << rcu_capacity << ", 1 writer and " << ( threads - 1 ) << " readers"
+            << endl;
+        rcu_setup();
+    }
 
-    // - create ramdisk
-    // imdisk -a -s 10M -m T: -p "/fs:ntfs /q /y"
-    //
-    // - delete ramdisk
-    // imdisk -d -m T:
-    // or imdisk -D -m T: to force a removal.
-    const string drive = "T:\\";
+    if( shadow_capacity )
+    {
+        cout << "Shadow model: --shadow=" << shadow_capacity << " "
+            << describe_workload( shadow_workload ) << endl;
+    }
 
-    // the max bytes to use on the ramdisk, might be a few bytes over
-    // also i make buffer up to twice this size elsewhere
-    const int max_ramdisk_size = 1048576;
+    /* Thread 0 continues from the initial or restored state, so a state file saved by any thread
+    reproduces that thread's iterations when it's passed back with one thread. The other threads
+    are seeded from it.
+    */
+    vector<mt19937> engines( threads, mersenne );
+    for( unsigned t = 1; t < threads; ++t )
+    {
+        seed_mersenne_from( engines[ 0 ] );
+        engines[ t ] = mersenne;
+    }
+    mersenne = engines[ 0 ];
 
-    cout << "WARNING: The stresstest will read and write repeatedly to drive " << drive << endl
-        << "It's highly preferable the drive be a RAM drive with >= "
-        << ( max_ramdisk_size / 1048576 ) + 10 << " MB of free space." << endl << endl;
+    cout << "Threads: " << threads << endl;
 
-    SaveOutputToFile( drive + "\\state_initial.txt", mersenne_state_initial.str() );
+    // the macro latencies of each thread, refer to latency.hpp
+    vector<latency_histogram> latencies( stats_every ? threads * LATENCY_OPS : 0 );
+
+    vector<thread> workers;
+    for( unsigned t = 0; t < threads; ++t )
+    {
+        workers.push_back( thread( [=, &engines, &latencies]() {
+            thread_latency = latencies.empty() ? NULL : &latencies[ t * LATENCY_OPS ];
+            if( !run_worker( t, engines[ t ], max_iterations ) )
+            {
+                failed = true;
+            }
+        } ) );
+    }
 
-    for( iteration = 1; iteration < SIZE_MAX; ++iteration )
+    /* report progress once a second and the macro latencies every 'stats_every' seconds until
+    every worker has stopped */
+    auto start = chrono::steady_clock::now();
+    vector<latency_snapshot> reported( LATENCY_OPS );
+    size_t expected = ( max_iterations == SIZE_MAX ) ? SIZE_MAX : max_iterations * threads;
+    for( size_t last = 0; !failed && total_iterations < expected; )
     {
-        mersenne_state_iteration_prev.swap( mersenne_state_iteration );
-        stringstream().swap( mersenne_state_iteration );
-        mersenne_state_iteration.setf( ios::left );
-        mersenne_state_iteration << mersenne;
+        this_thread::sleep_for( chrono::milliseconds( 100 ) );
+        auto elapsed = chrono::duration_cast<chrono::milliseconds>(
+            chrono::steady_clock::now() - start ).count();
+        if( elapsed / 1000 == (long long)last )
+        {
+            continue;
+        }
+        last = (size_t)( elapsed / 1000 );
+        cout << "Iteration " << FormatWithCommas<size_t>( total_iterations ) << " ("
+            << FormatWithCommas<size_t>( (size_t)( total_iterations * 1000 / elapsed ) )
+            << "/s)" << endl;
 
-        cout << "Iteration " << FormatWithCommas<size_t>( iteration ) << endl;
+        if( stats_every && !( last % stats_every ) )
+        {
+            vector<latency_snapshot> now = latency_snapshots( latencies );
+            vector<latency_snapshot> interval;
+            for( size_t op = 0; op < LATENCY_OPS; ++op )
+                interval.push_back( now[ op ] - reported[ op ] );
+            reported = now;
+            cout << "Macro latency (ns) in the last " << stats_every << " s:" << endl
+                << latency_summary( interval );
+        }
+    }
 
-        SaveOutputToFile( drive + "\\state_iteration.txt", mersenne_state_iteration.str() );
-        SaveOutputToFile( drive + "\\state_iteration_prev.txt", mersenne_state_iteration_prev.str() );
+    for( size_t t = 0; t < workers.size(); ++t )
+    {
+        workers[ t ].join();
+    }
 
-        DEBUG_IF( !generate_and_modify_list(), "generate_and_modify_list() failed." );
+    if( failed )
+    {
+        cerr << endl << "FAILED. The state and message were saved by the failed thread." << endl;
+        return 1;
     }
 
+    cout << "Iteration " << FormatWithCommas<size_t>( total_iterations ) << ". Done." << endl;
+    if( stats_every )
+        cout << "Macro latency (ns):" << endl << latency_summary( latency_snapshots( latencies ) );
     return 0;
 }
@@ -34,6 +34,7 @@ along with generic_list. If not, see <http://www.gnu.org/licenses/>.
 #include <list>
 #include <random>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -79,11 +80,12 @@ program is encouraged to use an alternate pseudo-random number generator engine
 provide a recovery method for such exceptions."
 */
 
-#ifdef __GNUC__
-#error "GCC random_device support is broken. Remove this check if you have a working random_device."
-#endif
+/* The random_device of libstdc++ reads /dev/urandom or uses RDRAND and works on Linux. In MinGW
+it may be deterministic, but that only means every run starts from the same state.
+*/
 
-mt19937 mersenne;
+thread_local mt19937 mersenne;
+thread_local unsigned thread_number;
 
 static void init_mersenne()
 {
@@ -115,6 +117,36 @@ void util_init()
 }
 
 
+/* Seed the calling thread's engine from numbers drawn from another engine, so a worker thread
+gets its own sequence that follows from the state of the engine it was seeded from.
+*/
+void seed_mersenne_from( mt19937 &engine )
+{
+    vector<uint32_t> v( mt19937::state_size );
+
+    generate( v.begin(), v.end(), ref( engine ) );
+    seed_seq seed( v.begin(), v.end() );
+
+    mersenne.seed( seed );
+}
+
+
+const locale &user_locale()
+{
+    static const locale l = []() {
+        try
+        {
+            return locale( "" );
+        }
+        catch( const runtime_error & )
+        {
+            return locale::classic();
+        }
+    }();
+    return l;
+}
+
+
 string DateTimeForFilename()
 {
     time_t now = time( 0 );
@@ -150,33 +182,49 @@ bool SaveOutputToFile( const string &filename, const string &output )
 }
 
 
+// The state of an engine as text that can be restored with operator>>.
+static string EngineState( const mt19937 &engine )
+{
+    stringstream ss;
+    // spec ios::left flag must be used on strinsgream before writing engine state
+    ss.setf( ios::left );
+    ss << engine;
+    return ss.str();
+}
+
+
 bool SaveErrorState( const string &errmsg )
 {
     bool func_retval = true;
 
-    extern size_t iteration;
-    extern stringstream mersenne_state_initial, mersenne_state_iteration, mersenne_state_iteration_prev;
+    extern thread_local size_t iteration;
+    extern thread_local mt19937 mersenne_state_initial, mersenne_state_iteration,
+        mersenne_state_iteration_prev;
 
-    string prefix = "error_" + DateTimeForFilename();
+    stringstream ss_prefix;
+    ss_prefix << "error_" << DateTimeForFilename() << "_thread" << thread_number;
+    string prefix = ss_prefix.str();
 
     stringstream ss;
-    ss << "Iteration " << FormatWithCommas<size_t>( iteration ) << endl << errmsg << endl;
+    ss << "Thread " << thread_number << ", iteration " << FormatWithCommas<size_t>( iteration )
+        << endl << errmsg << endl;
     if( !SaveOutputToFile( prefix + "_message.txt", ss.str() ) )
     {
         func_retval = false;
     }
 
-    if( !SaveOutputToFile( prefix + "_state_initial.txt", mersenne_state_initial.str() ) )
+    if( !SaveOutputToFile( prefix + "_state_initial.txt", EngineState( mersenne_state_initial ) ) )
     {
         func_retval = false;
     }
 
-    if( !SaveOutputToFile( prefix + "_state_iteration.txt", mersenne_state_iteration.str() ) )
+    if( !SaveOutputToFile( prefix + "_state_iteration.txt", EngineState( mersenne_state_iteration ) ) )
     {
         func_retval = false;
     }
 
-    if( !SaveOutputToFile( prefix + "_state_iteration_prev.txt", mersenne_state_iteration_prev.str() ) )
+    if( !SaveOutputToFile( prefix + "_state_iteration_prev.txt",
+            EngineState( mersenne_state_iteration_prev ) ) )
     {
         func_retval = false;
     }
@@ -192,5 +240,5 @@ bool SaveErrorState( const string &errmsg )
 
 void RemoveTrailingSpaces( string &s )
 {
-    s.erase( find_if( s.rbegin(), s.rend(), bind1st( not_equal_to<char>(), ' ' ) ).base(), s.end() );
+    s.erase( find_if( s.rbegin(), s.rend(), []( char c ) { return c != ' '; } ).base(), s.end() );
 }
@@ -31,29 +31,38 @@ along with generic_list. If not, see <http://www.gnu.org/licenses/>.
 #include <type_traits>
 
 
-extern std::mt19937 mersenne;
+/* Each thread has its own engine so that the threads don't share state and each
+thread's run can be reproduced from its saved state alone.
+*/
+extern thread_local std::mt19937 mersenne;
+
+// The number of the worker thread, in the names of the files saved on error.
+extern thread_local unsigned thread_number;
 
 bool is_mt19937_state_bug_present();
 void util_init();
+void seed_mersenne_from( std::mt19937 &engine );
 std::string DateTimeForFilename();
 bool SaveOutputToFile( const std::string &filename, const std::string &output );
 bool SaveErrorState( const std::string &errmsg );
 void RemoveTrailingSpaces( std::string &s );
 
 
+// The user's preferred locale, or the classic locale if it isn't installed.
+const std::locale &user_locale();
+
 // http://stackoverflow.com/questions/7276826/c-format-number-with-commas/7276879#7276879
 template<class T>
 std::string FormatWithCommas(T value)
 {
-    static std::locale l("");
     std::stringstream ss;
-    ss.imbue(l);
+    ss.imbue(user_locale());
     ss << std::fixed << value;
     return ss.str();
 }
 
 /* These getrand<>() don't use a static std::uniform_int_distribution() so depending on the
-implementation they may waste a lot of bits. Also they're not thread safe.
+implementation they may waste a lot of bits. They use the calling thread's engine.
 I'm using mersenne engine so that I can save the state and reproduce. If I were to use a static
 uniform_int_distribution I'd have to save that state as well for any reproduciton.
 */
@@ -144,6 +153,13 @@ typename std::enable_if<
 }
 
 
+#ifdef _MSC_VER
+#define DEBUG_BREAK()   __debugbreak()
+#else
+// Break in SaveErrorState with a debugger instead.
+#define DEBUG_BREAK()   ( (void)0 )
+#endif
+
 #define DEBUG_IF(expr, msg)   \
     if( expr ) \
     { \
@@ -158,7 +174,7 @@ typename std::enable_if<
             << filename_d_ << ":" << __LINE__ << " , " << __FUNCTION__ << "(): " << msg; \
         std::cerr << std::endl << "\a\a" << ss_d_.str() << std::endl; \
         SaveErrorState( ss_d_.str() ); \
-        __debugbreak(); \
+        DEBUG_BREAK(); \
         return false; \
     }
 
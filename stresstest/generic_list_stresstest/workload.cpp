@@ -0,0 +1,311 @@
+/*
+Copyright (C) 2014-2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+This file is part of generic_list.
+
+https://github.com/jay/generic_list
+
+generic_list is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+generic_list is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with generic_list. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** Workload profiles for the shadow model mode
+*/
+
+#include "workload.hpp"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "util.hpp"
+
+
+using namespace std;
+
+
+const char *const op_names[ OP_COUNT ] = { "UNLINK", "FIRST", "LAST", "BEFORE", "AFTER", "HIDE" };
+
+
+/* The profiles
+
+uniform : Every operation equally often on nodes picked uniformly, in two lists. This is the
+          original shadow model workload.
+queue   : A FIFO queue: nodes are linked last and unlinked from the head, twice as many links as
+          unlinks so the queue holds about half the pool.
+lru     : An LRU cache: nodes picked with zipf 1.0 are moved to the head and the tail is evicted.
+migrate : Nodes move between 8 lists by being linked before or after nodes in other lists, and a
+          hot tenth of the nodes gets nine tenths of the picks.
+*/
+bool set_profile( workload &w, const string &name )
+{
+    static const unsigned uniform_weights[ OP_COUNT ] = { 1, 1, 1, 1, 1, 1 };
+    static const unsigned queue_weights[ OP_COUNT ] = { 1, 0, 2, 0, 0, 0 };
+    static const unsigned lru_weights[ OP_COUNT ] = { 1, 8, 0, 0, 0, 0 };
+    static const unsigned migrate_weights[ OP_COUNT ] = { 1, 1, 1, 3, 3, 1 };
+
+    const unsigned *weights;
+    w.distribution = workload::UNIFORM;
+    w.zipf_s = 1.0;
+    w.hot_fraction = 0.1;
+    w.hot_probability = 0.9;
+    w.unlink_from = workload::UNLINK_RANDOM;
+    w.lists = 2;
+    w.target = 0;
+
+    if( name == "uniform" )
+    {
+        weights = uniform_weights;
+    }
+    else if( name == "queue" )
+    {
+        weights = queue_weights;
+        w.unlink_from = workload::UNLINK_HEAD;
+        w.lists = 1;
+    }
+    else if( name == "lru" )
+    {
+        weights = lru_weights;
+        w.distribution = workload::ZIPF;
+        w.unlink_from = workload::UNLINK_TAIL;
+        w.lists = 1;
+    }
+    else if( name == "migrate" )
+    {
+        weights = migrate_weights;
+        w.distribution = workload::HOT;
+        w.lists = 8;
+    }
+    else
+    {
+        return false;
+    }
+
+    copy( weights, weights + OP_COUNT, w.weights );
+    return true;
+}
+
+
+int parse_workload_option( workload &w, const string &arg )
+{
+    size_t eq = arg.find( '=' );
+    if( eq == string::npos )
+        return 0;
+
+    const string name = arg.substr( 0, eq ), value = arg.substr( eq + 1 );
+    const char *v = value.c_str();
+    char *end = NULL;
+
+    if( name == "--profile" )
+    {
+        return set_profile( w, value ) ? 1 : -1;
+    }
+
+    if( name == "--mix" )
+    {
+        unsigned weights[ OP_COUNT ], total = 0;
+        for( int i = 0; i < OP_COUNT; ++i )
+        {
+            weights[ i ] = (unsigned)strtoul( v, &end, 10 );
+            if( end == v || *end != ( ( i == OP_COUNT - 1 ) ? '\0' : ',' ) )
+                return -1;
+            total += weights[ i ];
+            v = end + 1;
+        }
+        if( !total )
+            return -1;
+        copy( weights, weights + OP_COUNT, w.weights );
+        return 1;
+    }
+
+    if( name == "--nodes" )
+    {
+        if( value == "uniform" )
+        {
+            w.distribution = workload::UNIFORM;
+            return 1;
+        }
+        if( !value.compare( 0, 5, "zipf:" ) )
+        {
+            w.zipf_s = strtod( v + 5, &end );
+            if( end == v + 5 || *end || w.zipf_s < 0 )
+                return -1;
+            w.distribution = workload::ZIPF;
+            return 1;
+        }
+        if( !value.compare( 0, 4, "hot:" ) )
+        {
+            w.hot_fraction = strtod( v + 4, &end );
+            if( end == v + 4 || *end != ':' )
+                return -1;
+            v = end + 1;
+            w.hot_probability = strtod( v, &end );
+            if( end == v || *end || w.hot_fraction <= 0 || w.hot_fraction > 1
+                || w.hot_probability < 0 || w.hot_probability > 1 )
+            {
+                return -1;
+            }
+            w.distribution = workload::HOT;
+            return 1;
+        }
+        return -1;
+    }
+
+    if( name == "--unlink" )
+    {
+        if( value == "random" )
+            w.unlink_from = workload::UNLINK_RANDOM;
+        else if( value == "head" )
+            w.unlink_from = workload::UNLINK_HEAD;
+        else if( value == "tail" )
+            w.unlink_from = workload::UNLINK_TAIL;
+        else
+            return -1;
+        return 1;
+    }
+
+    if( name == "--lists" || name == "--target" )
+    {
+        size_t n = (size_t)strtoull( v, &end, 10 );
+        if( end == v || *end || ( name == "--lists" && !n ) )
+            return -1;
+        ( ( name == "--lists" ) ? w.lists : w.target ) = n;
+        return 1;
+    }
+
+    return 0;
+}
+
+
+string describe_workload( const workload &w )
+{
+    static const char *const unlink_names[] = { "random", "head", "tail" };
+    stringstream ss;
+
+    ss << "--mix=";
+    for( int i = 0; i < OP_COUNT; ++i )
+    {
+        ss << ( i ? "," : "" ) << w.weights[ i ];
+    }
+
+    ss << " --nodes=";
+    if( w.distribution == workload::ZIPF )
+        ss << "zipf:" << w.zipf_s;
+    else if( w.distribution == workload::HOT )
+        ss << "hot:" << w.hot_fraction << ":" << w.hot_probability;
+    else
+        ss << "uniform";
+
+    ss << " --unlink=" << unlink_names[ w.unlink_from ]
+        << " --lists=" << w.lists
+        << " --target=" << w.target;
+
+    return ss.str();
+}
+
+
+workload_picker::workload_picker( const workload &w, size_t pool_size )
+    : w( w ), pool_size( pool_size ), weight_total( 0 )
+{
+    for( int i = 0; i < OP_COUNT; ++i )
+    {
+        weight_total += w.weights[ i ];
+    }
+
+    if( w.distribution == workload::UNIFORM )
+        return;
+
+    order.resize( pool_size );
+    for( size_t i = 0; i < pool_size; ++i )
+    {
+        order[ i ] = i;
+    }
+    for( size_t i = pool_size - 1; i > 0; --i )
+    {
+        swap( order[ i ], order[ getrand<size_t>( 0, i ) ] );
+    }
+
+    if( w.distribution != workload::ZIPF )
+        return;
+
+    // Vose's alias method: rank i has probability (1 / (i + 1)^s) / H
+    vector<double> scaled( pool_size );
+    double sum = 0;
+    for( size_t i = 0; i < pool_size; ++i )
+    {
+        scaled[ i ] = 1 / pow( (double)( i + 1 ), w.zipf_s );
+        sum += scaled[ i ];
+    }
+
+    vector<size_t> small, large;
+    for( size_t i = 0; i < pool_size; ++i )
+    {
+        scaled[ i ] *= (double)pool_size / sum;
+        ( ( scaled[ i ] < 1 ) ? small : large ).push_back( i );
+    }
+
+    keep.assign( pool_size, 1 );
+    alias.assign( pool_size, 0 );
+    while( !small.empty() && !large.empty() )
+    {
+        size_t s = small.back(), l = large.back();
+        small.pop_back();
+        keep[ s ] = scaled[ s ];
+        alias[ s ] = l;
+        scaled[ l ] -= 1 - scaled[ s ];
+        if( scaled[ l ] < 1 )
+        {
+            large.pop_back();
+            small.push_back( l );
+        }
+    }
+    // what's left has a probability of 1 within rounding
+}
+
+
+e_op workload_picker::pick_op()
+{
+    unsigned r = getrand<unsigned>( 0, weight_total - 1 );
+    int op = 0;
+    while( r >= w.weights[ op ] )
+    {
+        r -= w.weights[ op++ ];
+    }
+    return e_op( op );
+}
+
+
+size_t workload_picker::pick_node()
+{
+    if( w.distribution == workload::UNIFORM )
+        return getrand<size_t>( 0, pool_size - 1 );
+
+    double u = uniform_real_distribution<double>( 0, 1 )( mersenne );
+
+    if( w.distribution == workload::HOT )
+    {
+        size_t hot = max( (size_t)1, (size_t)( w.hot_fraction * (double)pool_size ) );
+        if( u < w.hot_probability || hot == pool_size )
+            return order[ getrand<size_t>( 0, hot - 1 ) ];
+        return order[ getrand<size_t>( hot, pool_size - 1 ) ];
+    }
+
+    size_t rank = getrand<size_t>( 0, pool_size - 1 );
+    return order[ ( u < keep[ rank ] ) ? rank : alias[ rank ] ];
+}
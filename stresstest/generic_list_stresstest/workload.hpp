@@ -0,0 +1,101 @@
+/*
+Copyright (C) 2014-2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+This file is part of generic_list.
+
+https://github.com/jay/generic_list
+
+generic_list is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+generic_list is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with generic_list. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STRESSTEST_WORKLOAD_
+#define STRESSTEST_WORKLOAD_
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+
+/* Workload profiles for the shadow model mode
+
+A workload is the mix of operations, how the nodes they act on are picked, how many lists there
+are and the size the lists are held at. It starts from a named profile and the other options
+override parts of it:
+
+--profile=NAME     uniform (default), queue, lru or migrate. Refer to set_profile().
+--mix=W,W,W,W,W,W  The weights of UNLINK, FIRST, LAST, BEFORE, AFTER and HIDE.
+--nodes=D          How nodes and positions are picked: uniform, zipf:S with exponent S, or
+                   hot:F:P for a fraction F of the nodes that gets a share P of the picks.
+--unlink=FROM      The node to unlink: random (picked like any node), head or tail of a random
+                   list.
+--lists=N          The number of lists, nodes migrate between them.
+--target=N         Hold the number of linked nodes at about N: below it unlinks become links and
+                   above it links of unlinked nodes become unlinks.
+
+Every pick is O(1): zipf uses an alias table over the pool built when the worker starts.
+*/
+
+enum e_op { OP_UNLINK, OP_FIRST, OP_LAST, OP_BEFORE, OP_AFTER, OP_HIDE, OP_COUNT };
+
+extern const char *const op_names[ OP_COUNT ];
+
+struct workload
+{
+    unsigned weights[ OP_COUNT ];
+    enum e_distribution { UNIFORM, ZIPF, HOT } distribution;
+    double zipf_s, hot_fraction, hot_probability;
+    enum e_unlink { UNLINK_RANDOM, UNLINK_HEAD, UNLINK_TAIL } unlink_from;
+    size_t lists;
+    // 0 if the size isn't held
+    size_t target;
+};
+
+// Set the workload to a named profile, false if there's no profile by that name
+bool set_profile( workload &w, const std::string &name );
+
+/* Apply a workload option to the workload.
+Returns 1 if it was applied, 0 if it isn't a workload option and -1 if its value is invalid.
+*/
+int parse_workload_option( workload &w, const std::string &arg );
+
+// The workload in the form of the options
+std::string describe_workload( const workload &w );
+
+
+/* Picks operations and pool nodes for a workload with the calling thread's mersenne twister, so
+the picks follow from the thread's state like any other getrand<>.
+*/
+class workload_picker
+{
+public:
+    // 'pool_size' must not be 0. Draws from the calling thread's engine.
+    workload_picker( const workload &w, size_t pool_size );
+
+    e_op pick_op();
+    size_t pick_node();
+
+private:
+    const workload &w;
+    size_t pool_size;
+    unsigned weight_total;
+    // the pool indexes in random order, so hot or low rank nodes are spread through the pool
+    std::vector<size_t> order;
+    // alias table for zipf: the probability of keeping a rank and the rank it otherwise aliases
+    std::vector<double> keep;
+    std::vector<size_t> alias;
+};
+
+#endif // STRESSTEST_WORKLOAD_
@@ -0,0 +1,115 @@
+/* Binary operation trace format of the stresstest and list_replay.
+*/
+#ifndef LIST_OPTRACE_H_
+#define LIST_OPTRACE_H_
+
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Binary operation trace format of the stresstest and list_replay.
+
+The stresstest's shadow model mode records every list operation it does with
+--record, and tools/list_replay.c runs a trace against generic_list.h without
+the random number generator. The lists and nodes are numbered: there are
+'list count' lists and 'pool size' nodes, all unlinked at the start.
+
+A trace is the 8 byte magic "GLOPS001", the pool size and the list count, and
+then one record per operation. Every number is an unsigned LEB128 varint, 7
+bits per byte with the high bit set on every byte but the last, so a record is
+usually a handful of bytes:
+
+UNLINK         : 0, node
+FIRST          : 1, list, node
+LAST           : 2, list, node
+BEFORE         : 3, node, position node
+AFTER          : 4, node, position node
+HIDE           : 5, n, n nodes
+
+UNLINK, FIRST, LAST, BEFORE and AFTER are the macros of the same names. HIDE
+is HIDE_NODE of the n nodes in order and then RESTORE_NODE of them in reverse
+order.
+*/
+
+#include <stdio.h>
+
+#define LIST_OPTRACE_MAGIC   "GLOPS001"
+
+enum list_optrace_op {
+    LIST_OPTRACE_UNLINK,
+    LIST_OPTRACE_FIRST,
+    LIST_OPTRACE_LAST,
+    LIST_OPTRACE_BEFORE,
+    LIST_OPTRACE_AFTER,
+    LIST_OPTRACE_HIDE,
+    LIST_OPTRACE_OP_COUNT
+};
+
+#if defined(_MSC_VER)
+#define LIST_OPTRACE_INLINE_   static __inline
+#elif defined(__GNUC__) || defined(__clang__)
+#define LIST_OPTRACE_INLINE_   static __inline__
+#else
+#define LIST_OPTRACE_INLINE_   static inline
+#endif
+
+
+/* list_optrace_put
+Write a number to a trace file as a varint.
+*/
+LIST_OPTRACE_INLINE_ void list_optrace_put(FILE *fp, unsigned long long value)
+{
+    while(value >= 0x80) {
+        putc((int)((value & 0x7F) | 0x80), fp);
+        value >>= 7;
+    }
+    putc((int)value, fp);
+}
+
+
+/* list_optrace_get
+Read a varint from a trace in memory.
+
+Returns 1 and advances '*p' if a number was read, or 0 at the end of the trace
+or if the number is truncated or too long.
+*/
+LIST_OPTRACE_INLINE_ int list_optrace_get(const unsigned char **p,
+    const unsigned char *end, unsigned long long *value)
+{
+    const unsigned char *q = *p;
+    unsigned shift = 0;
+    *value = 0;
+    for(; q < end && shift < 64; shift += 7) {
+        *value |= (unsigned long long)(*q & 0x7F) << shift;
+        if(!(*q++ & 0x80)) {
+            *p = q;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#endif /* LIST_OPTRACE_H_ */
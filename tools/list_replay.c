@@ -0,0 +1,280 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Replay an operation trace recorded by the stresstest (tools/list_optrace.h).
+
+The trace's operations are run on its lists and nodes with the generic_list.h
+macros, with no random number generator and none of the stresstest's checks
+in between, so a trace of millions of operations replays in well under a
+second. The lists are checked the way the stresstest's sanity_check_list does,
+and every node's neighbours are checked to point back to it:
+
+- after the last operation that's run,
+- and every 'N' operations with --check-every=N, which with N=1 finds the
+  first operation that leaves the lists inconsistent.
+
+--stop=K runs only the first K operations, which shrinks a failing trace to
+the operation that fails, and --print prints each operation that's run. The
+time per operation is printed so a trace recorded from a workload can also be
+used as a benchmark; use it without --check-every and --print.
+
+cc -O2 -I.. list_replay.c -o list_replay
+./list_replay <trace file> [--stop=K] [--check-every=N] [--print]
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "generic_list.h"
+#include "list_optrace.h"
+
+struct replay_list;
+struct replay_node {
+    DECLARE_NODE_MEMBERS(replay_node, replay_list);
+};
+struct replay_list {
+    DECLARE_LIST_MEMBERS(replay_node);
+};
+
+static const char *op_names[LIST_OPTRACE_OP_COUNT] = {
+    "UNLINK", "FIRST", "LAST", "BEFORE", "AFTER", "HIDE"
+};
+
+static struct replay_node *nodes;
+static struct replay_list *lists;
+static unsigned long long pool_size, list_count;
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Returns 0 and prints why if a list or node isn't consistent. */
+static int Check(unsigned long long op_index) {
+    unsigned long long i;
+    for(i = 0; i < list_count; ++i) {
+        struct replay_list *list = &lists[i];
+        struct replay_node *prev = NULL, *node;
+        size_t count = 0;
+        for(node = list->head; node; prev = node, node = node->next) {
+            if(++count > list->count || node->prev != prev
+                || node->parent != list)
+            {
+                break;
+            }
+        }
+        if(node || count != list->count || prev != list->tail) {
+            fprintf(stderr, "FAILED: list %llu is inconsistent after "
+                "operation %llu: count %lu, %lu nodes walked.\n", i, op_index,
+                (unsigned long)list->count, (unsigned long)count);
+            return 0;
+        }
+    }
+    for(i = 0; i < pool_size; ++i) {
+        struct replay_node *node = &nodes[i];
+        if((node->next && (node->next->prev != node
+                || node->next->parent != node->parent))
+            || (node->prev && node->prev->next != node))
+        {
+            fprintf(stderr, "FAILED: node %llu's neighbours don't point back "
+                "after operation %llu.\n", i, op_index);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Read a number that must be below 'limit'. */
+static int Get(const unsigned char **p, const unsigned char *end,
+    unsigned long long limit, unsigned long long *value)
+{
+    return list_optrace_get(p, end, value) && *value < limit;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long long stop = (unsigned long long)-1, check_every = 0;
+    unsigned long long op_index, v;
+    int print = 0, i;
+    const char *filename = NULL;
+    unsigned char *trace;
+    const unsigned char *p, *end;
+    long size;
+    FILE *fp;
+    double start, seconds;
+
+    for(i = 1; i < argc; ++i) {
+        if(!strncmp(argv[i], "--stop=", 7)) {
+            stop = strtoull(argv[i] + 7, NULL, 10);
+        }
+        else if(!strncmp(argv[i], "--check-every=", 14)) {
+            check_every = strtoull(argv[i] + 14, NULL, 10);
+        }
+        else if(!strcmp(argv[i], "--print")) {
+            print = 1;
+        }
+        else if(!filename) {
+            filename = argv[i];
+        }
+        else {
+            filename = NULL;
+            break;
+        }
+    }
+    if(!filename) {
+        fprintf(stderr, "Usage: list_replay <trace file> [--stop=K] "
+            "[--check-every=N] [--print]\n");
+        return 1;
+    }
+
+    fp = fopen(filename, "rb");
+    if(!fp || fseek(fp, 0, SEEK_END) || (size = ftell(fp)) < 0
+        || fseek(fp, 0, SEEK_SET))
+    {
+        fprintf(stderr, "Failed to open %s\n", filename);
+        return 1;
+    }
+    trace = malloc((size_t)size + 1);
+    if(!trace || fread(trace, 1, (size_t)size, fp) != (size_t)size) {
+        fprintf(stderr, "Failed to read %s\n", filename);
+        return 1;
+    }
+    fclose(fp);
+    p = trace + 8;
+    end = trace + size;
+    if(size < 8 || memcmp(trace, LIST_OPTRACE_MAGIC, 8)
+        || !Get(&p, end, (unsigned long long)-1, &pool_size)
+        || !Get(&p, end, (unsigned long long)-1, &list_count) || !pool_size
+        || !list_count || (size_t)pool_size != pool_size
+        || (size_t)list_count != list_count)
+    {
+        fprintf(stderr, "%s isn't an operation trace.\n", filename);
+        return 1;
+    }
+    nodes = calloc((size_t)pool_size, sizeof(*nodes));
+    lists = calloc((size_t)list_count, sizeof(*lists));
+    if(!nodes || !lists) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+
+    start = Now();
+    for(op_index = 0; op_index < stop && p < end; ++op_index) {
+        unsigned long long op, a = 0, b = 0;
+        struct replay_node *hidden[256];
+        size_t n, h;
+
+        if(!Get(&p, end, LIST_OPTRACE_OP_COUNT, &op)
+            || (op == LIST_OPTRACE_HIDE && !Get(&p, end, 257, &a))
+            || ((op == LIST_OPTRACE_FIRST || op == LIST_OPTRACE_LAST)
+                && !Get(&p, end, list_count, &a))
+            || (op != LIST_OPTRACE_HIDE && !Get(&p, end, pool_size, &b))
+            || ((op == LIST_OPTRACE_BEFORE || op == LIST_OPTRACE_AFTER)
+                && !Get(&p, end, pool_size, &a)))
+        {
+            fprintf(stderr, "The trace is corrupt at operation %llu.\n",
+                op_index);
+            return 1;
+        }
+        if(print) {
+            printf("%llu %s", op_index, op_names[op]);
+        }
+        switch(op) {
+        case LIST_OPTRACE_UNLINK:
+            UNLINK_NODE(&nodes[b]);
+            break;
+        case LIST_OPTRACE_FIRST:
+            LINK_NODE_FIRST(&nodes[b], &lists[a]);
+            break;
+        case LIST_OPTRACE_LAST:
+            LINK_NODE_LAST(&nodes[b], &lists[a]);
+            break;
+        case LIST_OPTRACE_BEFORE:
+            LINK_NODE_BEFORE(&nodes[b], &nodes[a]);
+            break;
+        case LIST_OPTRACE_AFTER:
+            LINK_NODE_AFTER(&nodes[b], &nodes[a]);
+            break;
+        default:
+            for(n = 0; n < (size_t)a; ++n) {
+                if(!Get(&p, end, pool_size, &v)) {
+                    fprintf(stderr, "The trace is corrupt at operation "
+                        "%llu.\n", op_index);
+                    return 1;
+                }
+                hidden[n] = &nodes[v];
+                if(print) {
+                    printf(" node %llu", v);
+                }
+            }
+            for(h = 0; h < n; ++h) {
+                HIDE_NODE(hidden[h]);
+            }
+            while(n) {
+                --n;
+                RESTORE_NODE(hidden[n]);
+            }
+            break;
+        }
+        if(print) {
+            if(op == LIST_OPTRACE_FIRST || op == LIST_OPTRACE_LAST) {
+                printf(" list %llu node %llu", a, b);
+            }
+            else if(op == LIST_OPTRACE_BEFORE || op == LIST_OPTRACE_AFTER) {
+                printf(" node %llu position %llu", b, a);
+            }
+            else if(op == LIST_OPTRACE_UNLINK) {
+                printf(" node %llu", b);
+            }
+            printf("\n");
+        }
+        if(check_every && !((op_index + 1) % check_every)
+            && !Check(op_index))
+        {
+            return 1;
+        }
+    }
+    seconds = Now() - start;
+
+    if(!op_index || !Check(op_index - 1)) {
+        if(!op_index) {
+            fprintf(stderr, "The trace has no operations.\n");
+        }
+        return 1;
+    }
+    printf("%llu operations replayed, %.1f ns per operation%s.\n", op_index,
+        seconds * 1e9 / (double)op_index,
+        (check_every || print) ? " with checks or printing" : "");
+    free(trace);
+    free(nodes);
+    free(lists);
+    return 0;
+}
@@ -0,0 +1,224 @@
+/* LICENSE: FreeBSD License
+Copyright (C) 2015 Jay Satiro <raysatiro@yahoo.com>
+All rights reserved.
+
+https://github.com/jay/generic_list
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Print a trace saved by list_trace_save (generic_list_trace.h).
+
+The records of all threads are merged by timestamp and printed one per line,
+oldest first, with the time since the first record and the record's sequence
+number in its thread:
+
+<time> T<thread> #<sequence> <operation> node=<address> list=<address>
+    position=<address>
+
+A timestamp is only taken once every LIST_TRACE_STAMP_EVERY records, which is
+printed first, so the records of different threads are only in order to within
+that many records. The records of one thread are always in order.
+
+If an address is given only the records whose node, list or position is that
+address are printed, for example to see every operation on a node that was
+found corrupted.
+
+Files saved before the sequence number was added (GLTRACE1 and GLTRACE2) are
+read too. In a GLTRACE2 file without timestamps the records are printed thread
+by thread.
+
+cc -O2 -I.. list_trace_dump.c -o list_trace_dump
+./list_trace_dump <trace file> [address]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "generic_list_trace.h"
+
+/* The record as it is saved, see list_trace_save. */
+struct saved_entry {
+    unsigned long long timestamp;
+    unsigned long long sequence;
+    unsigned long long node;
+    unsigned long long list;
+    unsigned long long position;
+    unsigned int op;
+    unsigned int thread;
+};
+
+/* The record of a GLTRACE1 or GLTRACE2 file, which has no sequence number.
+In a GLTRACE2 file without timestamps the timestamp is the sequence number. */
+struct saved_entry_v1 {
+    unsigned long long timestamp;
+    unsigned long long node;
+    unsigned long long list;
+    unsigned long long position;
+    unsigned int op;
+    unsigned int thread;
+};
+
+/* Read the next record into 'entry'. 'flags' is the word after a GLTRACE2
+magic, bit 0 set if the records have timestamps. Returns 0 at the end of the
+file. */
+static int ReadEntry(FILE *file, int version, unsigned long long flags,
+    unsigned long long index, struct saved_entry *entry)
+{
+    struct saved_entry_v1 v1;
+    if(version == 3) {
+        return fread(entry, sizeof(*entry), 1, file) == 1;
+    }
+    if(fread(&v1, sizeof(v1), 1, file) != 1) {
+        return 0;
+    }
+    if(version == 2 && !(flags & 1)) {
+        entry->timestamp = 0;
+        entry->sequence = v1.timestamp;
+    }
+    else {
+        /* the records of a thread are saved oldest first */
+        entry->timestamp = v1.timestamp;
+        entry->sequence = index;
+    }
+    entry->node = v1.node;
+    entry->list = v1.list;
+    entry->position = v1.position;
+    entry->op = v1.op;
+    entry->thread = v1.thread;
+    return 1;
+}
+
+static const char *OpName(unsigned op) {
+    switch(op) {
+    case LIST_TRACE_UNLINK: return "UNLINK_NODE";
+    case LIST_TRACE_LINK_FIRST: return "LINK_NODE_FIRST";
+    case LIST_TRACE_LINK_LAST: return "LINK_NODE_LAST";
+    case LIST_TRACE_LINK_BEFORE: return "LINK_NODE_BEFORE";
+    case LIST_TRACE_LINK_AFTER: return "LINK_NODE_AFTER";
+    case LIST_TRACE_SPLICE_LAST: return "SPLICE_LIST_LAST";
+    case LIST_TRACE_STITCH_LAST: return "STITCH_LIST_LAST";
+    case LIST_TRACE_HIDE: return "HIDE_NODE";
+    case LIST_TRACE_RESTORE: return "RESTORE_NODE";
+    case LIST_TRACE_ADOPT: return "ADOPT_LIST_NODES";
+    }
+    return NULL;
+}
+
+/* Order by timestamp, then thread, then sequence number. */
+static int CompareTimestamp(const void *a, const void *b) {
+    const struct saved_entry *x = (const struct saved_entry *)a;
+    const struct saved_entry *y = (const struct saved_entry *)b;
+    if(x->timestamp != y->timestamp) {
+        return (x->timestamp < y->timestamp) ? -1 : 1;
+    }
+    if(x->thread != y->thread) {
+        return (x->thread < y->thread) ? -1 : 1;
+    }
+    return (x->sequence < y->sequence) ? -1 : (x->sequence > y->sequence);
+}
+
+int main(int argc, char *argv[]) {
+    FILE *file;
+    char magic[8];
+    struct saved_entry *entries = NULL;
+    size_t count = 0, capacity = 0, i, printed = 0;
+    unsigned long long filter = 0, stamp_every = 1, flags = 1, base;
+    int version;
+
+    if(argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: list_trace_dump <trace file> [address]\n");
+        return 1;
+    }
+    if(argc > 2) {
+        filter = strtoull(argv[2], NULL, 16);
+    }
+    file = fopen(argv[1], "rb");
+    if(!file) {
+        fprintf(stderr, "Can't open %s.\n", argv[1]);
+        return 1;
+    }
+    if(fread(magic, 8, 1, file) != 1) {
+        magic[0] = 0;
+    }
+    version = !memcmp(magic, "GLTRACE1", 8) ? 1 :
+        !memcmp(magic, "GLTRACE2", 8) ? 2 :
+        !memcmp(magic, "GLTRACE3", 8) ? 3 : 0;
+    if(!version
+        || (version == 2 && fread(&flags, sizeof(flags), 1, file) != 1)
+        || (version == 3
+            && fread(&stamp_every, sizeof(stamp_every), 1, file) != 1))
+    {
+        fprintf(stderr, "%s is not a trace file.\n", argv[1]);
+        return 1;
+    }
+    for(;;) {
+        if(count == capacity) {
+            struct saved_entry *more;
+            capacity = capacity ? capacity * 2 : 4096;
+            more = realloc(entries, capacity * sizeof(*entries));
+            if(!more) {
+                fprintf(stderr, "Out of memory.\n");
+                return 1;
+            }
+            entries = more;
+        }
+        if(!ReadEntry(file, version, flags, count, &entries[count])) {
+            break;
+        }
+        ++count;
+    }
+    fclose(file);
+
+    qsort(entries, count, sizeof(*entries), CompareTimestamp);
+    base = count ? entries[0].timestamp : 0;
+    if(version == 2 && !(flags & 1)) {
+        printf("no timestamps\n");
+    }
+    else {
+        printf("timestamp every %llu records\n", stamp_every);
+    }
+    for(i = 0; i < count; ++i) {
+        const struct saved_entry *e = &entries[i];
+        const char *name = OpName(e->op);
+        if(filter && e->node != filter && e->list != filter
+            && e->position != filter)
+        {
+            continue;
+        }
+        printf("%12llu T%-3u #%-8llu ", e->timestamp - base, e->thread,
+            e->sequence);
+        if(name) {
+            printf("%-16s", name);
+        }
+        else {
+            printf("op %-13u", e->op);
+        }
+        printf(" node=0x%llx list=0x%llx position=0x%llx\n", e->node, e->list,
+            e->position);
+        ++printed;
+    }
+    fprintf(stderr, "%lu of %lu records\n", (unsigned long)printed,
+        (unsigned long)count);
+    free(entries);
+    return 0;
+}